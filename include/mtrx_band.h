@@ -0,0 +1,65 @@
+#ifndef __mtrx_band_h__
+#define __mtrx_band_h__  1
+
+#include "mtrx_t.h"
+
+#ifndef MTRX_BAND_DIV
+#define MTRX_BAND_DIV 4     /* band storage when (2*kl + ku + 1) * DIV <= n */
+#endif
+
+/** band_create - allocate zeroed (n x n) band_t with kl/ku bandwidth and
+ *  nrhs constant columns, n * (2*kl + ku + 1 + nrhs) elements. returns
+ *  pointer to band_t on success, NULL otherwise.
+ */
+band_t *band_create (const size_t n, const size_t kl, const size_t ku,
+                     const size_t nrhs);
+/** free band_t and storage */
+void band_free (band_t *b);
+/** band_from_mtrx - copy (n x n+k) system m into a new band_t using the
+ *  measured m->kl/m->ku. returns pointer to band_t on success, NULL
+ *  otherwise.
+ */
+band_t *band_from_mtrx (const mtrx_t *m);
+/** band_solv_lu - solve band system by LU with partial pivoting, rows
+ *  interchanged within the band and the constants carried with them, the
+ *  (kl extra) fill kept in the band. on return the constants hold the
+ *  solution. returns 0 on success, k + 1 if singular at k.
+ */
+int band_solv_lu (band_t *b);
+/** band_solv_thomas - solve tridiagonal (kl = ku = 1) system by the Thomas
+ *  algorithm (elimination without pivoting), stable when the matrix is
+ *  diagonally dominant. on return the constants hold the solution. returns
+ *  0 on success, k + 1 if a zero pivot is found at k.
+ */
+int band_solv_thomas (band_t *b);
+/** band_solv - solve band system, diagonally dominant tridiagonal systems
+ *  by band_solv_thomas(), all others by band_solv_lu().
+ */
+int band_solv (band_t *b);
+/** mtrx_is_band - return 1 if the coefficient block of the (n x n+k) system
+ *  m is narrow enough for band storage, (2*kl + ku + 1) * MTRX_BAND_DIV
+ *  <= n, 0 otherwise. the bandwidth is measured if not already known.
+ */
+int mtrx_is_band (mtrx_t *m);
+/** mtrx_solv_band - solve (n x n+k) system with band coefficients by
+ *  band_solv(). the coefficient block of m is unchanged, on return the
+ *  last k cols of m contain the (n x k) solution. returns 0 on success,
+ *  non-zero if the matrix is singular or on failure.
+ */
+int mtrx_solv_band (mtrx_t *m);
+/** mtrx_read_band - read (n x n+k) system in Matrix Market coordinate
+ *  format (see mtrx_read_coo()) directly into band storage, using the
+ *  bandwidth measured as entries are read, so large band systems never
+ *  need (n x n) storage. returns pointer to band_t on success, NULL on
+ *  error or if the system is not banded (see mtrx_is_band()).
+ */
+band_t *mtrx_read_band (FILE *fp);
+/** mtrx_solv_band_file - headless solve of the band system read from in
+ *  by mtrx_read_band(), (n x n) storage never allocated. the (n x k)
+ *  solution is written to out, one row per line at full precision.
+ *  returns 0 on success, -1 on read failure or if the system is not
+ *  banded, k + 1 if singular at k.
+ */
+int mtrx_solv_band_file (FILE *in, FILE *out);
+
+#endif
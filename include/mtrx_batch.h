@@ -0,0 +1,35 @@
+#ifndef __mtrx_batch_h__
+#define __mtrx_batch_h__  1
+
+#include "mtrx_t.h"
+
+#ifndef BATCH_W
+#define BATCH_W 8       /* systems per lockstep block (avx512 doubles) */
+#endif
+#define BATCH_NMAX 8    /* largest system order */
+
+/* structure of arrays storage of a batch with element stride ld, element
+ * (i,j) of the (n x n) coefficients and (i,c) of the (n x nrhs) constants
+ * of system s.
+ */
+#define BATCH_A(a,ld,n,i,j,s)       ((a)[((i) * (n) + (j)) * (ld) + (s)])
+#define BATCH_B(b,ld,nrhs,i,c,s)    ((b)[((i) * (nrhs) + (c)) * (ld) + (s)])
+
+/** mtrx_batch_ld - element stride for k systems, k rounded up to a
+ *  multiple of BATCH_W so each element array starts a full block.
+ */
+size_t mtrx_batch_ld (const size_t k);
+/** mtrx_batch_solv - solve k (n x n) systems a x = b, n <= BATCH_NMAX,
+ *  stored as structure of arrays (BATCH_A/BATCH_B, stride ld >= k).
+ *  BATCH_W systems are eliminated in lockstep, one per vector lane, by
+ *  LU with partial pivoting chosen per lane (rows exchanged by masked
+ *  selects, no branches on the data). no storage is allocated. a is
+ *  overwritten, b by the solutions. info (k, may be NULL) receives 0 or
+ *  j + 1 for a zero pivot at step j, the solution of a singular system
+ *  is not finite, other systems are unaffected. returns the number of
+ *  singular systems, -1 if n or ld is invalid.
+ */
+int mtrx_batch_solv (T *a, T *b, const size_t n, const size_t nrhs,
+                     const size_t k, const size_t ld, int *info);
+
+#endif
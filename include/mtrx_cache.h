@@ -0,0 +1,42 @@
+#ifndef __mtrx_cache_h__
+#define __mtrx_cache_h__  1
+
+#include "mtrx_t.h"
+
+#ifndef MTRX_CACHE_MAX
+#define MTRX_CACHE_MAX (64u << 20)  /* default factor cache limit (bytes) */
+#endif
+
+/** mtrx_cache_limit - set byte limit for cached LU factors, least recently
+ *  used factors are released to stay within the limit, 0 disables the
+ *  cache (and releases all factors). returns the previous limit.
+ */
+size_t mtrx_cache_limit (const size_t nbytes);
+/** mtrx_cache_clear - release all cached factors */
+void mtrx_cache_clear (void);
+/** mtrx_cache_count - number of cached solves that reused factors (hit)
+ *  and that factored the coefficients (miss), either may be NULL.
+ */
+void mtrx_cache_count (size_t *hit, size_t *miss);
+/** mtrx_cache_solv - solve (n x n+k) system in m, reusing cached factors.
+ *  the (n x n) coefficient block is hashed and compared against the cached
+ *  factorizations, on a hit the k constant cols are solved together by
+ *  blocked forward and back substitution alone, O(n^2 k)
+ *  (mtrx_lu_solv_m()). on a miss the block is copied and factored by
+ *  blocked LU and the factors cached. the cache is used for SOLV_LU,
+ *  SOLV_GAUSS and SOLV_GAUSSJ (the inverse is not formed), other than for
+ *  one constant col and order FIX_NMIN -> FIX_NMAX (unrolled solvers). for
+ *  SOLV_MIXED, SOLV_RLU, band, tall (least-squares) or (with SOLV_GAUSS)
+ *  symmetric systems or with the cache disabled m is passed to
+ *  mtrx_solv_sys(). the coefficient block of m is unchanged on a cached
+ *  solve. on return the last k cols of m contain the (n x k) solution.
+ *  returns 0 on success, non-zero otherwise. (the cache is not thread safe)
+ */
+int mtrx_cache_solv (mtrx_t *m, const int method);
+/** mtrx_cache_solv_st - mtrx_cache_solv() returning the statistics of the
+ *  factorization in st (if not NULL), see mtrx_stat_t. the statistics are
+ *  computed once on a miss and kept with the cached factors.
+ */
+int mtrx_cache_solv_st (mtrx_t *m, const int method, mtrx_stat_t *st);
+
+#endif
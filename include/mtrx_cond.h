@@ -0,0 +1,54 @@
+#ifndef __mtrx_cond_h__
+#define __mtrx_cond_h__  1
+
+#include "mtrx_t.h"
+
+#ifndef COND_ITMAX
+#define COND_ITMAX 5    /* Hager/Higham estimator iterations */
+#endif
+
+/* solve callback for mtrx_cond1_est(), x is overwritten by A^-1 x
+ * (trans 0) or A^-T x (trans 1) using the factors f.
+ */
+typedef void (*mtrx_solv_fn) (const void *f, T *x, const int trans);
+
+/** mtrx_norm1 - 1-norm (max col sum) of the (n x n) block of a */
+T mtrx_norm1 (T * const *a, const size_t n);
+/** mtrx_cond1_est - Hager/Higham (LAPACK dlacon) estimate of the 1-norm
+ *  condition number anrm * ||A^-1||_1 from at most 2 * COND_ITMAX + 1
+ *  solves with the factors of A (O(n^2) each). the estimate is a lower
+ *  bound, almost always within a factor of 3. returns NAN on allocation
+ *  failure.
+ */
+T mtrx_cond1_est (mtrx_solv_fn solv, const void *f, const size_t n,
+                  const T anrm);
+/** mtrx_stat_init - set anrm and amax of the (n x n) block of a, log|det|
+ *  0, sign 1, growth 0 and cond NAN, before the pivots are recorded.
+ */
+void mtrx_stat_init (mtrx_stat_t *st, T * const *a, const size_t n);
+/** mtrx_stat_na - mark log|det|, sign and growth as not available */
+void mtrx_stat_na (mtrx_stat_t *st);
+/** mtrx_stat_piv - record pivot piv following swaps row/col exchanges in
+ *  log|det|, sign and growth (max |piv| / amax).
+ */
+void mtrx_stat_piv (mtrx_stat_t *st, const T piv, const int swaps);
+/** mtrx_stat_inv - exact condition number anrm * ||inv||_1 from the
+ *  (n x n) inverse (Gauss-Jordan).
+ */
+void mtrx_stat_inv (mtrx_stat_t *st, T * const *inv, const size_t n);
+/** mtrx_stat_lu - statistics from (n x n) factors P A Q = L U (unit L
+ *  below the diagonal of lu, U on and above). row k of PAQ is row rp[k]
+ *  of A and col k is col cp[k], (NULL - identity). sets log|det|, sign,
+ *  growth (max |U| / amax) and the estimated condition number. anrm and
+ *  amax must be set by mtrx_stat_init() before factoring. returns 0 on
+ *  success, -1 on allocation failure.
+ */
+int mtrx_stat_lu (mtrx_stat_t *st, T * const *lu, const size_t *rp,
+                  const size_t *cp, const size_t n);
+/** mtrx_piv_perm - convert the sequential row interchanges piv of
+ *  mtrx_lu_fact() to the row permutation rp (row k of PA is row rp[k]).
+ *  returns the number of interchanges.
+ */
+size_t mtrx_piv_perm (const size_t *piv, size_t *rp, const size_t n);
+
+#endif
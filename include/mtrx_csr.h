@@ -0,0 +1,50 @@
+#ifndef __mtrx_csr_h__
+#define __mtrx_csr_h__  1
+
+#include "mtrx_t.h"
+
+/** csr_create - allocate (rows x cols) csr_t for nnz elements and nrhs
+ *  zeroed constant columns, rp zeroed. returns pointer to csr_t on
+ *  success, NULL otherwise.
+ */
+csr_t *csr_create (const size_t rows, const size_t cols, const size_t nnz,
+                   const size_t nrhs);
+/** free csr_t and storage */
+void csr_free (csr_t *a);
+/** csr_from_coo - build csr_t from coordinate matrix c. for a (n x n+k)
+ *  system the (n x n) coefficients are stored compressed by row and cols
+ *  n+1 .. n+k as the dense constants b. rows are sorted by column by two
+ *  counting passes and duplicate entries summed, O(nnz + n). returns
+ *  pointer to csr_t on success, NULL otherwise.
+ */
+csr_t *csr_from_coo (const coo_t *c);
+/** csr_from_mtrx - build csr_t from the non-zero coefficients (and the
+ *  diagonal) of (n x n+k) system m, the last k cols as the constants.
+ *  returns pointer to csr_t on success, NULL otherwise.
+ */
+csr_t *csr_from_mtrx (const mtrx_t *m);
+/** mtrx_read_csr - read (n x n+k) system in Matrix Market coordinate
+ *  format (see mtrx_read_coo()) into csr_t, storage O(nnz). returns
+ *  pointer to csr_t on success, NULL otherwise.
+ */
+csr_t *mtrx_read_csr (FILE *fp);
+/** csr_mv_rows - y[i] = A(i,:) x for rows [lo, hi) */
+void csr_mv_rows (const csr_t *a, const T *x, T *y,
+                  const size_t lo, const size_t hi);
+/** csr_mv - y = A x */
+void csr_mv (const csr_t *a, const T *x, T *y);
+/** csr_jacobi - dinv[i] = 1 / a(i,i). returns 0 on success, i + 1 if
+ *  a(i,i) is zero or missing.
+ */
+int csr_jacobi (const csr_t *a, T *dinv);
+/** csr_ilu0 - incomplete LU factorization with zero fill, L (unit) and U
+ *  stored in lu on the pattern of a, dp[i] the position of the diagonal
+ *  of row i. returns 0 on success, i + 1 if the diagonal of row i is
+ *  missing or zero, -1 on allocation failure.
+ */
+int csr_ilu0 (const csr_t *a, T *lu, size_t *dp);
+/** csr_ilu0_solv - z = (L U)^-1 r from csr_ilu0 factors */
+void csr_ilu0_solv (const csr_t *a, const T *lu, const size_t *dp,
+                    const T *r, T *z);
+
+#endif
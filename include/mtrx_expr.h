@@ -0,0 +1,44 @@
+#ifndef __mtrx_expr_h__
+#define __mtrx_expr_h__  1
+
+#include "mtrx_t.h"
+
+#define EXPR_MAX 8      /* terms in a mtrx_expr_t */
+#ifndef EXPR_NC
+#define EXPR_NC 1024    /* cols of a row taken through every term at once */
+#endif
+#define EXPR_MIN (1u << 16) /* elements before an evaluation is threaded */
+
+typedef struct {        /* lazy alpha[0] m[0] + ... + alpha[n-1] m[n-1] */
+    size_t n;
+    T alpha[EXPR_MAX];
+    const mtrx_t *m[EXPR_MAX];
+} mtrx_expr_t;
+
+/** mtrx_expr_init - empty expression e */
+void mtrx_expr_init (mtrx_expr_t *e);
+/** mtrx_expr_add - append the term alpha m to e, nothing is computed.
+ *  returns 0 on success, -1 if e holds EXPR_MAX terms.
+ */
+int mtrx_expr_add (mtrx_expr_t *e, const T alpha, const mtrx_t *m);
+/** mtrx_expr_eval - dst = beta dst + alpha[0] m[0] + ... in a single pass.
+ *  EXPR_NC cols of each row of dst are scaled by beta (beta 0 clears dst)
+ *  and then receive each term in turn while in cache (four terms per pass
+ *  by mtrx_kern.axpy4), rows split over mtrx_nthrd_get() threads above
+ *  EXPR_MIN elements. no temporaries are allocated. dst may be a term of
+ *  e, its alpha is added to beta. returns 0 on success, -1 on unequal
+ *  dimensions or packed storage.
+ */
+int mtrx_expr_eval (const mtrx_expr_t *e, const T beta, mtrx_t *dst);
+/** mtrx_expr_new - evaluate e into a new (slab) matrix, the only
+ *  allocation. returns pointer to mtrx_t on success, NULL otherwise.
+ */
+mtrx_t *mtrx_expr_new (const mtrx_expr_t *e);
+/** mtrx_axpby - my = alpha mx + beta my in place (accumulate with alpha 1,
+ *  beta 1, subtract with alpha -1). returns as mtrx_expr_eval().
+ */
+int mtrx_axpby (const T alpha, const mtrx_t *mx, const T beta, mtrx_t *my);
+/** mtrx_scal - m = alpha m in place, returns as mtrx_expr_eval() */
+int mtrx_scal (const T alpha, mtrx_t *m);
+
+#endif
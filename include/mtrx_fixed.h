@@ -0,0 +1,41 @@
+#ifndef __mtrx_fixed_h__
+#define __mtrx_fixed_h__  1
+
+#include "mtrx_t.h"
+
+#define FIX_NMIN 2      /* orders with unrolled solvers */
+#define FIX_NMAX 8
+
+/* fixed order solvers, compiled for each n from one elimination with n
+ * constant, so every loop is unrolled. coefficients a and the inverse are
+ * (n x n) row-major. partial pivots are chosen by selects, the data does
+ * not branch. solv/inv return 0 on success or j + 1 for a zero pivot at
+ * step j (the results are then not finite), nothing is allocated.
+ */
+#define FIX_DECL(N)                                                     \
+int mtrx_solv_##N (const T *a, const T *b, T *x);                       \
+int mtrx_inv_##N (const T *a, T *inv);                                  \
+T mtrx_det_##N (const T *a);
+
+FIX_DECL(2)
+FIX_DECL(3)
+FIX_DECL(4)
+FIX_DECL(5)
+FIX_DECL(6)
+FIX_DECL(7)
+FIX_DECL(8)
+
+/** mtrx_fix_solv - solve a x = b with the unrolled solver for n,
+ *  returns as mtrx_solv_N(), -1 if n is not FIX_NMIN -> FIX_NMAX.
+ */
+int mtrx_fix_solv (const T *a, const T *b, T *x, const size_t n);
+/** mtrx_fix_inv - inverse of a with the unrolled solver for n,
+ *  returns as mtrx_inv_N(), -1 if n is not FIX_NMIN -> FIX_NMAX.
+ */
+int mtrx_fix_inv (const T *a, T *inv, const size_t n);
+/** mtrx_fix_det - determinant of a by the unrolled LU for n, (NAN if n
+ *  is not FIX_NMIN -> FIX_NMAX).
+ */
+T mtrx_fix_det (const T *a, const size_t n);
+
+#endif
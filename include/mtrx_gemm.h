@@ -0,0 +1,51 @@
+#ifndef __mtrx_gemm_h__
+#define __mtrx_gemm_h__  1
+
+#include "mtrx_t.h"
+
+#ifndef GEMM_MC
+#define GEMM_MC   96    /* rows of a packed per block (L2), GEMM_MR multiple */
+#endif
+#ifndef GEMM_KC
+#define GEMM_KC  256    /* inner dimension per block (L1 b sliver) */
+#endif
+#ifndef GEMM_NC
+#define GEMM_NC 2048    /* cols of b packed per block (L3), GEMM_NR multiple */
+#endif
+#define GEMM_SMALL 32768 /* m n k below which the product is not packed */
+#ifndef GEMM_KR
+#define GEMM_KR  4096   /* min rows of a^T b summed per chunk (mtrx_gemm_tn) */
+#endif
+#define GEMM_KRMAX 32   /* max chunks of a^T b, partial (m x n) blocks */
+
+/** mtrx_gemm - c = alpha a b + beta c, a (m x k), b (k x n), c (m x n).
+ *  each operand is given by its row pointers and the column of its first
+ *  element, (a[i] + ja, b[p] + jb, c[i] + jc) so blocks within a larger
+ *  matrix are used in place, c may share rows with a or b provided the
+ *  columns do not overlap. c is scaled by beta (beta 0 clears c), then
+ *  (GEMM_KC x GEMM_NC) blocks of b and (GEMM_MC x GEMM_KC) blocks of
+ *  alpha a are packed into contiguous slivers for the register-blocked
+ *  mtrx_kern.gemm kernel. rows of c are split over mtrx_nthrd_get()
+ *  threads. every element receives c[i][j] += (alpha a[i][p]) b[p][j] in
+ *  order of p, so results are identical for any isa, block size or number
+ *  of threads (and to the row axpy loop with alpha -1, beta 1).
+ */
+void mtrx_gemm (const size_t m, const size_t n, const size_t k,
+                const T alpha, T * const *a, const size_t ja,
+                T * const *b, const size_t jb,
+                const T beta, T * const *c, const size_t jc);
+/** mtrx_gemm_tn - c = alpha a^T b + beta c, a (k x m), b (k x n), c (m x n),
+ *  operands given as for mtrx_gemm(), a^T read from the rows of a while
+ *  packing. a c of GEMM_MC rows or more is split by rows as mtrx_gemm().
+ *  a shorter c over a long k (the (nb x n) V^T C of a block reflector)
+ *  has too few rows to split, so the k rows of a and b are cut into at
+ *  most GEMM_KRMAX chunks of at least GEMM_KR rows, the chunk products
+ *  dealt to threads and added to c in chunk order. the chunks depend on
+ *  k alone, so results do not depend on the number of threads.
+ */
+void mtrx_gemm_tn (const size_t m, const size_t n, const size_t k,
+                   const T alpha, T * const *a, const size_t ja,
+                   T * const *b, const size_t jb,
+                   const T beta, T * const *c, const size_t jc);
+
+#endif
@@ -0,0 +1,57 @@
+#ifndef __mtrx_gen_h__
+#define __mtrx_gen_h__  1
+
+#include <stdio.h>
+#include <stdlib.h>
+#ifndef __STDC_NO_COMPLEX__
+#include <complex.h>
+#endif
+
+#include "mtrx_t.h"
+
+/* type-generic matrices. double matrices are the mtrx_t of the solver,
+ * (read by mtrx_read_alloc(), solved by mtrx_solv_sys()). each other
+ * element type gets its own struct and compiled functions from one
+ * template (mtrx_gen_tmpl.h declarations, mtrx_gen_impl.h definitions),
+ * reading with the same parse_skip() as mtrx_t, suffix: f float,
+ * l long double, z double complex, e.g. mtrx_f_t, mtrx_l_read(),
+ * mtrx_z_solv_gaussj().
+ */
+#define GEN_T float
+#define GEN_S f
+#include "mtrx_gen_tmpl.h"
+
+#define GEN_T long double
+#define GEN_S l
+#include "mtrx_gen_tmpl.h"
+
+#ifndef __STDC_NO_COMPLEX__
+#define GEN_T double complex
+#define GEN_S z
+#include "mtrx_gen_tmpl.h"
+
+#define GEN_Z_(f)   , mtrx_z_t: mtrx_z_##f
+#else
+#define GEN_Z_(f)
+#endif
+
+/** mtrx_solv_gaussj_sys - Gauss-Jordan solve of (n x n+k) mtrx_t m for
+ *  mtrx_gen_solv_gaussj(), mtrx_solv_sys() with SOLV_GAUSSJ.
+ */
+int mtrx_solv_gaussj_sys (mtrx_t *m);
+
+/* compile-time dispatch on the matrix type (qualifiers dropped by *(m)),
+ * d is the mtrx_t (double) function.
+ */
+#define GEN_SEL_(m,f,d) _Generic (*(m), mtrx_t: d,                         \
+                                        mtrx_f_t: mtrx_f_##f,              \
+                                        mtrx_l_t: mtrx_l_##f GEN_Z_(f))
+
+#define mtrx_gen_free(m)            GEN_SEL_(m,free,mtrx_free) (m)
+#define mtrx_gen_copy(m)            GEN_SEL_(m,copy,mtrx_copy) (m)
+#define mtrx_gen_mult(ma,mb)        GEN_SEL_(ma,mult,mtrx_mult) (ma, mb)
+#define mtrx_gen_solv_gaussj(m)     GEN_SEL_(m,solv_gaussj,            \
+                                             mtrx_solv_gaussj_sys) (m)
+#define mtrx_gen_prn(m,width)       GEN_SEL_(m,prn,mtrx_prn) (m, width)
+
+#endif
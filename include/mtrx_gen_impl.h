@@ -0,0 +1,286 @@
+/* type-generic matrix definitions, included once per element type by
+ * mtrx_gen.c only, with the parameters below defined. the inner loops are
+ * plain GEN_T arithmetic, so each instance compiles to its own code with
+ * no run-time type tests. no include guard, parameters undefined on exit.
+ *
+ *  GEN_T           element type
+ *  GEN_S           name suffix
+ *  GEN_R           real type of GEN_ABS
+ *  GEN_ABS(x)      magnitude of x
+ *  GEN_STRTO(s,e)  convert string s, end pointer e (as strtod)
+ *  GEN_PRN(w,x)    print x in field width w (leading space)
+ */
+#define GEN_CAT_(a,b,c) a##b##c
+#define GEN_CAT(a,b,c)  GEN_CAT_(a,b,c)
+#define GEN_M       GEN_CAT(mtrx_,GEN_S,_t)
+#define GEN_FN(f)   GEN_CAT(mtrx_,GEN_S,_##f)
+
+/** allocate zeroed (rows x cols) matrix, NULL on failure */
+GEN_M *GEN_FN(create) (const size_t rows, const size_t cols)
+{
+    register size_t i;
+    GEN_M *m = calloc (1, sizeof *m);
+
+    if (!m) {
+        fprintf (stderr, "%s() error: calloc-m.\n", __func__);
+        return NULL;
+    }
+    m->mtrx = malloc ((rows ? rows : 1) * sizeof *m->mtrx);
+    m->slab = calloc (rows && cols ? rows * cols : 1, sizeof *m->slab);
+    if (!m->mtrx || !m->slab) {
+        fprintf (stderr, "%s() error: memory exhausted.\n", __func__);
+        free (m->slab);
+        free (m->mtrx);
+        free (m);
+        return NULL;
+    }
+    m->rows = rows;
+    m->cols = cols;
+
+    for (i = 0; i < rows; i++)
+        m->mtrx[i] = m->slab + i * cols;
+
+    return m;
+}
+
+/** free matrix and storage */
+void GEN_FN(free) (GEN_M *m)
+{
+    if (!m)
+        return;
+    free (m->slab);
+    free (m->mtrx);
+    free (m);
+}
+
+/** read (m x n) matrix from stream, one row per line, any delimiters.
+ *  short rows are zero-filled to the cols of the first row.
+ */
+GEN_M *GEN_FN(read) (FILE *fp)
+{
+    char buf[MAXC];
+    size_t nmax = COLSZ, n = 0, rows = 0, cols = 0;
+    GEN_T *v = malloc (nmax * sizeof *v);
+    GEN_M *m = NULL;
+
+    if (!v) {
+        fprintf (stderr, "%s() error: malloc-v.\n", __func__);
+        return NULL;
+    }
+
+    while (fgets (buf, MAXC, fp)) {     /* read each line */
+        char *p = buf, *endptr;
+        size_t got = 0;
+
+        for (;; p = endptr) {
+            GEN_T x;
+
+            if (!*(p = parse_skip (p)))   /* end of line */
+                break;
+            errno = 0;
+            x = GEN_STRTO (p, &endptr);
+            if (p == endptr || errno) {
+                fprintf (stderr, "%s() error: in conversion, row[%zu].\n",
+                        __func__, rows);
+                break;
+            }
+            if (rows && got == cols) {  /* extra values ignored */
+                got++;
+                continue;
+            }
+            if (n == nmax) {            /* realloc x2 as needed */
+                void *tmp = realloc (v, 2 * nmax * sizeof *v);
+                if (!tmp) {
+                    fprintf (stderr, "%s() error: realloc-v.\n", __func__);
+                    goto readdone;
+                }
+                v = tmp;
+                nmax *= 2;
+            }
+            v[n++] = x;
+            got++;
+        }
+        if (!got)                       /* no values, skip line */
+            continue;
+
+        if (!rows)                      /* first row sets cols */
+            cols = got;
+        else if (got != cols) {
+            fprintf (stderr, "%s() error: column mismatch row[%zu]\n",
+                    __func__, rows);
+            for (; got < cols; got++) { /* zero-fill short row */
+                if (n == nmax) {
+                    void *tmp = realloc (v, 2 * nmax * sizeof *v);
+                    if (!tmp) {
+                        fprintf (stderr, "%s() error: realloc-v.\n",
+                                __func__);
+                        goto readdone;
+                    }
+                    v = tmp;
+                    nmax *= 2;
+                }
+                v[n++] = 0;
+            }
+        }
+        rows++;
+    }
+
+    if (rows && (m = GEN_FN(create) (rows, cols)))
+        memcpy (m->slab, v, rows * cols * sizeof *v);
+
+    readdone:;
+    free (v);
+
+    return m;
+}
+
+/** copy matrix */
+GEN_M *GEN_FN(copy) (const GEN_M *m)
+{
+    GEN_M *result = GEN_FN(create) (m->rows, m->cols);
+    register size_t i;
+
+    if (!result)
+        return NULL;
+
+    for (i = 0; i < m->rows; i++)
+        memcpy (result->mtrx[i], m->mtrx[i], m->cols * sizeof **m->mtrx);
+
+    return result;
+}
+
+/** multiply (m x n) by (n x p) into new (m x p) matrix */
+GEN_M *GEN_FN(mult) (const GEN_M *ma, const GEN_M *mb)
+{
+    GEN_M *result;
+    register size_t i, j, k;
+
+    if (ma->cols != mb->rows) {
+        fprintf (stderr, "%s() error: unequal dimensions, (%zu x %zu) != "
+                "(%zu x %zu)\n [not (m x n) * (n x p) => (m x p)]\n",
+                 __func__, ma->rows, ma->cols, mb->rows, mb->cols);
+        return NULL;
+    }
+
+    if (!(result = GEN_FN(create) (ma->rows, mb->cols)))
+        return NULL;
+
+    for (i = 0; i < ma->rows; i++) {    /* row i of result += a[i][k] b[k] */
+        GEN_T *c = result->mtrx[i];
+
+        for (k = 0; k < ma->cols; k++) {
+            const GEN_T aik = ma->mtrx[i][k], *b = mb->mtrx[k];
+
+            for (j = 0; j < mb->cols; j++)
+                c[j] += aik * b[j];
+        }
+    }
+
+    return result;
+}
+
+/** Gauss-Jordan elimination with full pivoting of (n x n+k) m, on return
+ *  the first n cols contain the inverse, the last k the solutions.
+ *  returns 0 on success, -1 invalid/alloc, i + 1 if singular at step i.
+ */
+int GEN_FN(solv_gaussj) (GEN_M *m)
+{
+    const size_t n = m->rows, ncol = m->cols;
+    size_t *indxc = malloc ((n ? n : 1) * sizeof *indxc),
+           *indxr = malloc ((n ? n : 1) * sizeof *indxr);
+    char *ipiv = calloc (n ? n : 1, sizeof *ipiv);
+    GEN_T **a = m->mtrx, pivinv, dum;
+    register size_t i, j, k;
+    size_t icol = 0, irow = 0, l;
+    int info = 0;
+
+    if (ncol < n) {
+        fprintf (stderr, "%s() error: invalid size (cols < rows)\n",
+                __func__);
+        info = -1;
+        goto gaussjdone;
+    }
+    if (!indxc || !indxr || !ipiv) {
+        fprintf (stderr, "%s() error: memory exhausted.\n", __func__);
+        info = -1;
+        goto gaussjdone;
+    }
+
+    for (i = 0; i < n; i++) {
+        GEN_R big = 0;
+
+        for (j = 0; j < n; j++)         /* largest unpivoted element */
+            if (!ipiv[j])
+                for (k = 0; k < n; k++)
+                    if (!ipiv[k] && GEN_ABS (a[j][k]) >= big) {
+                        big = GEN_ABS (a[j][k]);
+                        irow = j;
+                        icol = k;
+                    }
+        if (big == 0) {
+            fprintf (stderr, "%s() error: singular matrix.\n", __func__);
+            info = i + 1;
+            goto gaussjdone;
+        }
+        ipiv[icol] = 1;
+
+        if (irow != icol) {             /* exchange row pointers */
+            GEN_T *tmp = a[irow];
+            a[irow] = a[icol];
+            a[icol] = tmp;
+        }
+        indxr[i] = irow;
+        indxc[i] = icol;
+
+        pivinv = 1 / a[icol][icol];
+        a[icol][icol] = 1;
+        for (k = 0; k < ncol; k++)
+            a[icol][k] *= pivinv;
+
+        for (j = 0; j < n; j++)         /* eliminate col icol */
+            if (j != icol && (dum = a[j][icol]) != 0) {
+                a[j][icol] = 0;
+                for (k = 0; k < ncol; k++)
+                    a[j][k] -= dum * a[icol][k];
+            }
+    }
+
+    l = n;
+    while (l--)                         /* unscramble inverse columns */
+        if (indxr[l] != indxc[l])
+            for (k = 0; k < n; k++) {
+                dum = a[k][indxr[l]];
+                a[k][indxr[l]] = a[k][indxc[l]];
+                a[k][indxc[l]] = dum;
+            }
+
+    gaussjdone:;
+    free (ipiv);
+    free (indxr);
+    free (indxc);
+
+    return info;
+}
+
+/** print a (m x n) matrix */
+void GEN_FN(prn) (const GEN_M *m, int width)
+{
+    register size_t i, j;
+
+    for (i = 0; i < m->rows; i++) {
+        for (j = 0; j < m->cols; j++)
+            GEN_PRN (width, m->mtrx[i][j]);
+        putchar ('\n');
+    }
+}
+
+#undef GEN_FN
+#undef GEN_M
+#undef GEN_CAT
+#undef GEN_CAT_
+#undef GEN_PRN
+#undef GEN_STRTO
+#undef GEN_ABS
+#undef GEN_R
+#undef GEN_S
+#undef GEN_T
@@ -0,0 +1,41 @@
+/* type-generic matrix declarations, included once per element type by
+ * mtrx_gen.h with GEN_T (element type) and GEN_S (name suffix) defined.
+ * no include guard, GEN_T and GEN_S are undefined on exit.
+ */
+#define GEN_CAT_(a,b,c) a##b##c
+#define GEN_CAT(a,b,c)  GEN_CAT_(a,b,c)
+#define GEN_M       GEN_CAT(mtrx_,GEN_S,_t)
+#define GEN_FN(f)   GEN_CAT(mtrx_,GEN_S,_##f)
+
+typedef struct {        /* (rows x cols) matrix, rows point into slab */
+    size_t rows, cols;
+    GEN_T **mtrx;
+    GEN_T *slab;
+} GEN_M;
+
+/** allocate zeroed (rows x cols) matrix, NULL on failure */
+GEN_M *GEN_FN(create) (const size_t rows, const size_t cols);
+/** free matrix and storage */
+void GEN_FN(free) (GEN_M *m);
+/** read (m x n) matrix from stream, one row per line, any delimiters.
+ *  short rows are zero-filled to the cols of the first row.
+ */
+GEN_M *GEN_FN(read) (FILE *fp);
+/** copy matrix */
+GEN_M *GEN_FN(copy) (const GEN_M *m);
+/** multiply (m x n) by (n x p) into new (m x p) matrix */
+GEN_M *GEN_FN(mult) (const GEN_M *ma, const GEN_M *mb);
+/** Gauss-Jordan elimination with full pivoting of (n x n+k) m, on return
+ *  the first n cols contain the inverse, the last k the solutions.
+ *  returns 0 on success, -1 invalid/alloc, i + 1 if singular at step i.
+ */
+int GEN_FN(solv_gaussj) (GEN_M *m);
+/** print a (m x n) matrix */
+void GEN_FN(prn) (const GEN_M *m, int width);
+
+#undef GEN_FN
+#undef GEN_M
+#undef GEN_CAT
+#undef GEN_CAT_
+#undef GEN_S
+#undef GEN_T
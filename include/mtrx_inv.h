@@ -0,0 +1,34 @@
+#ifndef __mtrx_inv_h__
+#define __mtrx_inv_h__  1
+
+#include "mtrx_t.h"
+
+#ifndef INV_NB
+#define INV_NB 64       /* unit right-hand sides solved per block (cols) */
+#endif
+
+/** mtrx_inv - inverse of the (n x n) leading block of m (n = m->rows,
+ *  m->cols >= n, so a system may be passed). the block is copied and
+ *  factored once by blocked LU, then the n unit right-hand sides are
+ *  solved in INV_NB column blocks dealt to mtrx_nthrd_get() threads,
+ *  each block solved in place in its columns of the result. results do
+ *  not depend on the number of threads. returns the (n x n) inverse (slab)
+ *  on success, NULL on allocation failure or if the block is singular.
+ */
+mtrx_t *mtrx_inv (const mtrx_t *m);
+/** mtrx_inv_cols - columns cols[0] -> cols[nc-1] of the inverse of the
+ *  (n x n) leading block of m as mtrx_inv(), (cols NULL, the first nc)
+ *  only the requested columns are solved. returns the (n x nc) result
+ *  (column k holding column cols[k] of the inverse) on success, NULL on
+ *  invalid column, allocation failure or if the block is singular.
+ */
+mtrx_t *mtrx_inv_cols (const mtrx_t *m, const size_t *cols,
+                       const size_t nc);
+/** mtrx_inv_diag - diagonal of the inverse of the (n x n) leading block
+ *  of m as mtrx_inv(), each thread solving its column blocks in a (n x
+ *  INV_NB) scratch block, so only O(n) of the inverse is stored. returns
+ *  allocated vector of n elements on success, NULL otherwise.
+ */
+T *mtrx_inv_diag (const mtrx_t *m);
+
+#endif
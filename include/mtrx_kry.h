@@ -0,0 +1,46 @@
+#ifndef __mtrx_kry_h__
+#define __mtrx_kry_h__  1
+
+#include "mtrx_csr.h"
+
+enum { KRY_CG, KRY_BICGSTAB, KRY_GMRES };   /* Krylov method consts */
+enum { PRE_NONE, PRE_JACOBI, PRE_ILU0 };    /* preconditioner consts */
+
+typedef struct {        /* Krylov solver parameters and results */
+    int method;         /* KRY_CG (SPD), KRY_BICGSTAB or KRY_GMRES */
+    int precond;        /* PRE_NONE, PRE_JACOBI or PRE_ILU0 */
+    size_t maxit;       /* iteration limit */
+    size_t restart;     /* GMRES restart length */
+    T tol;              /* relative residual ||b - A x|| / ||b|| */
+    int nthrd;          /* threads (0 - mtrx_nthrd_get()) */
+    FILE *log;          /* per-iteration residual output, or NULL */
+    size_t iter;        /* out: iterations */
+    T resid;            /* out: relative residual */
+    double secs;        /* out: wall time (seconds) */
+} kry_t;
+
+/** kry_defaults - set k to GMRES(30) with ILU(0), tol 1.0e-10, maxit
+ *  1000, threads from mtrx_nthrd_get() and no log output.
+ */
+void kry_defaults (kry_t *k);
+/** csr_solv_kry - solve A x = b by the preconditioned Krylov method in
+ *  opt, x holds the initial guess on entry and the solution on return.
+ *  the rows are split across opt->nthrd threads (balanced by non-zeros),
+ *  each applying the sparse products, vector updates and partial dot
+ *  products to its rows, the partials reduced in thread order so the
+ *  result is reproducible for a given thread count. ILU(0) triangular
+ *  solves are sequential. opt->iter, opt->resid and opt->secs are set
+ *  on return, each residual is written to opt->log if not NULL. returns
+ *  0 if converged, 1 if not converged in opt->maxit iterations, 2 on
+ *  breakdown, -1 on failure (or preconditioner failure).
+ */
+int csr_solv_kry (const csr_t *a, const T *b, T *x, kry_t *opt);
+/** mtrx_solv_csr - solve each constant column of a by csr_solv_kry() from
+ *  a zero initial guess, the preconditioner is built once. on return
+ *  a->b holds the solution, opt->iter and opt->resid are the largest and
+ *  opt->secs the total over the columns. returns 0 if all converged,
+ *  otherwise the first non-zero csr_solv_kry() return.
+ */
+int mtrx_solv_csr (csr_t *a, kry_t *opt);
+
+#endif
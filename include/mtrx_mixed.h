@@ -0,0 +1,38 @@
+#ifndef __mtrx_mixed_h__
+#define __mtrx_mixed_h__  1
+
+#include "mtrx_t.h"
+
+#ifndef SLU_NC
+#define SLU_NC (2 * LU_NC)  /* float trailing update tile, LU_NC bytes */
+#endif
+#ifndef MIXED_ITMAX
+#define MIXED_ITMAX 30  /* refinement iterations before double fallback */
+#endif
+
+/** mtrx_slu_fact - blocked LU with partial pivoting of the (n x n) float
+ *  matrix 'a' in place, as mtrx_lu_fact() with float row updates. returns
+ *  0 on success, k + 1 if U[k][k] is exactly zero.
+ */
+int mtrx_slu_fact (float **a, size_t *piv, const size_t n);
+/** mtrx_slu_solv - solve a x = b from mtrx_slu_fact factors and pivots,
+ *  b is overwritten with the solution vector.
+ */
+void mtrx_slu_solv (float * const *lu, const size_t *piv, float *b,
+                    const size_t n);
+/** mtrx_solv_mixed - solve (n x n+k) system by mixed precision iterative
+ *  refinement. the coefficients are rounded to float and factored by
+ *  blocked LU (half the memory traffic, twice the vector width), then each
+ *  solution is refined, x += A^-1 r, with the residual r = b - A x formed
+ *  in double from m until |r| <= sqrt(n) eps |A| |x| (infinity norms, eps
+ *  the double epsilon) and |r| no longer halves. if the float factorization
+ *  fails or any column does not converge in MIXED_ITMAX iterations, the
+ *  system is solved by double blocked LU instead (mtrx_solv_lu_m()). iter,
+ *  if not NULL, receives the largest number of refinement iterations, or -1
+ *  on fallback. the coefficient block of m is unchanged unless it falls
+ *  back. on return the last k cols of m contain the (n x k) solution.
+ *  returns 0 on success, non-zero otherwise.
+ */
+int mtrx_solv_mixed (mtrx_t *m, int *iter);
+
+#endif
@@ -0,0 +1,58 @@
+#ifndef __mtrx_ooc_h__
+#define __mtrx_ooc_h__  1
+
+#include "mtrx_t.h"
+
+#ifndef OOC_MEM
+#define OOC_MEM (1024u << 20)   /* default out-of-core memory budget (bytes) */
+#endif
+#define OOC_NBMIN 8             /* min panel width (cols) */
+
+typedef struct {        /* out-of-core (n x n+nrhs) system in a scratch file */
+    int fd;             /* scratch file descriptor */
+    char *path;         /* scratch file, removed by mtrx_ooc_free() */
+    size_t n, nrhs;     /* order, constant columns */
+    size_t ncol;        /* n + nrhs */
+    size_t nb;          /* panel width, tiles are (nb x nb) */
+    size_t np, npa;     /* panels, panels holding coefficients */
+    size_t mem;         /* memory budget (bytes) */
+} mtrx_ooc_t;
+
+/** mtrx_ooc_create - create scratch file path for a (n x n+nrhs) system
+ *  solved within mem bytes (0, OOC_MEM). the matrix is stored as panels of
+ *  nb columns, each a column of (nb x nb) row-major tiles, nb chosen so
+ *  four panels fit in mem. the file is zero filled (sparse where the file
+ *  system allows). returns pointer to mtrx_ooc_t on success, NULL if the
+ *  file cannot be created or mem is too small for OOC_NBMIN.
+ */
+mtrx_ooc_t *mtrx_ooc_create (const char *path, const size_t n,
+                             const size_t nrhs, size_t mem);
+/** mtrx_ooc_free - close and remove the scratch file, free o */
+void mtrx_ooc_free (mtrx_ooc_t *o);
+/** mtrx_ooc_set_rows - store nr rows of ncol values (row-major, contiguous)
+ *  as rows i0 -> i0+nr-1 of the system. returns 0 on success, -1 on
+ *  invalid rows or write error.
+ */
+int mtrx_ooc_set_rows (mtrx_ooc_t *o, const size_t i0, const size_t nr,
+                       const T *rows);
+/** mtrx_ooc_solv - left-looking LU with partial pivoting of the system in
+ *  the scratch file, streaming the factored panels to the left through
+ *  memory for the update of each panel. the read of the next panel and
+ *  the write of the last factored panel overlap the updates, which are
+ *  split over mtrx_nthrd_get() threads. the constant columns are carried
+ *  through the factorization, then the (n x nrhs) solution is formed by
+ *  back substitution into x (row-major). the file holds the factors on
+ *  return. returns 0 on success, -1 on allocation or i/o failure, k + 1
+ *  if U[k][k] is exactly zero (factoring stops).
+ */
+int mtrx_ooc_solv (mtrx_ooc_t *o, T *x);
+/** mtrx_ooc_solv_file - headless solve of the (n x n+k) system read as
+ *  text from in (any delimiters, one row per line, rows of any length)
+ *  using scratch file path and at most mem bytes (0, OOC_MEM) of matrix
+ *  storage. rows are staged in path.in while n is counted. the (n x k)
+ *  solution is written to out, one row per line at full precision.
+ *  returns as mtrx_ooc_solv().
+ */
+int mtrx_ooc_solv_file (FILE *in, FILE *out, const char *path, size_t mem);
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef __mtrx_qr_h__
+#define __mtrx_qr_h__  1
+
+#include "mtrx_t.h"
+
+#ifndef QR_NB
+#define QR_NB 32        /* reflectors per block (WY panel cols) */
+#endif
+#ifndef QR_NBMIN
+#define QR_NBMIN 8      /* recursive panel base case (cols) */
+#endif
+#ifndef QR_MC
+#define QR_MC 4096      /* base case rows per chunk (sums, threads) */
+#endif
+
+/** mtrx_qr_fact - blocked Householder QR of the (m x n) block of a
+ *  (m >= n), Q^T applied to cols n -> ncol-1 as they are factored (so
+ *  right-hand sides carried in a receive Q^T b). each panel of QR_NB
+ *  cols is factored recursively (halves to QR_NBMIN cols, factored
+ *  in contiguous cols a pass over QR_MC row chunks per reflector), the
+ *  reflectors H = I - tau v v^T accumulated in compact WY form
+ *  I - V T V^T and applied to the trailing cols as C -= V T^T (V^T C)
+ *  by mtrx_gemm_tn() and mtrx_gemm(), threaded over the m rows. on return
+ *  R is on and above the diagonal, v below it (v[k] = 1 implied) and
+ *  tau[k] in tau (n). results do not depend on the number of threads.
+ *  returns 0 on success, -1 on allocation failure, k + 1 if R[k][k] is
+ *  exactly zero (rank deficient, factorization completed).
+ */
+int mtrx_qr_fact (T **a, T *tau, const size_t m, const size_t n,
+                  const size_t ncol);
+/** mtrx_solv_ls - least-squares solution of the (m x n+k) system in a,
+ *  m >= n, minimizing || A x - b || for each of the k constant cols by
+ *  mtrx_qr_fact() and R x = (Q^T b)[0:n], the normal equations are not
+ *  formed. on return rows 0 -> n-1 of the last k cols hold the (n x k)
+ *  solution and rows n -> m-1 the components of the residual in Q, so
+ *  || A x - b || is the norm of rows n -> m-1 of each col. returns 0 on
+ *  success, -1 on invalid size or allocation failure, k + 1 if R[k][k]
+ *  is exactly zero (rank deficient).
+ */
+int mtrx_solv_ls (T **a, const size_t m, const size_t n, const size_t nrhs);
+
+#endif
@@ -0,0 +1,65 @@
+#ifndef __mtrx_simd_h__
+#define __mtrx_simd_h__  1
+
+#include "mtrx_t.h"
+
+#define GEMM_MR 6       /* gemm micro-tile rows */
+#define GEMM_NR 8       /* gemm micro-tile cols */
+#define TRANS_NR 4      /* transpose register tile (rows/cols) */
+
+/** vector kernels for row operations on contiguous T (double) rows.
+ *  the table is selected from the processor features (CPUID) once, at
+ *  load time (first use guarded by pthread_once() otherwise), or by
+ *  mtrx_simd_init() / mtrx_simd_select() (call before starting threads
+ *  that use the kernels). no kernel uses fused multiply-add, so each
+ *  element receives exactly the rounding of the equivalent scalar loop.
+ */
+typedef struct {
+    /* x[i] *= alpha */
+    void (*scal) (const size_t n, const T alpha, T *x);
+    /* y[i] += alpha * x[i] */
+    void (*axpy) (const size_t n, const T alpha, const T *x, T *y);
+    /* exchange x[i] and y[i] */
+    void (*swap) (const size_t n, T *x, T *y);
+    /* index of last element of maximum fabs (x[i]) with msk[i] != 0,
+     * (msk NULL, all elements) returns n if no element is selected.
+     */
+    size_t (*iamax) (const size_t n, const T *x, const T *msk);
+    /* sum of x[i] * y[i], 8 interleaved partial sums folded in a fixed
+     * order (identical on every isa, though not to a sequential sum)
+     */
+    T (*dot) (const size_t n, const T *x, const T *y);
+    /* y[i] += alpha * x[i] on float rows (mixed precision factorization) */
+    void (*saxpy) (const size_t n, const float alpha, const float *x,
+                   float *y);
+    /* y[i] += alpha[0] * x[0][i] + ... + alpha[3] * x[3][i], added in
+     * turn with y[i] held in a register (rounds as 4 axpy calls)
+     */
+    void (*axpy4) (const size_t n, const T *alpha, const T * const *x,
+                   T *y);
+    /* c[i][j] += a[p * GEMM_MR + i] * b[p * GEMM_NR + j] added in turn for
+     * p = 0 -> k-1, the (GEMM_MR x GEMM_NR) tile held in registers (a, b
+     * packed by mtrx_gemm(), c the tile rows)
+     */
+    void (*gemm) (const size_t k, const T *a, const T *b, T * const *c);
+    /* y[j][jy + i] = x[i][jx + j] for the (TRANS_NR x TRANS_NR) tile, x
+     * and y the tile rows (x and y must not overlap)
+     */
+    void (*trans) (T * const *x, const size_t jx, T * const *y,
+                   const size_t jy);
+    const char *isa;    /* kernel instruction set name */
+} mtrx_kern_t;
+
+extern mtrx_kern_t mtrx_kern;   /* current kernel table */
+
+/** mtrx_simd_init - select widest kernels supported by the processor.
+ *  (AVX-512F, AVX2, SSE2 or generic C) returns the selected isa name.
+ */
+const char *mtrx_simd_init (void);
+/** mtrx_simd_select - select kernels by isa name ("avx512", "avx2",
+ *  "sse2" or "generic"). returns 0 on success, -1 if isa is unknown or
+ *  not supported by the processor (current table is unchanged).
+ */
+int mtrx_simd_select (const char *isa);
+
+#endif
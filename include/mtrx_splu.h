@@ -0,0 +1,93 @@
+#ifndef __mtrx_splu_h__
+#define __mtrx_splu_h__  1
+
+#include "mtrx_csr.h"
+
+enum { ORD_NATURAL, ORD_RCM };  /* fill-reducing ordering consts */
+
+#ifndef SPLU_REFINE
+#define SPLU_REFINE 3   /* refinement cycles after perturbed pivots */
+#endif
+#ifndef SPLU_NSMAX
+#define SPLU_NSMAX 64   /* max cols per supernode */
+#endif
+#ifndef SPLU_RELAX
+#define SPLU_RELAX 0.1  /* max fraction of explicit zeros in a supernode */
+#endif
+#ifndef SPLU_RESTART
+#define SPLU_RESTART 30 /* refinement GMRES restart length */
+#endif
+
+typedef struct {        /* symbolic analysis, reusable for the same pattern */
+    size_t n, nnz;      /* order, non-zeros of the analyzed pattern */
+    size_t *perm;       /* fill-reducing order, new col i is old perm[i] */
+    size_t *pinv;       /* inverse, pinv[perm[i]] = i */
+    size_t *q, *qinv;   /* new row i is old row q[i], zero-free diagonal */
+    size_t nsup;        /* supernodes */
+    size_t *sup;        /* supernode s is cols sup[s] -> sup[s+1]-1 */
+    size_t *snode;      /* supernode of each col */
+    size_t *rp, *ri;    /* row structure of s (ascending) ri[rp[s]..rp[s+1]) */
+    size_t *lp, *up;    /* offsets of (nr x ns) L and (ns x nr-ns) U blocks */
+    size_t lnz, unz;    /* total L and U block elements */
+    size_t *cp, *cr, *cx;   /* col access to a, row and csr position */
+} splu_sym_t;
+
+typedef struct {        /* numeric supernodal LU factors */
+    const splu_sym_t *sym;
+    T *lx, *ux;         /* supernode L (with diagonal block) and U blocks */
+    size_t *piv;        /* row interchanges within diagonal blocks */
+    size_t npert;       /* pivots perturbed to +/- eps */
+    T eps;              /* perturbation, sqrt (DBL_EPSILON) * max |a(i,j)| */
+    T anrm;             /* max row sum |a(i,j)| */
+} splu_t;
+
+/** mtrx_rcm - reverse Cuthill-McKee ordering of the pattern of a + a^T,
+ *  each component started from a pseudo-peripheral node (George-Liu).
+ *  perm (n) receives the new order, new i is old perm[i]. returns 0 on
+ *  success, -1 on allocation failure.
+ */
+int mtrx_rcm (const csr_t *a, size_t *perm);
+/** splu_analyze - symbolic analysis of square a: row matching to a zero-free
+ *  diagonal (maximum product transversal, large values of a placed on the
+ *  diagonal), fill-reducing order (ORD_RCM or ORD_NATURAL) of the symmetric
+ *  pattern b + b^T of the matched b, postordered elimination tree, relaxed
+ *  supernodes (chains of up to SPLU_NSMAX cols sharing one structure,
+ *  explicit zeros within SPLU_RELAX) and their row structure. storage is
+ *  O(nnz(L + U)), the analysis is reused by splu_factor()/splu_refactor()
+ *  for any a of the same pattern (the matching is made on the values of a
+ *  given here). returns pointer to splu_sym_t on success, NULL otherwise.
+ */
+splu_sym_t *splu_analyze (const csr_t *a, const int order);
+/** free splu_sym_t and storage */
+void splu_sym_free (splu_sym_t *s);
+/** splu_factor - allocate and compute numeric factors of a (pattern as
+ *  analyzed by sym), see splu_refactor(). returns pointer to splu_t on
+ *  success, NULL otherwise.
+ */
+splu_t *splu_factor (const splu_sym_t *sym, const csr_t *a);
+/** splu_refactor - numeric right-looking supernodal LU of a into f. each
+ *  supernode panel is factored with row pivoting inside its dense diagonal
+ *  block (structure is unchanged), pivots smaller than f->eps are replaced
+ *  by +/- f->eps (counted in f->npert), and the Schur complement of the
+ *  panel is formed densely and scattered into the later supernodes.
+ *  returns 0 on success, -1 on invalid pattern or allocation failure.
+ */
+int splu_refactor (splu_t *f, const csr_t *a);
+/** free splu_t and storage */
+void splu_free (splu_t *f);
+/** splu_solv - solve A x = b from the factors, b is overwritten with x.
+ *  if pivots were perturbed, the solution is refined by up to SPLU_REFINE
+ *  cycles of GMRES(SPLU_RESTART) against a, preconditioned by the factors.
+ *  returns 0 on success, 1 if the refined residual is still above the
+ *  tolerance 8 eps (||A|| ||x|| + ||b||) or not finite (b then holds the
+ *  last iterate, not a solution), -1 on allocation failure.
+ */
+int splu_solv (const splu_t *f, const csr_t *a, T *b);
+/** mtrx_solv_splu - solve each constant column of a by sparse LU with
+ *  ordering order, the factorization is computed once. on return a->b
+ *  holds the solution. returns 0 on success, 1 if refinement did not
+ *  reach the tolerance for a column (see splu_solv()), -1 on failure.
+ */
+int mtrx_solv_splu (csr_t *a, const int order);
+
+#endif
@@ -0,0 +1,51 @@
+#ifndef __mtrx_sym_h__
+#define __mtrx_sym_h__  1
+
+#include "mtrx_t.h"
+
+/** mtrx_is_sym - return 1 if the (n x n) coefficient block of the
+ *  (n x n+k) system m is exactly symmetric, 0 otherwise.
+ */
+int mtrx_is_sym (const mtrx_t *m);
+/** mtrx_pack_sym - copy lower triangle of the (n x n) coefficient block of
+ *  m into a newly allocated packed mtrx_t (see mtrx_create_packed()).
+ *  user is responsible for freeing return. returns NULL on failure.
+ */
+mtrx_t *mtrx_pack_sym (const mtrx_t *m);
+/** mtrx_chol_fact - Cholesky factorization A = L L^T of packed symmetric
+ *  positive definite l, overwritten by L. returns 0 on success, k + 1 if
+ *  the leading (k+1 x k+1) minor is not positive definite.
+ */
+int mtrx_chol_fact (mtrx_t *l);
+/** mtrx_chol_solv - solve A x = b from mtrx_chol_fact factor, b is
+ *  overwritten with the solution vector.
+ */
+void mtrx_chol_solv (const mtrx_t *l, T *b);
+/** mtrx_ldlt_fact - Bunch-Kaufman factorization P A P^T = L D L^T of
+ *  packed symmetric indefinite l, overwritten by the multipliers of L and
+ *  the 1x1 and 2x2 blocks of D. ipiv (n) records the interchanges, as
+ *  LAPACK dsytf2 (lower) with 0-based rows: ipiv[k] >= 0 a 1x1 block with
+ *  rows k and ipiv[k] exchanged, ipiv[k] = ipiv[k+1] = -(p + 1) a 2x2
+ *  block with rows k+1 and p exchanged. returns 0 on success, k + 1 if
+ *  D is exactly singular at k, -1 on allocation failure.
+ */
+int mtrx_ldlt_fact (mtrx_t *l, int *ipiv);
+/** mtrx_ldlt_solv - solve A x = b from mtrx_ldlt_fact factors and ipiv,
+ *  b is overwritten with the solution vector.
+ */
+void mtrx_ldlt_solv (const mtrx_t *l, const int *ipiv, T *b);
+/** mtrx_solv_sym - solve (n x n+k) system with symmetric coefficients.
+ *  the lower triangle is packed and factored by Cholesky, if it is not
+ *  positive definite by Bunch-Kaufman LDL^T, and each constant column is
+ *  solved from the factors. the coefficient block of m is unchanged, on
+ *  return the last k cols of m contain the (n x k) solution. returns 0 on
+ *  success, non-zero if the matrix is singular or on failure.
+ */
+int mtrx_solv_sym (mtrx_t *m);
+/** mtrx_solv_sym_st - mtrx_solv_sym() recording log|det|, sign, growth
+ *  and the estimated condition number of the factors in st (if not NULL),
+ *  O(n^2) in addition to the solve.
+ */
+int mtrx_solv_sym_st (mtrx_t *m, mtrx_stat_t *st);
+
+#endif
@@ -6,6 +6,7 @@
 #include <string.h>
 #include <ctype.h>
 #include <errno.h>
+#include <limits.h>
 #include <math.h>
 
 typedef double T;       /* must set T typedef for type */
@@ -13,8 +14,52 @@ typedef double T;       /* must set T typedef for type */
 typedef struct {        /* matrix struct */
     size_t rows, cols, rowmax, colmax;
     T **mtrx;
+    T *slab;            /* contiguous storage (NULL - rows allocated) */
+    size_t stride;      /* slab row stride in elements (0 - packed) */
+    size_t kl, ku;      /* lower/upper bandwidth of (rows x rows) block */
+    int band;           /* kl/ku measured (1), unknown (0) */
 } mtrx_t;
 
+/* packed lower triangle, row i holds i + 1 elements at slab + i*(i+1)/2 */
+#define MTRX_PACKED(m) ((m)->slab && !(m)->stride)
+
+typedef struct {        /* band matrix struct with k constant columns */
+    size_t n, kl, ku;   /* order, lower and upper bandwidth */
+    size_t w, nrhs;     /* band width per row (2*kl + ku + 1), k */
+    size_t ld;          /* row stride (w + nrhs) */
+    T *ab;              /* rows of w band elements followed by nrhs constants */
+} band_t;
+
+/* row i of band b indexed by column j (i - kl <= j <= i + kl + ku), the
+ * kl extra columns hold fill from row interchanges. constants of row i.
+ */
+#define BAND_ROW(b,i) ((b)->ab + (i) * (b)->ld + (b)->kl - (i))
+#define BAND_RHS(b,i) ((b)->ab + (i) * (b)->ld + (b)->w)
+
+typedef struct {        /* coordinate (triplet) matrix */
+    size_t rows, cols, nnz;
+    size_t kl, ku;      /* bandwidth of (rows x rows) block, as read */
+    size_t *ri, *ci;    /* row and col (0-based) of each element */
+    T *v;               /* element values */
+} coo_t;
+
+typedef struct {        /* compressed sparse row matrix with k constant cols */
+    size_t rows, cols, nnz;
+    size_t *rp;         /* row i elements at rp[i] -> rp[i+1]-1 (rows + 1) */
+    size_t *ci;         /* col of each element, ascending within a row */
+    T *v;               /* element values */
+    size_t nrhs;        /* constant columns k, (rows x k) col-major in b */
+    T *b;
+} csr_t;
+
+typedef struct {        /* solve statistics, by-products of the factorization */
+    T anrm, amax;       /* 1-norm and max |a(i,j)| of the coefficients */
+    T cond;             /* 1-norm condition number (estimate), NAN if n/a */
+    T logdet;           /* log |det A|, NAN if not available */
+    int sign;           /* sign of det A (-1, 1), 0 if not available */
+    T growth;           /* pivot growth, max |u(i,j)| / max |a(i,j)| */
+} mtrx_stat_t;
+
 typedef struct {        /* vector struct (not fully implemented) */
     size_t nelem, nmax;
     T *vect;
@@ -25,11 +70,33 @@ typedef struct {        /* vector struct (not fully implemented) */
 
 #define MAXC 8192       /* max chars per-row to read */
 
+#define MTRX_ALIGN 64   /* slab and row alignment (bytes) */
+
 #define T_FP_MAX  1.0e-20    /* floating-point values considered zero */
 #define T_FP_MIN -1.0e-20
 
 enum { ROWOP, COLOP };  /* row operation/column operation consts */
 
+enum { SOLV_GAUSSJ, SOLV_LU, SOLV_GAUSS, SOLV_MIXED, SOLV_RLU }; /* methods */
+enum { PIV_FULL, PIV_ROOK };                /* pivoting consts */
+
+#ifndef LU_NB
+#define LU_NB  64       /* blocked LU panel width (columns) */
+#endif
+#ifndef LU_NC
+#define LU_NC 256       /* blocked LU trailing update column tile */
+#endif
+#ifndef TRANS_NB
+#define TRANS_NB 32     /* transpose cache tile (rows/cols) */
+#endif
+#define TRANS_MIN (1u << 16)    /* elements before a transpose is threaded */
+#ifndef RLU_NB
+#define RLU_NB 64       /* recursive LU base case (rows/cols), set at build */
+#endif
+#ifndef RLU_NW
+#define RLU_NW 512      /* recursive LU base case row width (cols) */
+#endif
+
 /* __func__ is not defined in pre C99 so provide fallback */
 #if __STDC_VERSION__ < 199901L
 # if __GNUC__ >= 2
@@ -47,6 +114,24 @@ T **mtrx_calloc (const size_t m, const size_t n);
 mtrx_t *mtrx_create_ptrs (const size_t m);
 /** allocate/initialize struct T and (m x n) matrix, set rowmax/colmax */
 mtrx_t *mtrx_create_fixed (const size_t m, const size_t n);
+/** mtrx_create_slab - allocate/initialize struct T with (m x n) matrix
+ *  in a single zeroed MTRX_ALIGN aligned slab. row stride is padded to a
+ *  multiple of MTRX_ALIGN (and away from multiples of 4096 bytes), rows are
+ *  reachable through m->mtrx as for any mtrx_t. set rowmax/colmax.
+ */
+mtrx_t *mtrx_create_slab (const size_t m, const size_t n);
+/** mtrx_create_packed - allocate/initialize struct T with (n x n) packed
+ *  lower triangle in a single zeroed MTRX_ALIGN aligned slab of
+ *  n*(n+1)/2 elements. m->mtrx[i][j] (j <= i) addresses element (i,j) as
+ *  for any mtrx_t, stride is 0. sets rows/cols, rowmax/colmax to n.
+ */
+mtrx_t *mtrx_create_packed (const size_t n);
+/** mtrx_slab - move row allocated matrix into contiguous slab storage.
+ *  copies m->rows x m->cols into a new slab, frees the individual rows and
+ *  points m->mtrx into the slab. no-op if m already uses a slab. returns
+ *  0 on success, -1 on allocation failure (m unchanged).
+ */
+int mtrx_slab (mtrx_t *m);
 /** realloc matrix pointers to twice current */
 T **mtrx_realloc_ptrs (mtrx_t *m);
 /** realloc matrix_fixed, which = 0 realloc ptrs, 1 column storage.
@@ -55,69 +140,280 @@ T **mtrx_realloc_ptrs (mtrx_t *m);
  *  for each row realloc.
  */
 T **mtrx_realloc_fixed (mtrx_t *m, const int which);
-/** read (m x n) matrix from file stream into dynamically sized T *mtrx.
- *  pointers are reallocated x2 as needed, row storage is reallocated
- *  x2 as required to store all values in 1st row of data, then row storage
- *  is reallocate to shrink row allocation to exact number of columns and
- *  T->colmax is set. following read of all data, pointer storage is reduced
- *  to T->nrows and T->rowmax is set.
+/** parse_skip - skip to the start of the next number in p, (sign or '.'
+ *  followed by a digit or '.', or a digit), returns pointer to the
+ *  nul-character if none. used by the readers of every element type.
+ */
+char *parse_skip (char *p);
+/** read (m x n) matrix from file stream into slab storage. each line is
+ *  converted straight into its row of a single MTRX_ALIGN aligned slab,
+ *  the first row setting the number of columns and the slab doubling in
+ *  rows as needed. the slab is then shrunk to the rows read and the row
+ *  pointers set once, so T->rowmax and T->colmax are exact.
  */
 mtrx_t *mtrx_read_alloc (FILE *fp);
+/** mtrx_read_alloc_buf - mtrx_read_alloc() from a nul-terminated buffer,
+ *  the slab sized for the number of lines in the buffer.
+ */
 mtrx_t *mtrx_read_alloc_buf (char *textviewbuf);
-/** matr_read_fixed, alloc/read (m x n) matrix from file stream.
- *  reallocate as required, but should not be required if correct initial
- *  size given. matrix is resized to exact number of rows and pointers
- *  before return.
+/** matr_read_fixed, alloc/read (m x n) matrix from file stream into slab
+ *  storage sized for 'rows' rows, growing if more are read. the number of
+ *  columns is set by the first row ('cols' is not needed). matrix is
+ *  resized to exact number of rows and pointers before return.
  */
 mtrx_t *mtrx_read_fixed (FILE *fp, const size_t rows, const size_t cols);
+/** mtrx_read_coo - read Matrix Market coordinate file ("%%MatrixMarket
+ *  matrix coordinate real general", then "rows cols nnz" and nnz lines of
+ *  "row col value", 1-based) into coo_t. for a (n x n+k) system cols n+1
+ *  .. n+k are the constants. the bandwidth of the (rows x rows) block is
+ *  measured as entries are read. returns pointer to coo_t on success,
+ *  NULL otherwise.
+ */
+coo_t *mtrx_read_coo (FILE *fp);
+/** free coo_t and storage */
+void coo_free (coo_t *c);
+/** mtrx_bandwidth - set m->kl/m->ku to the lower and upper bandwidth of
+ *  the (rows x rows) coefficient block and mark them measured. the readers
+ *  measure the bandwidth row by row as values are parsed, this is only
+ *  needed when m was filled (or changed) by other means.
+ */
+void mtrx_bandwidth (mtrx_t *m);
 /** output matrix to stdout with/pad */
 void mtrx_prn (const mtrx_t *m, int width);
 /** print a (m x m+1) system of linear equations with separtor */
 void mtrx_sys_prn (const mtrx_t *m, int width);
 /** print a (m x m) matrix from (m x n) with n > m */
 void mtrx_prn_sq (const mtrx_t *m, int width);
-/** copy a struct matrix */
+/** copy a struct matrix (copy uses slab storage) */
 mtrx_t *mtrx_copy (const mtrx_t *ma);
 /** free a (m x n) matrix and struct for m->nrows pointers */
 void mtrx_free (mtrx_t *m);
 
-/** add two struct matricies */
+/** add two struct matricies (see mtrx_expr.h for in place and fused) */
 mtrx_t *mtrx_add (const mtrx_t *ma, const mtrx_t *mb);
 /** subtract two struct matricies */
 mtrx_t *mtrx_sub (const mtrx_t *ma, const mtrx_t *mb);
-/** multiply two struct matricies */
+/** multiply two struct matricies (packed, threaded, see mtrx_gemm()) */
 mtrx_t *mtrx_mult (const mtrx_t *ma, const mtrx_t *mb);
-/** transpose matrix */
+/** mtrx_mult_add - mc = alpha ma mb + beta mc in place, ma (m x n), mb
+ *  (n x p), mc (m x p). returns 0 on success, -1 on unequal dimensions.
+ */
+int mtrx_mult_add (const T alpha, const mtrx_t *ma, const mtrx_t *mb,
+                   const T beta, mtrx_t *mc);
+/** transpose matrix (tiled, threaded, see m_trans_blk()) */
 mtrx_t *mtrx_trans (const mtrx_t *m);
+/** mtrx_trans_ip - transpose m in place. square matrices (any storage
+ *  other than packed) are transposed by exchanging blocks, otherwise m must
+ *  use slab storage and is permuted by following the cycles of the index
+ *  map (a bitmap of rows * cols bits is the only extra storage). returns 0
+ *  on success, -1 on invalid storage or allocation failure (m unchanged).
+ */
+int mtrx_trans_ip (mtrx_t *m);
+/** m_trans_blk - b = a^T, a (m x n), b (n x m), in (TRANS_NB x TRANS_NB)
+ *  blocks of register transposed tiles, blocks of rows of a split over
+ *  mtrx_nthrd_get() threads above TRANS_MIN elements.
+ */
+void m_trans_blk (T * const *a, T * const *b, const size_t m,
+                  const size_t n);
 
-/** solve system of equations */
+/** solve system of equations, (3 x 3) by cofactors, others by LU */
 T *mtrx_solv (const mtrx_t *m, const T *v);
+/** mtrx_det - determinant of the (n x n) leading block of m (n = m->rows,
+ *  m->cols >= n) from the blocked LU of a copy, as the sign in *sign and
+ *  log |det| in *logdet, so it cannot overflow. a singular block gives
+ *  sign 0 and logdet -INFINITY. returns 0 on success, -1 on invalid
+ *  matrix or allocation failure.
+ */
+int mtrx_det (const mtrx_t *m, int *sign, T *logdet);
 /** mtrx_solv_cmb - solves system of eq where m contains solution vect.
  *  solves system where m contains the solution vector as the last column
  *  in the form {m} = {m'}[v] where {m'} is the coefficient matrix and [v]
- *  the solution vector. it is a wrapper for mtrx_solv() above. returns
- *  a vector containing the unique solution or NULL if {m'} is singular
- *  or the solutions are infinite or trivial.
+ *  the solution vector. systems of order FIX_NMIN -> FIX_NMAX are solved
+ *  by the unrolled fixed order solvers, others (and singular (3 x 3)) by
+ *  mtrx_solv() above. returns a vector containing the unique solution or
+ *  NULL if {m'} is singular or the solutions are infinite or trivial.
  */
 T *mtrx_solv_cmb (mtrx_t *m);
 /** Guass-Jordan elimination with full pivoting.
  *  'a' is coefficient matrix with constant vector as last col.
  *  on return 'a' contains matrix inverse, last col contains
- *  solution vector.
+ *  solution vector. returns 0 on success, 1 if 'a' is singular.
+ */
+int mtrx_solv_gaussj (T **a, const size_t n);
+/** mtrx_solv_gaussj_st - mtrx_solv_gaussj() recording log|det|, sign and
+ *  growth from the pivots and the exact condition number from the inverse
+ *  in st (if not NULL), O(n^2) in addition to the solve.
+ */
+int mtrx_solv_gaussj_st (T **a, const size_t n, mtrx_stat_t *st);
+int mtrx_solv_gaussj_v (T **a, T *v, const size_t n);
+/** mtrx_solv_gauss - solve only, Gaussian elimination with full pivoting.
+ *  'a' is coefficient matrix with constant vector as last col. reduces the
+ *  system to upper triangular form (rows exchanged by pointer, columns in
+ *  place with the exchange recorded) followed by back substitution. no
+ *  inverse is formed and only the solution vector is unscrambled. the
+ *  next pivot search is folded into the elimination, or with PIV_ROOK
+ *  set by mtrx_piv_set() rook pivoting is used. on return the last col
+ *  contains the solution vector. returns 0 on success, 1 if 'a' is
+ *  singular.
+ */
+int mtrx_solv_gauss (T **a, const size_t n);
+/** mtrx_solv_gauss_st - mtrx_solv_gauss() recording log|det|, sign,
+ *  growth and the estimated condition number of the factors P A Q = L U
+ *  (multipliers kept below the diagonal) in st (if not NULL), O(n^2) in
+ *  addition to the solve.
+ */
+int mtrx_solv_gauss_st (T **a, const size_t n, mtrx_stat_t *st);
+/** mtrx_piv_set - set pivoting used by the solve only Gaussian solvers,
+ *  PIV_FULL or PIV_ROOK. returns the mode set (unknown modes are ignored).
+ */
+int mtrx_piv_set (const int mode);
+/** mtrx_piv_get - get pivoting used by the solve only Gaussian solvers */
+int mtrx_piv_get (void);
+/** mtrx_piv_cmax - exact column maxima of a[k..n-1][k..n-1] in cmax[k..],
+ *  a single row-wise pass to seed the bounds used by mtrx_piv_rook().
+ */
+void mtrx_piv_cmax (T * const *a, const size_t n, const size_t k, T *cmax);
+/** mtrx_piv_rook - rook pivot search of the active block a[k..n-1][k..n-1].
+ *  starting at the column with the largest bound in cmax[], alternates
+ *  column and row searches until a[irow][icol] is the largest element in
+ *  both its row and its column. cmax[j] is an upper bound on fabs of
+ *  column j of the active block, made exact for each column searched.
+ *  returns fabs of the pivot, 0.0 if the block is singular.
+ */
+T mtrx_piv_rook (T * const *a, const size_t n, const size_t k, T *cmax,
+                 size_t *irow, size_t *icol);
+/** mtrx_piv_row - fold row i (cols c0 -> n-1 with msk[j] != 0, msk NULL
+ *  all) into a running full pivot search, keeping the last maximum (>=)
+ *  in row-major order.
+ */
+void mtrx_piv_row (const T *row, const size_t i, const size_t c0,
+                   const size_t n, const T *msk,
+                   T *big, size_t *irow, size_t *icol);
+/** mtrx_gauss_xchg - pivot step k exchanges for mtrx_solv_gauss(), row
+ *  irow (by pointer) and col icol with k, recorded in perm (cols) and rp
+ *  (rows, if not NULL), rook bounds cmax (if not NULL) updated.
+ */
+void mtrx_gauss_xchg (T **a, const size_t n, const size_t k,
+                      const size_t irow, const size_t icol,
+                      size_t *perm, size_t *rp, T *cmax);
+/** mtrx_gauss_elim - eliminate col k below the pivot from rows lo -> hi-1
+ *  (multipliers kept in L), with big not NULL searching each row for the
+ *  next pivot while in cache. shared by the serial and threaded solvers.
+ */
+void mtrx_gauss_elim (T **a, const size_t n, const size_t k,
+                      const size_t lo, const size_t hi,
+                      T *big, size_t *irow, size_t *icol);
+/** mtrx_gauss_back - back substitution of the reduced system, solution
+ *  (y scratch of n) unscrambled by perm into the last col.
  */
-void mtrx_solv_gaussj (T **a, const size_t n);
-void mtrx_solv_gaussj_v (T **a, T *v, const size_t n);
+void mtrx_gauss_back (T **a, const size_t n, const size_t *perm, T *y);
 /** mtrx_solv_gaussj_inv returns mtrx_t containing inverse + solution.
  *  wrapper preserving original mtrx_t, allocating a copy before calling
  *  mtrx_solv_gaussj to create inverse of m and solution vector in newly
  *  allocted mtrx_t. user is responsible for freeing return.
  */
 mtrx_t *mtrx_solv_gaussj_inv (const mtrx_t *m);
+/** mtrx_lu_fact - right-looking blocked LU with partial pivoting.
+ *  factors the (n x n) leading block of 'a' in place as P a = L U with
+ *  L unit lower (below diagonal) and U upper. rows are interchanged by
+ *  exchanging row pointers, piv[k] holds the row exchanged with row k at
+ *  step k. returns 0 on success, k + 1 if U[k][k] is exactly zero.
+ */
+int mtrx_lu_fact (T **a, size_t *piv, const size_t n);
+/** mtrx_lu_fact_rect - mtrx_lu_fact() of the first n cols of the (m x ncol)
+ *  block of 'a', m >= n (a panel of a larger matrix). pivots are searched
+ *  over all m rows and the exchanges and updates are carried through cols
+ *  n -> ncol. returns 0 on success, k + 1 if U[k][k] is exactly zero.
+ */
+int mtrx_lu_fact_rect (T **a, size_t *piv, const size_t m, const size_t n,
+                       const size_t ncol);
+/** mtrx_lu_solv - solve a x = b from mtrx_lu_fact factors and pivots.
+ *  applies piv to b, then forward and back substitution, b is overwritten
+ *  with the solution vector.
+ */
+void mtrx_lu_solv (T * const *lu, const size_t *piv, T *b, const size_t n);
+/** mtrx_lu_solv_m - solve a X = B from mtrx_lu_fact factors and pivots
+ *  for the nrhs cols jb -> jb+nrhs-1 of rows b by blocked forward and back
+ *  substitution (level-3 for nrhs > 1), B overwritten with X.
+ */
+void mtrx_lu_solv_m (T * const *lu, const size_t *piv, T * const *b,
+                     const size_t jb, const size_t n, const size_t nrhs);
+/** mtrx_solv_lu_m - solve (n x n+nrhs) system by blocked LU.
+ *  'a' is coefficient matrix with nrhs constant vectors as the last cols.
+ *  the matrix is factored once with all constant columns carried through
+ *  the blocked trailing updates, followed by blocked back substitution
+ *  (level-3 for nrhs > 1). on return 'a' contains the LU factors (rows
+ *  permuted) and the last nrhs cols contain the (n x nrhs) solution.
+ *  returns 0 on success, non-zero if the matrix is singular.
+ */
+int mtrx_solv_lu_m (T **a, const size_t n, const size_t nrhs);
+/** mtrx_solv_lu_st - mtrx_solv_lu_m() recording log|det|, sign, growth
+ *  and the estimated condition number of the factors in st (if not NULL),
+ *  O(n^2) in addition to the solve.
+ */
+int mtrx_solv_lu_st (T **a, const size_t n, const size_t nrhs,
+                     mtrx_stat_t *st);
+/** mtrx_solv_lu - solve (n x n+1) system by blocked LU.
+ *  'a' is coefficient matrix with constant vector as last col. the
+ *  constant column is carried through the factorization so only back
+ *  substitution remains. on return 'a' contains the LU factors (rows
+ *  permuted) and the last col contains the solution vector. returns 0
+ *  on success, non-zero if the matrix is singular.
+ */
+int mtrx_solv_lu (T **a, const size_t n);
+/** mtrx_rlu_fact - recursive (cache-oblivious) LU with partial pivoting.
+ *  the columns are split in half, the left half factored, the right half
+ *  updated, then factored, to a base case of RLU_NB cols. the triangular
+ *  solve and update are split the same way, so every level works on
+ *  blocks that halve until they fit whatever cache is present, without
+ *  a tuned block size. factors and pivots as mtrx_lu_fact(). returns 0
+ *  on success, k + 1 if U[k][k] is exactly zero.
+ */
+int mtrx_rlu_fact (T **a, size_t *piv, const size_t n);
+/** mtrx_solv_rlu_st - solve (n x n+nrhs) system by recursive LU. the
+ *  constant columns receive the row exchanges with the factorization and
+ *  are then solved by recursive forward and back substitution. on return
+ *  'a' contains the LU factors (rows permuted) and the last nrhs cols the
+ *  (n x nrhs) solution. statistics are recorded in st (if not NULL).
+ *  returns 0 on success, non-zero if the matrix is singular.
+ */
+int mtrx_solv_rlu_st (T **a, const size_t n, const size_t nrhs,
+                      mtrx_stat_t *st);
+/** mtrx_solv_sys - solve (n x n+k) system in m with solver 'method'. method
+ *  is one of SOLV_GAUSS (solution only), SOLV_GAUSSJ (inverse + solution),
+ *  SOLV_LU, SOLV_RLU (recursive LU) or SOLV_MIXED (float LU refined in
+ *  double, see mtrx_solv_mixed()). SOLV_GAUSS and SOLV_GAUSSJ use the
+ *  threaded row updates when mtrx_nthrd_set() is greater than 1. other than
+ *  for SOLV_GAUSSJ, narrow band systems (see mtrx_is_band()) are solved in
+ *  band storage, and with the default SOLV_GAUSS symmetric systems by
+ *  packed Cholesky or LDL^T (an explicit method is not overridden). other
+ *  than for SOLV_MIXED, systems with more than one constant column (k > 1)
+ *  are factored once by blocked LU. other than for SOLV_MIXED, non-singular
+ *  systems of order FIX_NMIN -> FIX_NMAX with one constant column are
+ *  solved by the unrolled fixed order solvers (mtrx_fixed.h). on return the
+ *  last k cols of m contain the (n x k) solution. a tall (m x n+1) system,
+ *  m >= n+1, is solved in the least-squares sense by blocked Householder QR
+ *  whatever the method (mtrx_solv_ls()), the n unknowns returned in rows
+ *  0 -> n-1 of the last col. returns 0 on success, non-zero otherwise.
+ */
+int mtrx_solv_sys (mtrx_t *m, const int method);
+/** mtrx_solv_sys_st - mtrx_solv_sys() returning the statistics of the
+ *  factorization in st (if not NULL), see mtrx_stat_t. the unrolled small
+ *  solvers report growth NAN, band and SOLV_MIXED solves anrm and amax
+ *  only (other fields NAN/0), least-squares solves none.
+ */
+int mtrx_solv_sys_st (mtrx_t *m, const int method, mtrx_stat_t *st);
 /** mtrx_get_sol_v return solution vector from inverse+solution mtrx_t.
- *  m must be a square matrix + constant vector as final column. returns
+ *  m must be a square matrix + constant vector as final column, or a
+ *  solved least-squares system (rows >= cols, cols-1 unknowns). returns
  *  allocated solution vector on success, NULL otherwise.
  */
 T *mtrx_get_sol_v (const mtrx_t *m);
+/** mtrx_get_sol_m return (n x k) solution block from solved mtrx_t.
+ *  m must be a square matrix + k constant vectors as final columns.
+ *  returns allocated (slab) mtrx_t on success, NULL otherwise.
+ */
+mtrx_t *mtrx_get_sol_m (const mtrx_t *m);
 
 /** qsort compare ascending for matrix */
 int mtrx_compare_rows_asc (const void *a, const void *b);
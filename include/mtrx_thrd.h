@@ -0,0 +1,64 @@
+#ifndef __mtrx_thrd_h__
+#define __mtrx_thrd_h__  1
+
+#include <pthread.h>
+
+#include "mtrx_t.h"
+
+#define MTRX_THRD_MAX 256   /* maximum number of solver threads */
+
+/** reusable barrier (mutex/cond so the count can be reduced if thread
+ *  creation fails, and for platforms without pthread_barrier_t)
+ */
+typedef struct {
+    pthread_mutex_t mtx;
+    pthread_cond_t cv;
+    int count, waiting;
+    unsigned phase;
+} bar_t;
+
+/** bar_init - initialize barrier for count threads, returns 0 on success */
+int bar_init (bar_t *b, const int count);
+/** bar_destroy - release barrier resources */
+void bar_destroy (bar_t *b);
+/** bar_setcount - set count before the controlling thread first waits */
+void bar_setcount (bar_t *b, const int count);
+/** bar_wait - wait until count threads have arrived */
+void bar_wait (bar_t *b);
+
+/** mtrx_nthrd_set - set number of threads used by the threaded solvers.
+ *  n = 0 uses the number of online processors, n is clamped to
+ *  [1, MTRX_THRD_MAX]. returns the number of threads set.
+ */
+int mtrx_nthrd_set (int n);
+/** mtrx_nthrd_get - get number of threads used by the threaded solvers */
+int mtrx_nthrd_get (void);
+
+/** mtrx_solv_gaussj_thrd - threaded Guass-Jordan with full pivoting.
+ *  identical to mtrx_solv_gaussj() except the row updates for each pivot
+ *  step are split across nthrd threads with a barrier per pivot step. the
+ *  operations on each element are unchanged, so results are bit-identical
+ *  to the serial path. returns 0 on success, 1 if 'a' is singular.
+ */
+int mtrx_solv_gaussj_thrd (T **a, const size_t n, const int nthrd);
+/** mtrx_solv_gaussj_thrd_st - mtrx_solv_gaussj_thrd() recording the
+ *  statistics in st (if not NULL), see mtrx_solv_gaussj_st().
+ */
+int mtrx_solv_gaussj_thrd_st (T **a, const size_t n, const int nthrd,
+                              mtrx_stat_t *st);
+/** same taking a (n x n) and v, see mtrx_solv_gaussj_v() */
+int mtrx_solv_gaussj_v_thrd (T **a, T *v, const size_t n, const int nthrd);
+/** mtrx_solv_gauss_thrd - threaded solve only Gaussian elimination.
+ *  identical to mtrx_solv_gauss() except the rows below each pivot are
+ *  eliminated across nthrd threads with a barrier per pivot step, results
+ *  are bit-identical to the serial path. returns 0 on success, 1 if 'a'
+ *  is singular.
+ */
+int mtrx_solv_gauss_thrd (T **a, const size_t n, const int nthrd);
+/** mtrx_solv_gauss_thrd_st - mtrx_solv_gauss_thrd() recording the
+ *  statistics in st (if not NULL), see mtrx_solv_gauss_st().
+ */
+int mtrx_solv_gauss_thrd_st (T **a, const size_t n, const int nthrd,
+                             mtrx_stat_t *st);
+
+#endif
@@ -3,6 +3,11 @@
 #include <gdk-pixbuf/gdk-pixbuf.h>
 #include <gdk/gdkkeysyms.h>  /* for GDK key values */
 #include "mtrx_t.h"
+#include "mtrx_thrd.h"
+#include "mtrx_simd.h"
+#include "mtrx_cache.h"
+#include "mtrx_ooc.h"
+#include "mtrx_band.h"
 
 #define PACKAGE "gtksolver"
 #define VERSION "0.0.1"
@@ -48,6 +53,7 @@ typedef struct app {
                 *tagred;        /* Red tag */
     gboolean    showtoolbar,    /* show toolbar */
                 bottombuttons;  /* display bottom buttons */
+    gint        solvmethod;     /* SOLV_GAUSS/GAUSSJ/LU/MIXED/RLU */
 } app_t;
 
 /* set sensitivity of solver widgets */
@@ -59,6 +65,37 @@ void setsolvsensitive (gpointer data, gboolean state)
     gtk_widget_set_sensitive (inst->toolsolv, state);
 }
 
+/* output condition estimate, determinant and pivot growth of last solve,
+ * n/a where the solver does not provide them (band and mixed precision).
+ */
+static void gtksolv_stat (GtkTextBuffer *buffer, const mtrx_stat_t *st)
+{
+    GtkTextIter end;
+    gchar *s, *cond, *det, *growth;
+
+    cond = isnan (st->cond) ? g_strdup ("n/a") :
+                              g_strdup_printf ("%.4e", st->cond);
+    if (!st->sign || isnan (st->logdet))
+        det = g_strdup ("n/a");
+    else if (fabs (st->logdet) < 700.0)     /* exp() in range */
+        det = g_strdup_printf ("% .7e", st->sign * exp (st->logdet));
+    else
+        det = g_strdup_printf ("%c10^%.4f", st->sign < 0 ? '-' : '+',
+                               st->logdet / log (10.0));
+    growth = isnan (st->growth) ? g_strdup ("n/a") :
+                                  g_strdup_printf ("%.4e", st->growth);
+
+    s = g_strdup_printf ("\n cond(A) est : %s\n det(A)      : %s\n"
+                         " growth      : %s\n", cond, det, growth);
+    gtk_text_buffer_get_end_iter (buffer, &end);
+    gtk_text_buffer_insert (buffer, &end, s, -1);
+
+    g_free (s);
+    g_free (growth);
+    g_free (det);
+    g_free (cond);
+}
+
 /* Solve... button callback */
 void btnsolv_activate (GtkWidget *widget, gpointer data)
 {
@@ -68,6 +105,7 @@ void btnsolv_activate (GtkWidget *widget, gpointer data)
     gchar *buf, c, last = 0, prevlast = 0;
     gboolean havevalue = FALSE;
     GtkTextIter start, end, lastiter, previter;
+    mtrx_stat_t st;
     // GtkTextBuffer *buffer = GTK_TEXT_BUFFER(data);
     GtkTextBuffer *buffer;
 
@@ -117,21 +155,62 @@ void btnsolv_activate (GtkWidget *widget, gpointer data)
         /* fill matrix from values in buffer */
         mtrx_t *m = mtrx_read_alloc_buf (buf);
 
-        /* solve system by gauss-jordan elimintation will full-pivoting */
-        mtrx_solv_gaussj (m->mtrx, m->rows);    /* m->mtrx now contains
-                                                 * inverse + solution vector
-                                                 */
-
-        /* output formatted solution vector */
-        gtk_text_buffer_insert (buffer, &end, "\n\nSolution Vector:\n\n", -1);
-        for (i = 0; i < m->rows; i++) { /* output formatted solution vector */
-            gchar *x;
-            x = g_strdup_printf (" x[%3" SZTFMT "] : % 11.7f\n",
-                                    i, m->mtrx[i][m->rows]);
-            gtk_text_buffer_get_end_iter (buffer, &end);
-            gtk_text_buffer_insert (buffer, &end, x, -1);
-            g_free(x);
+        /* solve system with selected solver, (gaussian or gauss-jordan
+         * elimination with full-pivoting or blocked LU with partial
+         * pivoting), last column of m->mtrx now contains solution vector.
+         * (N x N+k) input is factored once, last k columns hold solutions.
+         * LU factors are cached, so when only the constants change the
+         * re-solve is forward and back substitution alone.
+         */
+        if (!m || mtrx_cache_solv_st (m, inst->solvmethod, &st)) {
+            havevalue = FALSE;
+            gtk_text_buffer_insert (buffer, &end,
+                "\n\n => ERROR: Singular or Invalid System of Equations\n", -1);
+        }
+        else {
+            /* (M x N+1) input with M > N is solved in the least-squares
+             * sense, N unknowns in the first N rows of the last column.
+             */
+            int ls = m->rows >= m->cols;
+            size_t j, n = ls ? m->cols - 1 : m->rows,
+                   nrhs = ls ? 1 : m->cols - m->rows;
+
+            /* output formatted solution vector (or N x k block) */
+            gtk_text_buffer_insert (buffer, &end, ls ?
+                                    "\n\nLeast-Squares Solution:\n\n" :
+                                    nrhs > 1 ?
+                                    "\n\nSolution Matrix:\n\n" :
+                                    "\n\nSolution Vector:\n\n", -1);
+            for (i = 0; i < n; i++) {   /* output formatted solution vector */
+                gchar *x;
+                x = g_strdup_printf (" x[%3" SZTFMT "] :", i);
+                gtk_text_buffer_get_end_iter (buffer, &end);
+                gtk_text_buffer_insert (buffer, &end, x, -1);
+                g_free(x);
+                for (j = 0; j < nrhs; j++) {
+                    x = g_strdup_printf (" % 11.7f", m->mtrx[i][n + j]);
+                    gtk_text_buffer_get_end_iter (buffer, &end);
+                    gtk_text_buffer_insert (buffer, &end, x, -1);
+                    g_free(x);
+                }
+                gtk_text_buffer_get_end_iter (buffer, &end);
+                gtk_text_buffer_insert (buffer, &end, "\n", -1);
+            }
+            if (ls) {   /* residual in rows N -> M-1 of the last column */
+                gchar *r;
+                T rss = 0.0;
+                for (i = n; i < m->rows; i++)
+                    rss += m->mtrx[i][n] * m->mtrx[i][n];
+                r = g_strdup_printf ("\n ||Ax - b||  : %.7e\n", sqrt (rss));
+                gtk_text_buffer_get_end_iter (buffer, &end);
+                gtk_text_buffer_insert (buffer, &end, r, -1);
+                g_free (r);
+            }
+            else
+                gtksolv_stat (buffer, &st); /* cond, det and growth */
         }
+        if (m)
+            mtrx_free (m);
         g_free (buf);
     }
     else
@@ -809,6 +888,7 @@ void init_iface (app_t *inst, int argc, char **argv)
 
     /* set default TRUE for default interface widgets */
     inst->showtoolbar = TRUE;
+    inst->solvmethod = SOLV_GAUSS;    /* solution vector only */
 
     /* iterate over command line options */
     for (; i < argc; i++) {
@@ -817,6 +897,33 @@ void init_iface (app_t *inst, int argc, char **argv)
                 case 'b':
                     inst->bottombuttons = TRUE;
                     break;
+                case 'c':   /* -cN or -c N MiB LU factor cache, (0 - off) */
+                    if (argv[i][2])
+                        mtrx_cache_limit ((size_t)atoi (&argv[i][2]) << 20);
+                    else if (i + 1 < argc)
+                        mtrx_cache_limit ((size_t)atoi (argv[++i]) << 20);
+                    break;
+                case 'g':   /* Gauss-Jordan, forms inverse in place */
+                    inst->solvmethod = SOLV_GAUSSJ;
+                    break;
+                case 'l':
+                    inst->solvmethod = SOLV_LU;
+                    break;
+                case 'm':   /* float LU refined to double accuracy */
+                    inst->solvmethod = SOLV_MIXED;
+                    break;
+                case 'R':   /* recursive (cache-oblivious) LU */
+                    inst->solvmethod = SOLV_RLU;
+                    break;
+                case 'r':   /* rook pivoting for solve only Gaussian */
+                    mtrx_piv_set (PIV_ROOK);
+                    break;
+                case 'j':   /* -jN or -j N threads, (0 - all processors) */
+                    if (argv[i][2])
+                        mtrx_nthrd_set (atoi (&argv[i][2]));
+                    else if (i + 1 < argc)
+                        mtrx_nthrd_set (atoi (argv[++i]));
+                    break;
                 case 't':
                     inst->showtoolbar = FALSE;
                     break;
@@ -825,9 +932,79 @@ void init_iface (app_t *inst, int argc, char **argv)
     }
 }
 
+/* headless out-of-core solve when '-o file' is given ('-' stdin), or band
+ * solve of a Matrix Market file read directly into band storage when
+ * '-B file' is given, the solution is written to stdout. '-s path' sets
+ * the scratch file, '-M N' the memory budget in MiB, '-j N' threads.
+ * returns the exit status, or -1 if neither is given and the interface
+ * is started.
+ */
+static int headless (int argc, char **argv)
+{
+    const char *in = NULL, *scratch = "gtksolver.ooc";
+    size_t mem = 0;
+    FILE *fp;
+    int i = 1, rtn, band = 0;
+
+    for (; i < argc; i++) {
+        const char *arg;
+        const int opt = *argv[i] == '-' ? argv[i][1] : 0;
+
+        if (!opt || !strchr ("oBMsj", opt))
+            continue;
+        if (argv[i][2])             /* -xVAL or -x VAL */
+            arg = &argv[i][2];
+        else if (i + 1 < argc)
+            arg = argv[++i];
+        else
+            continue;
+
+        switch (opt) {
+            case 'o':
+                in = arg;
+                break;
+            case 'B':   /* Matrix Market band system */
+                in = arg;
+                band = 1;
+                break;
+            case 's':
+                scratch = arg;
+                break;
+            case 'M':
+                mem = (size_t)atoi (arg) << 20;
+                break;
+            case 'j':
+                mtrx_nthrd_set (atoi (arg));
+                break;
+        }
+    }
+    if (!in)
+        return -1;
+
+    if (!(fp = strcmp (in, "-") ? fopen (in, "r") : stdin)) {
+        fprintf (stderr, "error: file open failed '%s'.\n", in);
+        return 1;
+    }
+    if (band)
+        rtn = mtrx_solv_band_file (fp, stdout);
+    else
+        rtn = mtrx_ooc_solv_file (fp, stdout, scratch, mem);
+    if (fp != stdin)
+        fclose (fp);
+
+    return rtn ? 1 : 0;
+}
+
 int main (int argc, char **argv)
 {
     app_t inst = { .text_view = NULL };
+    int rtn;
+
+    mtrx_simd_init();   /* select row operation kernels by CPUID */
+
+    if ((rtn = headless (argc, argv)) != -1)
+        return rtn;
+
     gtk_init (&argc, &argv);
 
     init_iface (&inst, argc, argv);
@@ -838,5 +1015,7 @@ int main (int argc, char **argv)
 
     gtk_main();
 
+    mtrx_cache_clear();
+
     return 0;
 }
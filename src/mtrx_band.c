@@ -0,0 +1,297 @@
+#include "mtrx_band.h"
+#include "mtrx_simd.h"
+
+/** band_create - allocate zeroed (n x n) band_t with kl/ku bandwidth and
+ *  nrhs constant columns, n * (2*kl + ku + 1 + nrhs) elements. returns
+ *  pointer to band_t on success, NULL otherwise.
+ */
+band_t *band_create (const size_t n, const size_t kl, const size_t ku,
+                     const size_t nrhs)
+{
+    band_t *b = calloc (1, sizeof *b);
+
+    if (!b) {
+        fprintf (stderr, "%s() error: calloc-b.\n", __func__);
+        return NULL;
+    }
+
+    b->n = n;
+    b->kl = kl;
+    b->ku = ku;
+    b->w = 2 * kl + ku + 1;
+    b->nrhs = nrhs;
+    b->ld = b->w + nrhs;
+
+    if (!(b->ab = calloc (n * b->ld, sizeof *b->ab))) {
+        fprintf (stderr, "%s() error: memory exhausted calloc-ab.\n",
+                __func__);
+        free (b);
+        return NULL;
+    }
+
+    return b;
+}
+
+/** free band_t and storage */
+void band_free (band_t *b)
+{
+    free (b->ab);
+    free (b);
+}
+
+/** band_from_mtrx - copy (n x n+k) system m into a new band_t using the
+ *  measured m->kl/m->ku. returns pointer to band_t on success, NULL
+ *  otherwise.
+ */
+band_t *band_from_mtrx (const mtrx_t *m)
+{
+    const size_t n = m->rows;
+    band_t *b = band_create (n, m->kl, m->ku, m->cols - n);
+    register size_t i, j;
+
+    if (!b)
+        return NULL;
+
+    for (i = 0; i < n; i++) {
+        T *ri = BAND_ROW (b, i);
+        size_t j1 = i + b->ku < n ? i + b->ku : n - 1;
+
+        for (j = i > b->kl ? i - b->kl : 0; j <= j1; j++)
+            ri[j] = m->mtrx[i][j];
+        memcpy (BAND_RHS (b, i), m->mtrx[i] + n, b->nrhs * sizeof *b->ab);
+    }
+
+    return b;
+}
+
+/* back substitution of upper triangular band (bandwidth kl + ku) */
+static void band_bsolv (band_t *b)
+{
+    const size_t n = b->n;
+    register size_t j, c;
+    size_t k = n;
+
+    while (k--) {
+        size_t j1 = k + b->kl + b->ku < n ? k + b->kl + b->ku : n - 1;
+        T *rk = BAND_ROW (b, k), *xk = BAND_RHS (b, k);
+
+        for (c = 0; c < b->nrhs; c++) {
+            T sum = xk[c];
+            for (j = k + 1; j <= j1; j++)
+                sum -= rk[j] * BAND_RHS (b, j)[c];
+            xk[c] = sum / rk[k];
+        }
+    }
+}
+
+/** band_solv_lu - solve band system by LU with partial pivoting, rows
+ *  interchanged within the band and the constants carried with them, the
+ *  (kl extra) fill kept in the band. on return the constants hold the
+ *  solution. returns 0 on success, k + 1 if singular at k.
+ */
+int band_solv_lu (band_t *b)
+{
+    const size_t n = b->n;
+    register size_t i, k;
+
+    for (k = 0; k < n; k++) {
+        size_t i1 = k + b->kl < n ? k + b->kl : n - 1,     /* last row */
+               j1 = k + b->kl + b->ku < n ? k + b->kl + b->ku : n - 1,
+               p = k;
+        T *rk = BAND_ROW (b, k), big = fabs (rk[k]);
+
+        for (i = k + 1; i <= i1; i++)   /* pivot from rows in band */
+            if (fabs (BAND_ROW (b, i)[k]) > big) {
+                big = fabs (BAND_ROW (b, i)[k]);
+                p = i;
+            }
+        if (big == 0.0) {
+            fprintf (stderr, "%s() error: singular matrix.\n", __func__);
+            return k + 1;
+        }
+
+        if (p != k) {   /* columns k..j1 are the only non-zero in either row */
+            mtrx_kern.swap (j1 - k + 1, rk + k, BAND_ROW (b, p) + k);
+            mtrx_kern.swap (b->nrhs, BAND_RHS (b, k), BAND_RHS (b, p));
+        }
+
+        for (i = k + 1; i <= i1; i++) {
+            T *ri = BAND_ROW (b, i), l = ri[k] / rk[k];
+
+            if (l == 0.0)
+                continue;
+            ri[k] = 0.0;
+            mtrx_kern.axpy (j1 - k, -l, rk + k + 1, ri + k + 1);
+            mtrx_kern.axpy (b->nrhs, -l, BAND_RHS (b, k), BAND_RHS (b, i));
+        }
+    }
+
+    band_bsolv (b);
+
+    return 0;
+}
+
+/** band_solv_thomas - solve tridiagonal (kl = ku = 1) system by the Thomas
+ *  algorithm (elimination without pivoting), stable when the matrix is
+ *  diagonally dominant. on return the constants hold the solution. returns
+ *  0 on success, k + 1 if a zero pivot is found at k.
+ */
+int band_solv_thomas (band_t *b)
+{
+    const size_t n = b->n;
+    register size_t i, c;
+
+    if (b->kl != 1 || b->ku != 1) {
+        fprintf (stderr, "%s() error: not tridiagonal (kl %zu, ku %zu).\n",
+                __func__, b->kl, b->ku);
+        return -1;
+    }
+
+    for (i = 0; i < n; i++) {
+        T *ri = BAND_ROW (b, i), *rn, *x = BAND_RHS (b, i), l;
+
+        if (ri[i] == 0.0) {
+            fprintf (stderr, "%s() error: zero pivot.\n", __func__);
+            return i + 1;
+        }
+        if (i + 1 == n)
+            break;
+
+        rn = BAND_ROW (b, i + 1);   /* eliminate sub-diagonal of next row */
+        l = rn[i] / ri[i];
+        rn[i] = 0.0;
+        rn[i + 1] -= l * ri[i + 1];
+        for (c = 0; c < b->nrhs; c++)
+            x[b->ld + c] -= l * x[c];
+    }
+
+    band_bsolv (b);
+
+    return 0;
+}
+
+/** band_solv - solve band system, diagonally dominant tridiagonal systems
+ *  by band_solv_thomas(), all others by band_solv_lu().
+ */
+int band_solv (band_t *b)
+{
+    register size_t i;
+
+    if (b->kl != 1 || b->ku != 1)
+        return band_solv_lu (b);
+
+    for (i = 0; i < b->n; i++) {    /* |a(i,i)| >= |a(i,i-1)| + |a(i,i+1)| */
+        T *ri = BAND_ROW (b, i);
+        T off = (i ? fabs (ri[i - 1]) : 0.0) +
+                (i + 1 < b->n ? fabs (ri[i + 1]) : 0.0);
+
+        if (fabs (ri[i]) < off)
+            return band_solv_lu (b);
+    }
+
+    return band_solv_thomas (b);
+}
+
+/** mtrx_is_band - return 1 if the coefficient block of the (n x n+k) system
+ *  m is narrow enough for band storage, (2*kl + ku + 1) * MTRX_BAND_DIV
+ *  <= n, 0 otherwise. the bandwidth is measured if not already known.
+ */
+int mtrx_is_band (mtrx_t *m)
+{
+    if (!m || m->cols <= m->rows)
+        return 0;
+
+    if (!m->band)
+        mtrx_bandwidth (m);
+
+    return (2 * m->kl + m->ku + 1) * MTRX_BAND_DIV <= m->rows;
+}
+
+/** mtrx_solv_band - solve (n x n+k) system with band coefficients by
+ *  band_solv(). the coefficient block of m is unchanged, on return the
+ *  last k cols of m contain the (n x k) solution. returns 0 on success,
+ *  non-zero if the matrix is singular or on failure.
+ */
+int mtrx_solv_band (mtrx_t *m)
+{
+    band_t *b;
+    register size_t i;
+    int info;
+
+    if (!m->band)
+        mtrx_bandwidth (m);
+
+    if (!(b = band_from_mtrx (m)))
+        return -1;
+
+    if (!(info = band_solv (b)))
+        for (i = 0; i < m->rows; i++)
+            memcpy (m->mtrx[i] + m->rows, BAND_RHS (b, i),
+                    b->nrhs * sizeof *b->ab);
+
+    band_free (b);
+
+    return info;
+}
+
+/** mtrx_read_band - read (n x n+k) system in Matrix Market coordinate
+ *  format (see mtrx_read_coo()) directly into band storage, using the
+ *  bandwidth measured as entries are read, so large band systems never
+ *  need (n x n) storage. returns pointer to band_t on success, NULL on
+ *  error or if the system is not banded (see mtrx_is_band()).
+ */
+band_t *mtrx_read_band (FILE *fp)
+{
+    coo_t *c = mtrx_read_coo (fp);
+    band_t *b = NULL;
+    register size_t k;
+
+    if (!c)
+        return NULL;
+
+    if (c->cols <= c->rows)
+        fprintf (stderr, "%s() error: invalid system size (%zu x %zu).\n",
+                __func__, c->rows, c->cols);
+    else if ((2 * c->kl + c->ku + 1) * MTRX_BAND_DIV > c->rows)
+        fprintf (stderr, "%s() error: bandwidth (kl %zu, ku %zu) too wide "
+                "for band storage.\n", __func__, c->kl, c->ku);
+    else if ((b = band_create (c->rows, c->kl, c->ku, c->cols - c->rows))) {
+        for (k = 0; k < c->nnz; k++)
+            if (c->ci[k] >= c->rows)
+                BAND_RHS (b, c->ri[k])[c->ci[k] - c->rows] += c->v[k];
+            else if (c->v[k] != 0.0)    /* explicit zeros may lie outside */
+                BAND_ROW (b, c->ri[k])[c->ci[k]] += c->v[k];
+    }
+
+    coo_free (c);
+
+    return b;
+}
+
+/** mtrx_solv_band_file - headless solve of the (n x n+k) band system read
+ *  from in by mtrx_read_band(), the (n x k) solution written to out, one
+ *  row per line at full precision. returns 0 on success, -1 on read
+ *  failure or if the system is not banded, k + 1 if singular at k.
+ */
+int mtrx_solv_band_file (FILE *in, FILE *out)
+{
+    band_t *b;
+    register size_t i, c;
+    int info;
+
+    if (!(b = mtrx_read_band (in)))
+        return -1;
+
+    if ((info = band_solv (b)))
+        fprintf (stderr, "%s() error: singular matrix.\n", __func__);
+    else
+        for (i = 0; i < b->n; i++) {
+            for (c = 0; c < b->nrhs; c++)
+                fprintf (out, c ? " %.17g" : "%.17g", BAND_RHS (b, i)[c]);
+            fputc ('\n', out);
+        }
+
+    band_free (b);
+
+    return info;
+}
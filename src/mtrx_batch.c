@@ -0,0 +1,212 @@
+#include "mtrx_batch.h"
+#include "mtrx_simd.h"
+
+#ifdef __GNUC__
+# define BATCH_INLINE static inline __attribute__ ((always_inline))
+#else
+# define BATCH_INLINE static inline
+#endif
+
+#if (defined (__x86_64__) || defined (__i386__)) && defined (__GNUC__)
+# define HAVE_X86_SIMD 1
+#endif
+
+/** mtrx_batch_ld - element stride for k systems, k rounded up to a
+ *  multiple of BATCH_W so each element array starts a full block.
+ */
+size_t mtrx_batch_ld (const size_t k)
+{
+    return (k + BATCH_W - 1) / BATCH_W * BATCH_W;
+}
+
+/* eliminate w <= BATCH_W systems in lockstep, the lane loops (s) have no
+ * data dependent branches so they vectorize, full blocks are compiled
+ * with w constant. returns the number of singular systems.
+ */
+BATCH_INLINE int batch_blk (T *a, T *b, const size_t n, const size_t nrhs,
+                            const size_t ld, const size_t w, int *info)
+{
+    T pr[BATCH_W], big[BATCH_W], l[BATCH_W], zr[BATCH_W];
+    register size_t i, j, c, s;
+    int nsing = 0;
+
+    for (s = 0; s < w; s++)
+        zr[s] = 0.0;
+
+    for (j = 0; j < n; j++) {
+        T *x = a + (j * n + j) * ld, *y;
+
+        for (s = 0; s < w; s++) {       /* pivot row of each lane */
+            pr[s] = j;
+            big[s] = fabs (x[s]);
+        }
+        for (i = j + 1; i < n; i++) {
+            y = a + (i * n + j) * ld;
+            for (s = 0; s < w; s++) {
+                const T v = fabs (y[s]);
+                const int m = v > big[s];
+                pr[s] = m ? (T)i : pr[s];
+                big[s] = m ? v : big[s];
+            }
+        }
+
+        for (i = j + 1; i < n; i++) {   /* exchange rows j and pr[s] */
+            for (c = j; c < n; c++) {
+                x = a + (j * n + c) * ld;
+                y = a + (i * n + c) * ld;
+                for (s = 0; s < w; s++) {
+                    const T t = x[s], u = y[s];
+                    const int m = pr[s] == (T)i;
+                    x[s] = m ? u : t;
+                    y[s] = m ? t : u;
+                }
+            }
+            for (c = 0; c < nrhs; c++) {
+                x = b + (j * nrhs + c) * ld;
+                y = b + (i * nrhs + c) * ld;
+                for (s = 0; s < w; s++) {
+                    const T t = x[s], u = y[s];
+                    const int m = pr[s] == (T)i;
+                    x[s] = m ? u : t;
+                    y[s] = m ? t : u;
+                }
+            }
+        }
+
+        x = a + (j * n + j) * ld;       /* first zero pivot, reciprocal */
+        for (s = 0; s < w; s++) {
+            zr[s] = x[s] == 0.0 && zr[s] == 0.0 ? (T)(j + 1) : zr[s];
+            big[s] = 1.0 / x[s];
+        }
+
+        for (i = j + 1; i < n; i++) {   /* eliminate below pivot */
+            y = a + (i * n + j) * ld;
+            for (s = 0; s < w; s++)
+                l[s] = y[s] * big[s];
+            for (c = j + 1; c < n; c++) {
+                const T *xc = a + (j * n + c) * ld;
+                y = a + (i * n + c) * ld;
+                for (s = 0; s < w; s++)
+                    y[s] -= l[s] * xc[s];
+            }
+            for (c = 0; c < nrhs; c++) {
+                const T *xc = b + (j * nrhs + c) * ld;
+                y = b + (i * nrhs + c) * ld;
+                for (s = 0; s < w; s++)
+                    y[s] -= l[s] * xc[s];
+            }
+        }
+    }
+
+    i = n;
+    while (i--) {                       /* back substitution */
+        const T *d = a + (i * n + i) * ld;
+
+        for (c = 0; c < nrhs; c++) {
+            T *y = b + (i * nrhs + c) * ld;
+
+            for (j = i + 1; j < n; j++) {
+                const T *u = a + (i * n + j) * ld,
+                        *xj = b + (j * nrhs + c) * ld;
+                for (s = 0; s < w; s++)
+                    y[s] -= u[s] * xj[s];
+            }
+            for (s = 0; s < w; s++)
+                y[s] /= d[s];
+        }
+    }
+
+    for (s = 0; s < w; s++) {
+        if (zr[s] != 0.0)
+            nsing++;
+        if (info)
+            info[s] = (int)zr[s];
+    }
+
+    return nsing;
+}
+
+/* all k systems, full blocks then the remaining k % BATCH_W */
+BATCH_INLINE int batch_run (T *a, T *b, const size_t n, const size_t nrhs,
+                            const size_t k, const size_t ld, int *info)
+{
+    size_t s0;
+    int nsing = 0;
+
+    for (s0 = 0; s0 + BATCH_W <= k; s0 += BATCH_W)
+        nsing += batch_blk (a + s0, b + s0, n, nrhs, ld, BATCH_W,
+                            info ? info + s0 : NULL);
+    if (s0 < k)
+        nsing += batch_blk (a + s0, b + s0, n, nrhs, ld, k - s0,
+                            info ? info + s0 : NULL);
+
+    return nsing;
+}
+
+/* batch_run with n constant, the row and col loops are fully unrolled */
+BATCH_INLINE int batch_all (T *a, T *b, const size_t n, const size_t nrhs,
+                            const size_t k, const size_t ld, int *info)
+{
+    switch (n) {
+        case 1: return batch_run (a, b, 1, nrhs, k, ld, info);
+        case 2: return batch_run (a, b, 2, nrhs, k, ld, info);
+        case 3: return batch_run (a, b, 3, nrhs, k, ld, info);
+        case 4: return batch_run (a, b, 4, nrhs, k, ld, info);
+        case 5: return batch_run (a, b, 5, nrhs, k, ld, info);
+        case 6: return batch_run (a, b, 6, nrhs, k, ld, info);
+        case 7: return batch_run (a, b, 7, nrhs, k, ld, info);
+        default: return batch_run (a, b, 8, nrhs, k, ld, info);
+    }
+}
+
+static int batch_c (T *a, T *b, const size_t n, const size_t nrhs,
+                    const size_t k, const size_t ld, int *info)
+{
+    return batch_all (a, b, n, nrhs, k, ld, info);
+}
+
+#ifdef HAVE_X86_SIMD
+__attribute__ ((target ("avx2")))
+static int batch_avx2 (T *a, T *b, const size_t n, const size_t nrhs,
+                       const size_t k, const size_t ld, int *info)
+{
+    return batch_all (a, b, n, nrhs, k, ld, info);
+}
+
+__attribute__ ((target ("avx512f")))
+static int batch_avx512 (T *a, T *b, const size_t n, const size_t nrhs,
+                         const size_t k, const size_t ld, int *info)
+{
+    return batch_all (a, b, n, nrhs, k, ld, info);
+}
+#endif
+
+/** mtrx_batch_solv - solve k (n x n) systems a x = b, n <= BATCH_NMAX,
+ *  stored as structure of arrays (BATCH_A/BATCH_B, stride ld >= k).
+ *  BATCH_W systems are eliminated in lockstep, one per vector lane, by
+ *  LU with partial pivoting chosen per lane (rows exchanged by masked
+ *  selects, no branches on the data). no storage is allocated. a is
+ *  overwritten, b by the solutions. info (k, may be NULL) receives 0 or
+ *  j + 1 for a zero pivot at step j, the solution of a singular system
+ *  is not finite, other systems are unaffected. returns the number of
+ *  singular systems, -1 if n or ld is invalid.
+ */
+int mtrx_batch_solv (T *a, T *b, const size_t n, const size_t nrhs,
+                     const size_t k, const size_t ld, int *info)
+{
+    if (!n || n > BATCH_NMAX || ld < k) {
+        fprintf (stderr, "%s() error: invalid batch (n %zu, ld %zu < k %zu)"
+                ".\n", __func__, n, ld, k);
+        return -1;
+    }
+
+    if (!mtrx_kern.isa)                 /* kernels follow mtrx_kern isa */
+        mtrx_simd_init();
+#ifdef HAVE_X86_SIMD
+    if (strcmp (mtrx_kern.isa, "avx512") == 0)
+        return batch_avx512 (a, b, n, nrhs, k, ld, info);
+    if (strcmp (mtrx_kern.isa, "avx2") == 0)
+        return batch_avx2 (a, b, n, nrhs, k, ld, info);
+#endif
+    return batch_c (a, b, n, nrhs, k, ld, info);
+}
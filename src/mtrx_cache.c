@@ -0,0 +1,255 @@
+#include <stdint.h>
+
+#include "mtrx_cache.h"
+#include "mtrx_sym.h"
+#include "mtrx_band.h"
+#include "mtrx_cond.h"
+#include "mtrx_fixed.h"
+
+typedef struct cache_ent {  /* cached factorization */
+    struct cache_ent *next; /* next less recently used */
+    uint64_t hash;          /* hash of coefficient block */
+    size_t n, bytes;        /* system size, bytes held by entry */
+    T *coef;                /* (n x n) coefficients, verifies hash hit */
+    mtrx_t *lu;             /* LU factors (rows permuted) */
+    size_t *piv;            /* LU pivots */
+    mtrx_stat_t st;         /* statistics of the factors */
+} cache_ent;
+
+static cache_ent *cache;    /* most recently used first */
+static size_t cache_bytes, cache_max = MTRX_CACHE_MAX;
+static size_t cache_nhit, cache_nmiss;  /* solves reusing/adding factors */
+
+/** FNV-1a over the 64-bit words of the (n x n) coefficient block */
+static uint64_t cache_hash (T * const *a, const size_t n)
+{
+    uint64_t h = 14695981039346656037ULL, w;
+    register size_t i, j;
+
+    for (i = 0; i < n; i++)
+        for (j = 0; j < n; j++) {
+            memcpy (&w, &a[i][j], sizeof w);
+            h = (h ^ w) * 1099511628211ULL;
+        }
+
+    return h ^ n;
+}
+
+/* bytes held by an entry for an (n x n) system */
+static size_t cache_size (const size_t n)
+{
+    return sizeof (cache_ent) + sizeof (mtrx_t) +
+            n * (n * 2 + 8) * sizeof (T) +     /* coef + padded lu slab */
+            n * (sizeof (size_t) + sizeof (T *));
+}
+
+static void cache_free (cache_ent *e)
+{
+    if (e->lu)
+        mtrx_free (e->lu);
+    free (e->piv);
+    free (e->coef);
+    free (e);
+}
+
+/* release least recently used entries until cache_bytes <= max */
+static void cache_trim (const size_t max)
+{
+    cache_ent **pp;
+
+    while (cache && cache_bytes > max) {
+        for (pp = &cache; (*pp)->next; pp = &(*pp)->next) {}
+        cache_bytes -= (*pp)->bytes;
+        cache_free (*pp);
+        *pp = NULL;
+    }
+}
+
+/** mtrx_cache_limit - set byte limit for cached LU factors, least recently
+ *  used factors are released to stay within the limit, 0 disables the
+ *  cache (and releases all factors). returns the previous limit.
+ */
+size_t mtrx_cache_limit (const size_t nbytes)
+{
+    size_t prev = cache_max;
+
+    cache_max = nbytes;
+    cache_trim (cache_max);
+
+    return prev;
+}
+
+/** mtrx_cache_clear - release all cached factors */
+void mtrx_cache_clear (void)
+{
+    cache_trim (0);
+}
+
+/** mtrx_cache_count - number of cached solves that reused factors (hit)
+ *  and that factored the coefficients (miss), either may be NULL.
+ */
+void mtrx_cache_count (size_t *hit, size_t *miss)
+{
+    if (hit)
+        *hit = cache_nhit;
+    if (miss)
+        *miss = cache_nmiss;
+}
+
+/* find entry matching hash and coefficients, moved to front on a hit */
+static cache_ent *cache_find (T * const *a, const size_t n, const uint64_t h)
+{
+    cache_ent **pp, *e;
+    register size_t i;
+
+    for (pp = &cache; (e = *pp); pp = &e->next) {
+        if (e->hash != h || e->n != n)
+            continue;
+        for (i = 0; i < n; i++)     /* verify, hash is not proof */
+            if (memcmp (e->coef + i * n, a[i], n * sizeof *e->coef))
+                break;
+        if (i < n)
+            continue;
+
+        *pp = e->next;              /* move to front */
+        e->next = cache;
+        cache = e;
+
+        return e;
+    }
+
+    return NULL;
+}
+
+/* statistics of LU factors lu with pivots piv, cached with the factors */
+static int cache_stat (mtrx_stat_t *st, T * const *lu, const size_t *piv,
+                       const size_t n)
+{
+    size_t *rp = malloc ((n ? n : 1) * sizeof *rp);
+    int info;
+
+    if (!rp) {
+        fprintf (stderr, "%s() error: malloc-rp.\n", __func__);
+        return -1;
+    }
+    mtrx_piv_perm (piv, rp, n);
+    info = mtrx_stat_lu (st, lu, rp, NULL, n);
+    free (rp);
+
+    return info;
+}
+
+/** copy and factor coefficient block of a, adding entry at front of cache.
+ *  returns 0 on success, -1 on allocation failure, k + 1 if singular.
+ */
+static int cache_add (T * const *a, const size_t n, const uint64_t h)
+{
+    cache_ent *e = calloc (1, sizeof *e);
+    register size_t i;
+    int info;
+
+    if (!e || !(e->coef = malloc (n * n * sizeof *e->coef)) ||
+        !(e->piv = malloc (n * sizeof *e->piv)) ||
+        !(e->lu = mtrx_create_slab (n, n))) {
+        fprintf (stderr, "%s() error: memory exhausted.\n", __func__);
+        if (e)
+            cache_free (e);
+        return -1;
+    }
+    e->lu->rows = e->lu->cols = n;
+
+    for (i = 0; i < n; i++) {
+        memcpy (e->coef + i * n, a[i], n * sizeof *e->coef);
+        memcpy (e->lu->mtrx[i], a[i], n * sizeof *e->coef);
+    }
+
+    mtrx_stat_init (&e->st, a, n);
+    if ((info = mtrx_lu_fact (e->lu->mtrx, e->piv, n))) {
+        fprintf (stderr, "%s() error: singular matrix.\n", __func__);
+        cache_free (e);
+        return info;
+    }
+    if (cache_stat (&e->st, e->lu->mtrx, e->piv, n))
+        mtrx_stat_na (&e->st);
+
+    e->hash = h;
+    e->n = n;
+    e->bytes = cache_size (n);
+
+    cache_trim (cache_max - e->bytes);  /* make room, then add */
+    e->next = cache;
+    cache = e;
+    cache_bytes += e->bytes;
+
+    return 0;
+}
+
+/** mtrx_cache_solv - solve (n x n+k) system in m, reusing cached factors.
+ *  the (n x n) coefficient block is hashed and compared against the cached
+ *  factorizations, on a hit the k constant cols are solved together by
+ *  blocked forward and back substitution alone, O(n^2 k)
+ *  (mtrx_lu_solv_m()). on a miss the block is copied and factored by
+ *  blocked LU and the factors cached. the cache is used for SOLV_LU,
+ *  SOLV_GAUSS and SOLV_GAUSSJ (the inverse is not formed), other than for
+ *  one constant col and order FIX_NMIN -> FIX_NMAX (unrolled solvers). for
+ *  SOLV_MIXED, SOLV_RLU, band, tall (least-squares) or (with SOLV_GAUSS)
+ *  symmetric systems or with the cache disabled m is passed to
+ *  mtrx_solv_sys(). the coefficient block of m is unchanged on a cached
+ *  solve. on return the last k cols of m contain the (n x k) solution.
+ *  returns 0 on success, non-zero otherwise. (the cache is not thread safe)
+ */
+int mtrx_cache_solv (mtrx_t *m, const int method)
+{
+    return mtrx_cache_solv_st (m, method, NULL);
+}
+
+/** mtrx_cache_solv_st - mtrx_cache_solv() returning the statistics of the
+ *  factorization in st (if not NULL), see mtrx_stat_t. the statistics are
+ *  computed once on a miss and kept with the cached factors.
+ */
+int mtrx_cache_solv_st (mtrx_t *m, const int method, mtrx_stat_t *st)
+{
+    cache_ent *e;
+    uint64_t h;
+    size_t n, nrhs;
+    int info;
+
+    if (m && m->rows >= m->cols)        /* least squares, not cached */
+        return mtrx_solv_sys_st (m, method, st);
+
+    if (!m || m->cols <= m->rows) {
+        fprintf (stderr, "%s() error: invalid mtrx_t size (cols <= rows)\n",
+                __func__);
+        return -1;
+    }
+    n = m->rows;
+    nrhs = m->cols - m->rows;
+
+    /* not a double LU solve, unrolled order, factors would not fit, band
+     * or symmetric
+     */
+    if (method == SOLV_MIXED || method == SOLV_RLU ||
+        (method != SOLV_LU && nrhs == 1 && n >= FIX_NMIN && n <= FIX_NMAX) ||
+        cache_size (n) > cache_max ||
+        mtrx_is_band (m) || (method == SOLV_GAUSS && mtrx_is_sym (m)))
+        return mtrx_solv_sys_st (m, method, st);
+
+    h = cache_hash (m->mtrx, n);
+    if (!(e = cache_find (m->mtrx, n, h))) {
+        if ((info = cache_add (m->mtrx, n, h)) == -1)
+            return mtrx_solv_sys_st (m, method, st);    /* uncached */
+        else if (info)
+            return info;
+        e = cache;
+        cache_nmiss++;
+    }
+    else
+        cache_nhit++;
+    if (st)
+        *st = e->st;
+
+    /* O(n^2 nrhs), all constant columns in one blocked solve */
+    mtrx_lu_solv_m (e->lu->mtrx, e->piv, m->mtrx, n, n, nrhs);
+
+    return 0;
+}
@@ -0,0 +1,308 @@
+#include "mtrx_cond.h"
+
+typedef struct {        /* permuted LU factors for lu_op() */
+    T * const *lu;
+    const size_t *rp, *cp;
+    size_t n;
+    T *w;               /* workspace (n) */
+} lu_op_t;
+
+/** mtrx_norm1 - 1-norm (max col sum) of the (n x n) block of a */
+T mtrx_norm1 (T * const *a, const size_t n)
+{
+    T *sum = calloc (n ? n : 1, sizeof *sum), nrm = 0.0;
+    register size_t i, j;
+
+    if (!sum) {
+        fprintf (stderr, "%s() error: calloc-sum.\n", __func__);
+        return NAN;
+    }
+
+    for (i = 0; i < n; i++)     /* row-wise, columns accumulated */
+        for (j = 0; j < n; j++)
+            sum[j] += fabs (a[i][j]);
+    for (j = 0; j < n; j++)
+        if (sum[j] > nrm)
+            nrm = sum[j];
+
+    free (sum);
+
+    return nrm;
+}
+
+/* index of largest fabs (x[i]) */
+static size_t cond_imax (const T *x, const size_t n)
+{
+    register size_t i, j = 0;
+
+    for (i = 1; i < n; i++)
+        if (fabs (x[i]) > fabs (x[j]))
+            j = i;
+
+    return j;
+}
+
+/* ||x||_1 */
+static T cond_asum (const T *x, const size_t n)
+{
+    register size_t i;
+    T sum = 0.0;
+
+    for (i = 0; i < n; i++)
+        sum += fabs (x[i]);
+
+    return sum;
+}
+
+/** mtrx_cond1_est - Hager/Higham (LAPACK dlacon) estimate of the 1-norm
+ *  condition number anrm * ||A^-1||_1 from at most 2 * COND_ITMAX + 1
+ *  solves with the factors of A (O(n^2) each). the estimate is a lower
+ *  bound, almost always within a factor of 3. returns NAN on allocation
+ *  failure.
+ */
+T mtrx_cond1_est (mtrx_solv_fn solv, const void *f, const size_t n,
+                  const T anrm)
+{
+    T *x = malloc ((n ? n : 1) * sizeof *x),
+      *xi = malloc ((n ? n : 1) * sizeof *xi), est, estold;
+    register size_t i;
+    size_t j, jlast;
+    int it;
+
+    if (!x || !xi) {
+        fprintf (stderr, "%s() error: memory exhausted.\n", __func__);
+        est = NAN;
+        goto conddone;
+    }
+    if (!n) {
+        est = 0.0;
+        goto conddone;
+    }
+
+    for (i = 0; i < n; i++)             /* x = A^-1 e / n */
+        x[i] = 1.0 / n;
+    solv (f, x, 0);
+    est = cond_asum (x, n);
+    if (n == 1)
+        goto conddone;
+
+    for (i = 0; i < n; i++)             /* z = A^-T sign (x) */
+        xi[i] = x[i] >= 0.0 ? 1.0 : -1.0;
+    memcpy (x, xi, n * sizeof *x);
+    solv (f, x, 1);
+    j = cond_imax (x, n);
+
+    for (it = 2; it <= COND_ITMAX; it++) {
+        int same = 1;
+
+        for (i = 0; i < n; i++)         /* x = A^-1 e_j */
+            x[i] = i == j;
+        solv (f, x, 0);
+        estold = est;
+        est = cond_asum (x, n);
+
+        for (i = 0; i < n; i++)         /* sign vector repeated, converged */
+            if ((x[i] >= 0.0 ? 1.0 : -1.0) != xi[i]) {
+                same = 0;
+                break;
+            }
+        if (same || est <= estold) {
+            if (est < estold)
+                est = estold;
+            break;
+        }
+
+        for (i = 0; i < n; i++)
+            xi[i] = x[i] >= 0.0 ? 1.0 : -1.0;
+        memcpy (x, xi, n * sizeof *x);
+        solv (f, x, 1);
+        jlast = j;
+        j = cond_imax (x, n);
+        if (fabs (x[jlast]) == fabs (x[j]))
+            break;
+    }
+
+    for (i = 0; i < n; i++)             /* alternating test vector */
+        x[i] = (i & 1 ? -1.0 : 1.0) * (1.0 + (T)i / (n - 1));
+    solv (f, x, 0);
+    estold = 2.0 * cond_asum (x, n) / (3.0 * n);
+    if (estold > est)
+        est = estold;
+    conddone:;
+
+    free (xi);
+    free (x);
+
+    return isnan (est) ? est : anrm * est;
+}
+
+/** mtrx_stat_init - set anrm and amax of the (n x n) block of a, log|det|
+ *  0, sign 1, growth 0 and cond NAN, before the pivots are recorded.
+ */
+void mtrx_stat_init (mtrx_stat_t *st, T * const *a, const size_t n)
+{
+    register size_t i, j;
+
+    st->anrm = mtrx_norm1 (a, n);
+    st->amax = 0.0;
+    for (i = 0; i < n; i++)
+        for (j = 0; j < n; j++)
+            if (fabs (a[i][j]) > st->amax)
+                st->amax = fabs (a[i][j]);
+
+    st->cond = NAN;
+    st->logdet = 0.0;
+    st->sign = 1;
+    st->growth = 0.0;
+}
+
+/** mtrx_stat_na - mark log|det|, sign and growth as not available */
+void mtrx_stat_na (mtrx_stat_t *st)
+{
+    st->cond = NAN;
+    st->logdet = NAN;
+    st->sign = 0;
+    st->growth = NAN;
+}
+
+/** mtrx_stat_piv - record pivot piv following swaps row/col exchanges in
+ *  log|det|, sign and growth (max |piv| / amax).
+ */
+void mtrx_stat_piv (mtrx_stat_t *st, const T piv, const int swaps)
+{
+    st->logdet += log (fabs (piv));
+    if ((piv < 0.0) != (swaps & 1))
+        st->sign = -st->sign;
+    if (st->amax > 0.0 && fabs (piv) / st->amax > st->growth)
+        st->growth = fabs (piv) / st->amax;
+}
+
+/** mtrx_stat_inv - exact condition number anrm * ||inv||_1 from the
+ *  (n x n) inverse (Gauss-Jordan).
+ */
+void mtrx_stat_inv (mtrx_stat_t *st, T * const *inv, const size_t n)
+{
+    st->cond = st->anrm * mtrx_norm1 (inv, n);
+}
+
+/* x = A^-1 x or A^-T x from P A Q = L U, see mtrx_stat_lu() */
+static void lu_op (const void *f, T *x, const int trans)
+{
+    const lu_op_t *op = f;
+    T * const *lu = op->lu, *w = op->w;
+    const size_t n = op->n, *pin = trans ? op->cp : op->rp,
+                 *pout = trans ? op->rp : op->cp;
+    register size_t i, j;
+
+    for (i = 0; i < n; i++)
+        w[i] = x[pin ? pin[i] : i];
+
+    if (!trans) {                       /* L U w = P b */
+        for (i = 1; i < n; i++)
+            for (j = 0; j < i; j++)
+                w[i] -= lu[i][j] * w[j];
+        i = n;
+        while (i--) {
+            for (j = i + 1; j < n; j++)
+                w[i] -= lu[i][j] * w[j];
+            w[i] /= lu[i][i];
+        }
+    }
+    else {                              /* U^T L^T w = Q^T b, row-wise */
+        for (i = 0; i < n; i++) {
+            w[i] /= lu[i][i];
+            for (j = i + 1; j < n; j++)
+                w[j] -= lu[i][j] * w[i];
+        }
+        i = n;
+        while (i--)
+            for (j = 0; j < i; j++)
+                w[j] -= lu[i][j] * w[i];
+    }
+
+    for (i = 0; i < n; i++)
+        x[pout ? pout[i] : i] = w[i];
+}
+
+/* parity of permutation p (1 odd), mark (n) workspace */
+static int perm_odd (const size_t *p, char *mark, const size_t n)
+{
+    register size_t i, j;
+    int odd = 0;
+
+    if (!p)
+        return 0;
+
+    memset (mark, 0, n);
+    for (i = 0; i < n; i++)             /* cycle of length l, l - 1 swaps */
+        if (!mark[i])
+            for (mark[i] = 1, j = p[i]; j != i; j = p[j]) {
+                mark[j] = 1;
+                odd ^= 1;
+            }
+
+    return odd;
+}
+
+/** mtrx_stat_lu - statistics from (n x n) factors P A Q = L U (unit L
+ *  below the diagonal of lu, U on and above). row k of PAQ is row rp[k]
+ *  of A and col k is col cp[k], (NULL - identity). sets log|det|, sign,
+ *  growth (max |U| / amax) and the estimated condition number. anrm and
+ *  amax must be set by mtrx_stat_init() before factoring. returns 0 on
+ *  success, -1 on allocation failure.
+ */
+int mtrx_stat_lu (mtrx_stat_t *st, T * const *lu, const size_t *rp,
+                  const size_t *cp, const size_t n)
+{
+    lu_op_t op = { lu, rp, cp, n, NULL };
+    char *mark = malloc (n ? n : 1);
+    register size_t i, j;
+    T umax = 0.0;
+
+    if (!mark || !(op.w = malloc ((n ? n : 1) * sizeof *op.w))) {
+        fprintf (stderr, "%s() error: memory exhausted.\n", __func__);
+        free (mark);
+        mtrx_stat_na (st);
+        return -1;
+    }
+
+    st->logdet = 0.0;
+    st->sign = perm_odd (rp, mark, n) ^ perm_odd (cp, mark, n) ? -1 : 1;
+    for (i = 0; i < n; i++) {
+        st->logdet += log (fabs (lu[i][i]));
+        if (lu[i][i] < 0.0)
+            st->sign = -st->sign;
+        for (j = i; j < n; j++)
+            if (fabs (lu[i][j]) > umax)
+                umax = fabs (lu[i][j]);
+    }
+    st->growth = st->amax > 0.0 ? umax / st->amax : 0.0;
+    st->cond = mtrx_cond1_est (lu_op, &op, n, st->anrm);
+
+    free (op.w);
+    free (mark);
+
+    return 0;
+}
+
+/** mtrx_piv_perm - convert the sequential row interchanges piv of
+ *  mtrx_lu_fact() to the row permutation rp (row k of PA is row rp[k]).
+ *  returns the number of interchanges.
+ */
+size_t mtrx_piv_perm (const size_t *piv, size_t *rp, const size_t n)
+{
+    register size_t i;
+    size_t nswap = 0;
+
+    for (i = 0; i < n; i++)
+        rp[i] = i;
+    for (i = 0; i < n; i++)
+        if (piv[i] != i) {
+            size_t t = rp[i];
+            rp[i] = rp[piv[i]];
+            rp[piv[i]] = t;
+            nswap++;
+        }
+
+    return nswap;
+}
@@ -0,0 +1,284 @@
+#include "mtrx_csr.h"
+
+/** csr_create - allocate (rows x cols) csr_t for nnz elements and nrhs
+ *  zeroed constant columns, rp zeroed. returns pointer to csr_t on
+ *  success, NULL otherwise.
+ */
+csr_t *csr_create (const size_t rows, const size_t cols, const size_t nnz,
+                   const size_t nrhs)
+{
+    csr_t *a = calloc (1, sizeof *a);
+
+    if (!a || !(a->rp = calloc (rows + 1, sizeof *a->rp)) ||
+        !(a->ci = malloc ((nnz ? nnz : 1) * sizeof *a->ci)) ||
+        !(a->v = malloc ((nnz ? nnz : 1) * sizeof *a->v)) ||
+        (nrhs && !(a->b = calloc (rows * nrhs, sizeof *a->b)))) {
+        fprintf (stderr, "%s() error: memory exhausted.\n", __func__);
+        if (a)
+            csr_free (a);
+        return NULL;
+    }
+
+    a->rows = rows;
+    a->cols = cols;
+    a->nnz = nnz;
+    a->nrhs = nrhs;
+
+    return a;
+}
+
+/** free csr_t and storage */
+void csr_free (csr_t *a)
+{
+    free (a->b);
+    free (a->v);
+    free (a->ci);
+    free (a->rp);
+    free (a);
+}
+
+/** csr_from_coo - build csr_t from coordinate matrix c. for a (n x n+k)
+ *  system the (n x n) coefficients are stored compressed by row and cols
+ *  n+1 .. n+k as the dense constants b. rows are sorted by column by two
+ *  counting passes and duplicate entries summed, O(nnz + n). returns
+ *  pointer to csr_t on success, NULL otherwise.
+ */
+csr_t *csr_from_coo (const coo_t *c)
+{
+    const size_t n = c->rows, ncol = c->cols > n ? n : c->cols;
+    size_t *cp = calloc (ncol + 1, sizeof *cp),     /* column counts */
+           *ord = malloc ((c->nnz ? c->nnz : 1) * sizeof *ord),
+           nnz = 0;
+    csr_t *a = NULL;
+    register size_t k, p;
+
+    if (!cp || !ord) {
+        fprintf (stderr, "%s() error: memory exhausted.\n", __func__);
+        goto csrdone;
+    }
+
+    for (k = 0; k < c->nnz; k++)    /* order coefficients by column */
+        if (c->ci[k] < ncol) {
+            cp[c->ci[k] + 1]++;
+            nnz++;
+        }
+    for (k = 0; k < ncol; k++)
+        cp[k + 1] += cp[k];
+    for (k = 0; k < c->nnz; k++)
+        if (c->ci[k] < ncol)
+            ord[cp[c->ci[k]]++] = k;
+
+    if (!(a = csr_create (n, ncol, nnz, c->cols > n ? c->cols - n : 0)))
+        goto csrdone;
+
+    for (k = 0; k < c->nnz; k++)    /* then stable by row, constants to b */
+        if (c->ci[k] < ncol)
+            a->rp[c->ri[k] + 1]++;
+        else
+            a->b[(c->ci[k] - n) * n + c->ri[k]] += c->v[k];
+    for (k = 0; k < n; k++)
+        a->rp[k + 1] += a->rp[k];
+    for (k = 0; k < nnz; k++) {     /* rp[i] advanced to start of row i+1 */
+        p = a->rp[c->ri[ord[k]]]++;
+        a->ci[p] = c->ci[ord[k]];
+        a->v[p] = c->v[ord[k]];
+    }
+
+    for (nnz = 0, k = p = 0; k < n; k++) {  /* sum duplicates, reset rp */
+        size_t end = a->rp[k], q;
+
+        a->rp[k] = nnz;
+        for (q = p; q < end; q++)
+            if (nnz > a->rp[k] && a->ci[nnz - 1] == a->ci[q])
+                a->v[nnz - 1] += a->v[q];
+            else {
+                a->ci[nnz] = a->ci[q];
+                a->v[nnz++] = a->v[q];
+            }
+        p = end;
+    }
+    a->rp[n] = a->nnz = nnz;
+    csrdone:;
+
+    free (ord);
+    free (cp);
+
+    return a;
+}
+
+/** csr_from_mtrx - build csr_t from the non-zero coefficients (and the
+ *  diagonal) of (n x n+k) system m, the last k cols as the constants.
+ *  returns pointer to csr_t on success, NULL otherwise.
+ */
+csr_t *csr_from_mtrx (const mtrx_t *m)
+{
+    const size_t n = m->rows, nrhs = m->cols > n ? m->cols - n : 0;
+    csr_t *a;
+    size_t nnz = 0;
+    register size_t i, j;
+
+    for (i = 0; i < n; i++)
+        for (j = 0; j < n; j++)
+            if (m->mtrx[i][j] != 0.0 || i == j)
+                nnz++;
+
+    if (!(a = csr_create (n, n, nnz, nrhs)))
+        return NULL;
+
+    for (nnz = 0, i = 0; i < n; i++) {
+        for (j = 0; j < n; j++)
+            if (m->mtrx[i][j] != 0.0 || i == j) {
+                a->ci[nnz] = j;
+                a->v[nnz++] = m->mtrx[i][j];
+            }
+        a->rp[i + 1] = nnz;
+        for (j = 0; j < nrhs; j++)
+            a->b[j * n + i] = m->mtrx[i][n + j];
+    }
+
+    return a;
+}
+
+/** mtrx_read_csr - read (n x n+k) system in Matrix Market coordinate
+ *  format (see mtrx_read_coo()) into csr_t, storage O(nnz). returns
+ *  pointer to csr_t on success, NULL otherwise.
+ */
+csr_t *mtrx_read_csr (FILE *fp)
+{
+    coo_t *c = mtrx_read_coo (fp);
+    csr_t *a;
+
+    if (!c)
+        return NULL;
+
+    a = csr_from_coo (c);
+    coo_free (c);
+
+    return a;
+}
+
+/** csr_mv_rows - y[i] = A(i,:) x for rows [lo, hi) */
+void csr_mv_rows (const csr_t *a, const T *x, T *y,
+                  const size_t lo, const size_t hi)
+{
+    register size_t i, p;
+
+    for (i = lo; i < hi; i++) {
+        T sum = 0.0;
+        for (p = a->rp[i]; p < a->rp[i + 1]; p++)
+            sum += a->v[p] * x[a->ci[p]];
+        y[i] = sum;
+    }
+}
+
+/** csr_mv - y = A x */
+void csr_mv (const csr_t *a, const T *x, T *y)
+{
+    csr_mv_rows (a, x, y, 0, a->rows);
+}
+
+/* position of a(i,i) in row i, rp[i+1] if not stored */
+static size_t csr_diag (const csr_t *a, const size_t i)
+{
+    register size_t p;
+
+    for (p = a->rp[i]; p < a->rp[i + 1] && a->ci[p] < i; p++) {}
+
+    return p < a->rp[i + 1] && a->ci[p] == i ? p : a->rp[i + 1];
+}
+
+/** csr_jacobi - dinv[i] = 1 / a(i,i). returns 0 on success, i + 1 if
+ *  a(i,i) is zero or missing.
+ */
+int csr_jacobi (const csr_t *a, T *dinv)
+{
+    register size_t i, p;
+
+    for (i = 0; i < a->rows; i++) {
+        if ((p = csr_diag (a, i)) == a->rp[i + 1] || a->v[p] == 0.0) {
+            fprintf (stderr, "%s() error: zero diagonal row %zu.\n",
+                    __func__, i);
+            return i + 1;
+        }
+        dinv[i] = 1.0 / a->v[p];
+    }
+
+    return 0;
+}
+
+/** csr_ilu0 - incomplete LU factorization with zero fill, L (unit) and U
+ *  stored in lu on the pattern of a, dp[i] the position of the diagonal
+ *  of row i. returns 0 on success, i + 1 if the diagonal of row i is
+ *  missing or zero, -1 on allocation failure.
+ */
+int csr_ilu0 (const csr_t *a, T *lu, size_t *dp)
+{
+    const size_t n = a->rows, none = (size_t)-1;
+    size_t *iw = malloc ((n ? n : 1) * sizeof *iw);   /* col -> position */
+    register size_t i, p, q;
+    int info = 0;
+
+    if (!iw) {
+        fprintf (stderr, "%s() error: malloc-iw.\n", __func__);
+        return -1;
+    }
+    for (i = 0; i < n; i++)
+        iw[i] = none;
+    memcpy (lu, a->v, a->nnz * sizeof *lu);
+
+    for (i = 0; i < n; i++) {
+        if ((dp[i] = csr_diag (a, i)) == a->rp[i + 1]) {
+            fprintf (stderr, "%s() error: missing diagonal row %zu.\n",
+                    __func__, i);
+            info = i + 1;
+            break;
+        }
+        for (p = a->rp[i]; p < a->rp[i + 1]; p++)
+            iw[a->ci[p]] = p;
+
+        for (p = a->rp[i]; p < dp[i]; p++) {    /* l(i,k), k < i */
+            const size_t k = a->ci[p];
+            T l = lu[p] /= lu[dp[k]];
+
+            for (q = dp[k] + 1; q < a->rp[k + 1]; q++)
+                if (iw[a->ci[q]] != none)       /* update existing only */
+                    lu[iw[a->ci[q]]] -= l * lu[q];
+        }
+
+        for (p = a->rp[i]; p < a->rp[i + 1]; p++)
+            iw[a->ci[p]] = none;
+
+        if (lu[dp[i]] == 0.0) {
+            fprintf (stderr, "%s() error: zero pivot row %zu.\n",
+                    __func__, i);
+            info = i + 1;
+            break;
+        }
+    }
+
+    free (iw);
+
+    return info;
+}
+
+/** csr_ilu0_solv - z = (L U)^-1 r from csr_ilu0 factors */
+void csr_ilu0_solv (const csr_t *a, const T *lu, const size_t *dp,
+                    const T *r, T *z)
+{
+    register size_t i, p;
+
+    for (i = 0; i < a->rows; i++) {     /* L y = r, unit diagonal */
+        T sum = r[i];
+        for (p = a->rp[i]; p < dp[i]; p++)
+            sum -= lu[p] * z[a->ci[p]];
+        z[i] = sum;
+    }
+
+    i = a->rows;
+    while (i--) {                       /* U z = y */
+        T sum = z[i];
+        for (p = dp[i] + 1; p < a->rp[i + 1]; p++)
+            sum -= lu[p] * z[a->ci[p]];
+        z[i] = sum / lu[dp[i]];
+    }
+}
@@ -0,0 +1,177 @@
+#include "mtrx_expr.h"
+#include "mtrx_thrd.h"
+#include "mtrx_simd.h"
+
+typedef struct {        /* rows r0 -> r1 of dst = beta dst + sum of terms */
+    T * const *y;
+    const T *alpha;
+    T * const * const *x;   /* rows of each term */
+    size_t nt, r0, r1, n;
+    T beta;
+} expr_arg_t;
+
+/* EXPR_NC cols of row i at a time, scaled then each term added in turn,
+ * four terms per pass over the chunk.
+ */
+static void *expr_run (void *arg)
+{
+    const expr_arg_t *t = arg;
+    const T *xk[4];
+    register size_t i, j, k;
+    size_t j0, nc;
+
+    for (i = t->r0; i < t->r1; i++)
+        for (j0 = 0; j0 < t->n; j0 += EXPR_NC) {
+            T *y = t->y[i] + j0;
+            nc = t->n - j0 < EXPR_NC ? t->n - j0 : EXPR_NC;
+
+            if (t->beta == 0.0)
+                for (j = 0; j < nc; j++)
+                    y[j] = 0.0;
+            else if (t->beta != 1.0)
+                mtrx_kern.scal (nc, t->beta, y);
+
+            for (k = 0; k + 4 <= t->nt; k += 4) {
+                for (j = 0; j < 4; j++)
+                    xk[j] = t->x[k + j][i] + j0;
+                mtrx_kern.axpy4 (nc, t->alpha + k, xk, y);
+            }
+            for (; k < t->nt; k++)
+                mtrx_kern.axpy (nc, t->alpha[k], t->x[k][i] + j0, y);
+        }
+
+    return NULL;
+}
+
+/** mtrx_expr_init - empty expression e */
+void mtrx_expr_init (mtrx_expr_t *e)
+{
+    e->n = 0;
+}
+
+/** mtrx_expr_add - append the term alpha m to e, nothing is computed.
+ *  returns 0 on success, -1 if e holds EXPR_MAX terms.
+ */
+int mtrx_expr_add (mtrx_expr_t *e, const T alpha, const mtrx_t *m)
+{
+    if (e->n == EXPR_MAX) {
+        fprintf (stderr, "%s() error: expression full (%d terms).\n",
+                __func__, EXPR_MAX);
+        return -1;
+    }
+
+    e->alpha[e->n] = alpha;
+    e->m[e->n++] = m;
+
+    return 0;
+}
+
+/** mtrx_expr_eval - dst = beta dst + alpha[0] m[0] + ... in a single pass.
+ *  a term that is dst itself is folded into beta, the remaining terms are
+ *  added to each EXPR_NC col chunk of dst while it is in cache. returns
+ *  0 on success, -1 on unequal dimensions or packed storage.
+ */
+int mtrx_expr_eval (const mtrx_expr_t *e, const T beta, mtrx_t *dst)
+{
+    expr_arg_t t[MTRX_THRD_MAX];
+    pthread_t tid[MTRX_THRD_MAX];
+    T alpha[EXPR_MAX], b = beta;
+    T * const *x[EXPR_MAX];
+    size_t k, nx = 0;
+    int nt = mtrx_nthrd_get(), i, nrun;
+
+    if (MTRX_PACKED (dst)) {
+        fprintf (stderr, "%s() error: packed storage.\n", __func__);
+        return -1;
+    }
+    for (k = 0; k < e->n; k++) {
+        const mtrx_t *m = e->m[k];
+
+        if (m->rows != dst->rows || m->cols != dst->cols || MTRX_PACKED (m)) {
+            fprintf (stderr, "%s() error: term %zu (%zu x %zu) does not "
+                    "match (%zu x %zu)\n", __func__, k, m->rows, m->cols,
+                    dst->rows, dst->cols);
+            return -1;
+        }
+        if (m == dst)           /* dst read in place, fold into beta */
+            b += e->alpha[k];
+        else {
+            alpha[nx] = e->alpha[k];
+            x[nx++] = m->mtrx;
+        }
+    }
+
+    if (dst->rows * dst->cols * (nx + 1) < EXPR_MIN)
+        nt = 1;
+    else if ((size_t)nt > dst->rows)
+        nt = dst->rows ? (int)dst->rows : 1;
+
+    for (i = 0; i < nt; i++) {
+        t[i].y = dst->mtrx;
+        t[i].alpha = alpha;
+        t[i].x = x;
+        t[i].nt = nx;
+        t[i].r0 = dst->rows * i / nt;
+        t[i].r1 = dst->rows * (i + 1) / nt;
+        t[i].n = dst->cols;
+        t[i].beta = b;
+    }
+
+    for (nrun = 1; nrun < nt; nrun++)
+        if (pthread_create (&tid[nrun], NULL, expr_run, &t[nrun]))
+            break;
+    expr_run (&t[0]);
+    for (i = nrun; i < nt; i++)         /* rows of threads not created */
+        expr_run (&t[i]);
+    for (i = 1; i < nrun; i++)
+        pthread_join (tid[i], NULL);
+
+    return 0;
+}
+
+/** mtrx_expr_new - evaluate e into a new (slab) matrix, the only
+ *  allocation. returns pointer to mtrx_t on success, NULL otherwise.
+ */
+mtrx_t *mtrx_expr_new (const mtrx_expr_t *e)
+{
+    mtrx_t *m;
+
+    if (!e->n) {
+        fprintf (stderr, "%s() error: empty expression.\n", __func__);
+        return NULL;
+    }
+    if (!(m = mtrx_create_slab (e->m[0]->rows, e->m[0]->cols)))
+        return NULL;
+    m->rows = e->m[0]->rows;
+    m->cols = e->m[0]->cols;
+
+    if (mtrx_expr_eval (e, 0.0, m)) {
+        mtrx_free (m);
+        return NULL;
+    }
+
+    return m;
+}
+
+/** mtrx_axpby - my = alpha mx + beta my in place (accumulate with alpha 1,
+ *  beta 1, subtract with alpha -1). returns as mtrx_expr_eval().
+ */
+int mtrx_axpby (const T alpha, const mtrx_t *mx, const T beta, mtrx_t *my)
+{
+    mtrx_expr_t e;
+
+    mtrx_expr_init (&e);
+    mtrx_expr_add (&e, alpha, mx);
+
+    return mtrx_expr_eval (&e, beta, my);
+}
+
+/** mtrx_scal - m = alpha m in place, returns as mtrx_expr_eval() */
+int mtrx_scal (const T alpha, mtrx_t *m)
+{
+    mtrx_expr_t e;
+
+    mtrx_expr_init (&e);
+
+    return mtrx_expr_eval (&e, alpha, m);
+}
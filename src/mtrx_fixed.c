@@ -0,0 +1,183 @@
+#include "mtrx_fixed.h"
+
+#ifdef __GNUC__
+# define FIX_INLINE static inline __attribute__ ((always_inline))
+# define FIX_UNROLL _Pragma ("GCC unroll 16")
+#else
+# define FIX_INLINE static inline
+# define FIX_UNROLL
+#endif
+
+/* LU with partial pivoting of the (n x ncol) row-major [A | B] in w, then
+ * back substitution of the ncol - n cols of B. row exchanges are selects
+ * over the rows below the pivot. *det receives the determinant of A.
+ * returns 0, or j + 1 for the first zero pivot.
+ */
+FIX_INLINE int fix_elim (T *w, const size_t n, const size_t ncol, T *det)
+{
+    register size_t i, j, c;
+    T d = 1.0;
+    int info = 0;
+
+    FIX_UNROLL
+    for (j = 0; j < n; j++) {
+        size_t p = j;
+        T big = fabs (w[j * ncol + j]), pivinv;
+
+        FIX_UNROLL
+        for (i = j + 1; i < n; i++) {   /* pivot row */
+            const T v = fabs (w[i * ncol + j]);
+            p = v > big ? i : p;
+            big = v > big ? v : big;
+        }
+        FIX_UNROLL
+        for (i = j + 1; i < n; i++) {   /* exchange rows j and p */
+            FIX_UNROLL
+            for (c = j; c < ncol; c++) {
+                const T t = w[j * ncol + c], u = w[i * ncol + c];
+                w[j * ncol + c] = p == i ? u : t;
+                w[i * ncol + c] = p == i ? t : u;
+            }
+        }
+
+        d = p != j ? -d : d;
+        d *= w[j * ncol + j];
+        info = !info && w[j * ncol + j] == 0.0 ? (int)j + 1 : info;
+        pivinv = 1.0 / w[j * ncol + j];
+
+        FIX_UNROLL
+        for (i = j + 1; i < n; i++) {   /* eliminate below pivot */
+            const T l = w[i * ncol + j] * pivinv;
+            FIX_UNROLL
+            for (c = j + 1; c < ncol; c++)
+                w[i * ncol + c] -= l * w[j * ncol + c];
+        }
+    }
+
+    FIX_UNROLL
+    for (c = n; c < ncol; c++) {        /* back substitution */
+        i = n;
+        FIX_UNROLL
+        while (i--) {
+            T sum = w[i * ncol + c];
+            FIX_UNROLL
+            for (j = i + 1; j < n; j++)
+                sum -= w[i * ncol + j] * w[j * ncol + c];
+            w[i * ncol + c] = sum / w[i * ncol + i];
+        }
+    }
+    *det = d;
+
+    return info;
+}
+
+/* solver, inverse and determinant for order N */
+#define FIX_DEF(N)                                                      \
+int mtrx_solv_##N (const T *a, const T *b, T *x)                        \
+{                                                                       \
+    T w[N * (N + 1)], det;                                              \
+    register size_t i, j;                                               \
+    int info;                                                           \
+                                                                        \
+    for (i = 0; i < N; i++) {                                           \
+        for (j = 0; j < N; j++)                                         \
+            w[i * (N + 1) + j] = a[i * N + j];                          \
+        w[i * (N + 1) + N] = b[i];                                      \
+    }                                                                   \
+    info = fix_elim (w, N, N + 1, &det);                                \
+    for (i = 0; i < N; i++)                                             \
+        x[i] = w[i * (N + 1) + N];                                      \
+                                                                        \
+    return info;                                                        \
+}                                                                       \
+                                                                        \
+int mtrx_inv_##N (const T *a, T *inv)                                   \
+{                                                                       \
+    T w[N * 2 * N], det;                                                \
+    register size_t i, j;                                               \
+    int info;                                                           \
+                                                                        \
+    for (i = 0; i < N; i++)                                             \
+        for (j = 0; j < N; j++) {                                       \
+            w[i * 2 * N + j] = a[i * N + j];                            \
+            w[i * 2 * N + N + j] = i == j;                              \
+        }                                                               \
+    info = fix_elim (w, N, 2 * N, &det);                                \
+    for (i = 0; i < N; i++)                                             \
+        for (j = 0; j < N; j++)                                         \
+            inv[i * N + j] = w[i * 2 * N + N + j];                      \
+                                                                        \
+    return info;                                                        \
+}                                                                       \
+                                                                        \
+T mtrx_det_##N (const T *a)                                             \
+{                                                                       \
+    T w[N * N], det;                                                    \
+                                                                        \
+    memcpy (w, a, sizeof w);                                            \
+    fix_elim (w, N, N, &det);                                           \
+                                                                        \
+    return det;                                                         \
+}
+
+FIX_DEF(2)
+FIX_DEF(3)
+FIX_DEF(4)
+FIX_DEF(5)
+FIX_DEF(6)
+FIX_DEF(7)
+FIX_DEF(8)
+
+/** mtrx_fix_solv - solve a x = b with the unrolled solver for n,
+ *  returns as mtrx_solv_N(), -1 if n is not FIX_NMIN -> FIX_NMAX.
+ */
+int mtrx_fix_solv (const T *a, const T *b, T *x, const size_t n)
+{
+    switch (n) {
+        case 2: return mtrx_solv_2 (a, b, x);
+        case 3: return mtrx_solv_3 (a, b, x);
+        case 4: return mtrx_solv_4 (a, b, x);
+        case 5: return mtrx_solv_5 (a, b, x);
+        case 6: return mtrx_solv_6 (a, b, x);
+        case 7: return mtrx_solv_7 (a, b, x);
+        case 8: return mtrx_solv_8 (a, b, x);
+    }
+
+    return -1;
+}
+
+/** mtrx_fix_inv - inverse of a with the unrolled solver for n,
+ *  returns as mtrx_inv_N(), -1 if n is not FIX_NMIN -> FIX_NMAX.
+ */
+int mtrx_fix_inv (const T *a, T *inv, const size_t n)
+{
+    switch (n) {
+        case 2: return mtrx_inv_2 (a, inv);
+        case 3: return mtrx_inv_3 (a, inv);
+        case 4: return mtrx_inv_4 (a, inv);
+        case 5: return mtrx_inv_5 (a, inv);
+        case 6: return mtrx_inv_6 (a, inv);
+        case 7: return mtrx_inv_7 (a, inv);
+        case 8: return mtrx_inv_8 (a, inv);
+    }
+
+    return -1;
+}
+
+/** mtrx_fix_det - determinant of a by the unrolled LU for n, (NAN if n
+ *  is not FIX_NMIN -> FIX_NMAX).
+ */
+T mtrx_fix_det (const T *a, const size_t n)
+{
+    switch (n) {
+        case 2: return mtrx_det_2 (a);
+        case 3: return mtrx_det_3 (a);
+        case 4: return mtrx_det_4 (a);
+        case 5: return mtrx_det_5 (a);
+        case 6: return mtrx_det_6 (a);
+        case 7: return mtrx_det_7 (a);
+        case 8: return mtrx_det_8 (a);
+    }
+
+    return NAN;
+}
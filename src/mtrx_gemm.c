@@ -0,0 +1,329 @@
+#include "mtrx_gemm.h"
+#include "mtrx_thrd.h"
+#include "mtrx_simd.h"
+
+typedef struct {        /* rows r0 -> r1 of c = alpha op(a) b + beta c */
+    T * const *a, * const *b, * const *c;
+    size_t ja, jb, jc;
+    size_t r0, r1, n, k;
+    T alpha, beta;
+    int ta;             /* op(a) = a^T, a (k x m) */
+} gemm_arg_t;
+
+typedef struct {        /* chunks c0, c0 + step, ... of a^T b into part */
+    gemm_arg_t g;       /* a, b, ja, jb, m (r1), n, alpha */
+    T *part;            /* (m x n) partial product per chunk */
+    T **cr;             /* row pointers of this thread's partial */
+    size_t kr, k, c0, step;
+} gemm_tn_arg_t;
+
+/* pack rows i0 -> i0+mc, cols p0 -> p0+kc of alpha op(a) as GEMM_MR row
+ * slivers, sliver element (p, i) at p * GEMM_MR + i, short slivers zero
+ * filled. for a^T the rows of a are read in turn, each along the sliver.
+ */
+static void gemm_pack_a (T *ap, const gemm_arg_t *g, const size_t i0,
+                         const size_t mc, const size_t p0, const size_t kc)
+{
+    register size_t i, p;
+    size_t r;
+
+    if (g->ta) {
+        for (r = 0; r < mc; r += GEMM_MR, ap += GEMM_MR * kc)
+            for (p = 0; p < kc; p++) {
+                const T *ap0 = g->a[p0 + p] + g->ja + i0 + r;
+                for (i = 0; i < GEMM_MR; i++)
+                    ap[p * GEMM_MR + i] = r + i < mc ? g->alpha * ap0[i] : 0.0;
+            }
+        return;
+    }
+
+    for (r = 0; r < mc; r += GEMM_MR, ap += GEMM_MR * kc)
+        for (i = 0; i < GEMM_MR; i++) {
+            if (r + i < mc) {
+                const T *ai = g->a[i0 + r + i] + g->ja + p0;
+                for (p = 0; p < kc; p++)
+                    ap[p * GEMM_MR + i] = g->alpha * ai[p];
+            }
+            else
+                for (p = 0; p < kc; p++)
+                    ap[p * GEMM_MR + i] = 0.0;
+        }
+}
+
+/* pack rows p0 -> p0+kc, cols j0 -> j0+nc of b as GEMM_NR col slivers,
+ * sliver element (p, j) at p * GEMM_NR + j, short slivers zero filled.
+ */
+static void gemm_pack_b (T *bp, const gemm_arg_t *g, const size_t p0,
+                         const size_t kc, const size_t j0, const size_t nc)
+{
+    register size_t j, p;
+    size_t s, nr;
+
+    for (s = 0; s < nc; s += GEMM_NR, bp += GEMM_NR * kc) {
+        nr = nc - s < GEMM_NR ? nc - s : GEMM_NR;
+        for (p = 0; p < kc; p++) {
+            const T *bj = g->b[p0 + p] + g->jb + j0 + s;
+            for (j = 0; j < nr; j++)
+                bp[p * GEMM_NR + j] = bj[j];
+            for (; j < GEMM_NR; j++)
+                bp[p * GEMM_NR + j] = 0.0;
+        }
+    }
+}
+
+/* c[i0:i0+mc][j0:j0+nc] += packed a * packed b, edge tiles through a
+ * zeroed (GEMM_MR x GEMM_NR) copy.
+ */
+static void gemm_blk (const gemm_arg_t *g, const T *ap, const T *bp,
+                      const size_t i0, const size_t mc, const size_t j0,
+                      const size_t nc, const size_t kc)
+{
+    T t[GEMM_MR][GEMM_NR], *cr[GEMM_MR];
+    register size_t i, j;
+    size_t r, s, mr, nr;
+
+    for (s = 0; s < nc; s += GEMM_NR) {
+        nr = nc - s < GEMM_NR ? nc - s : GEMM_NR;
+        for (r = 0; r < mc; r += GEMM_MR) {
+            mr = mc - r < GEMM_MR ? mc - r : GEMM_MR;
+            if (mr == GEMM_MR && nr == GEMM_NR) {
+                for (i = 0; i < GEMM_MR; i++)
+                    cr[i] = g->c[i0 + r + i] + g->jc + j0 + s;
+                mtrx_kern.gemm (kc, ap + r * kc, bp + s * kc, cr);
+                continue;
+            }
+            for (i = 0; i < GEMM_MR; i++) {
+                cr[i] = t[i];
+                for (j = 0; j < GEMM_NR; j++)
+                    t[i][j] = i < mr && j < nr ?
+                              g->c[i0 + r + i][g->jc + j0 + s + j] : 0.0;
+            }
+            mtrx_kern.gemm (kc, ap + r * kc, bp + s * kc, cr);
+            for (i = 0; i < mr; i++)
+                for (j = 0; j < nr; j++)
+                    g->c[i0 + r + i][g->jc + j0 + s + j] = t[i][j];
+        }
+    }
+}
+
+/* unpacked product for small blocks (or packing buffers unavailable),
+ * one row axpy per element of a, rounding as the packed kernels.
+ */
+static void gemm_ref (const gemm_arg_t *g)
+{
+    register size_t i, p;
+
+    for (i = g->r0; i < g->r1; i++)
+        for (p = 0; p < g->k; p++)
+            mtrx_kern.axpy (g->n, g->alpha * (g->ta ? g->a[p][g->ja + i] :
+                                                      g->a[i][g->ja + p]),
+                            g->b[p] + g->jb, g->c[i] + g->jc);
+}
+
+/* scale rows r0 -> r1 of c by beta, then add the product, (GEMM_KC x
+ * GEMM_NC) blocks of b packed once and each (GEMM_MC x GEMM_KC) block of
+ * a packed against it.
+ */
+static void *gemm_run (void *arg)
+{
+    const gemm_arg_t *g = arg;
+    const size_t kcmax = g->k < GEMM_KC ? g->k : GEMM_KC,
+                 ncmax = g->n < GEMM_NC ? (g->n + GEMM_NR - 1) / GEMM_NR *
+                                          GEMM_NR : GEMM_NC;
+    size_t i0, j0, p0, mc, nc, kc;
+    register size_t i, j;
+    T *ap = NULL, *bp = NULL;
+
+    for (i = g->r0; i < g->r1; i++) {
+        if (g->beta == 0.0)
+            for (j = 0; j < g->n; j++)
+                g->c[i][g->jc + j] = 0.0;
+        else if (g->beta != 1.0)
+            mtrx_kern.scal (g->n, g->beta, g->c[i] + g->jc);
+    }
+
+    if ((g->r1 - g->r0) * g->n * g->k < GEMM_SMALL ||
+        !(ap = malloc (GEMM_MC * kcmax * sizeof *ap)) ||
+        !(bp = malloc (ncmax * kcmax * sizeof *bp))) {
+        gemm_ref (g);
+        goto gemmdone;
+    }
+
+    for (j0 = 0; j0 < g->n; j0 += GEMM_NC) {
+        nc = g->n - j0 < GEMM_NC ? g->n - j0 : GEMM_NC;
+        for (p0 = 0; p0 < g->k; p0 += GEMM_KC) {
+            kc = g->k - p0 < GEMM_KC ? g->k - p0 : GEMM_KC;
+            gemm_pack_b (bp, g, p0, kc, j0, nc);
+            for (i0 = g->r0; i0 < g->r1; i0 += GEMM_MC) {
+                mc = g->r1 - i0 < GEMM_MC ? g->r1 - i0 : GEMM_MC;
+                gemm_pack_a (ap, g, i0, mc, p0, kc);
+                gemm_blk (g, ap, bp, i0, mc, j0, nc, kc);
+            }
+        }
+    }
+
+    gemmdone:;
+    free (ap);
+    free (bp);
+
+    return NULL;
+}
+
+/* split rows of c over mtrx_nthrd_get() threads of at least GEMM_MC rows */
+static void gemm_thrd (const size_t m, const size_t n, const size_t k,
+                       const T alpha, T * const *a, const size_t ja,
+                       const int ta, T * const *b, const size_t jb,
+                       const T beta, T * const *c, const size_t jc)
+{
+    gemm_arg_t g[MTRX_THRD_MAX];
+    pthread_t tid[MTRX_THRD_MAX];
+    int nt = mtrx_nthrd_get(), i, nrun;
+
+    if (m < (size_t)nt * GEMM_MC)       /* at least GEMM_MC rows each */
+        nt = m / GEMM_MC ? (int)(m / GEMM_MC) : 1;
+
+    for (i = 0; i < nt; i++) {
+        g[i].a = a;
+        g[i].b = b;
+        g[i].c = c;
+        g[i].ja = ja;
+        g[i].jb = jb;
+        g[i].jc = jc;
+        g[i].r0 = m * i / nt;
+        g[i].r1 = m * (i + 1) / nt;
+        g[i].n = n;
+        g[i].k = k;
+        g[i].alpha = alpha;
+        g[i].beta = beta;
+        g[i].ta = ta;
+    }
+
+    for (nrun = 1; nrun < nt; nrun++)
+        if (pthread_create (&tid[nrun], NULL, gemm_run, &g[nrun]))
+            break;
+    gemm_run (&g[0]);
+    for (i = nrun; i < nt; i++)         /* rows of threads not created */
+        gemm_run (&g[i]);
+    for (i = 1; i < nrun; i++)
+        pthread_join (tid[i], NULL);
+}
+
+/* partial products of the chunks of kr rows of a and b dealt to this
+ * thread, each into its own (m x n) block of part.
+ */
+static void *gemm_tn_run (void *arg)
+{
+    gemm_tn_arg_t *t = arg;
+    gemm_arg_t g = t->g;
+    const size_t m = g.r1, nchk = (t->k + t->kr - 1) / t->kr;
+    register size_t i;
+    size_t c, p0;
+
+    for (c = t->c0; c < nchk; c += t->step) {
+        p0 = c * t->kr;
+        for (i = 0; i < m; i++)
+            t->cr[i] = t->part + (c * m + i) * g.n;
+        g.a = t->g.a + p0;
+        g.b = t->g.b + p0;
+        g.c = t->cr;
+        g.k = t->k - p0 < t->kr ? t->k - p0 : t->kr;
+        gemm_run (&g);
+    }
+
+    return NULL;
+}
+
+/** mtrx_gemm - c = alpha a b + beta c, a (m x k), b (k x n), c (m x n).
+ *  each operand is given by its row pointers and the column of its first
+ *  element, rows of c are split over mtrx_nthrd_get() threads of at least
+ *  GEMM_MC rows, see mtrx_gemm.h.
+ */
+void mtrx_gemm (const size_t m, const size_t n, const size_t k,
+                const T alpha, T * const *a, const size_t ja,
+                T * const *b, const size_t jb,
+                const T beta, T * const *c, const size_t jc)
+{
+    if (!m || !n)
+        return;
+
+    gemm_thrd (m, n, k, alpha, a, ja, 0, b, jb, beta, c, jc);
+}
+
+/** mtrx_gemm_tn - c = alpha a^T b + beta c, a (k x m), b (k x n), c (m x n).
+ *  operands as mtrx_gemm(). a short c (m < GEMM_MC) over a long k is
+ *  summed in chunks of k rows dealt to threads, chunk products added to c
+ *  in chunk order, see mtrx_gemm.h.
+ */
+void mtrx_gemm_tn (const size_t m, const size_t n, const size_t k,
+                   const T alpha, T * const *a, const size_t ja,
+                   T * const *b, const size_t jb,
+                   const T beta, T * const *c, const size_t jc)
+{
+    gemm_tn_arg_t t[MTRX_THRD_MAX];
+    pthread_t tid[MTRX_THRD_MAX];
+    size_t kr, nchk;
+    register size_t i, j;
+    int nt = mtrx_nthrd_get(), nrun;
+    T *part = NULL, **cr = NULL;
+
+    if (!m || !n)
+        return;
+
+    kr = (k + GEMM_KRMAX - 1) / GEMM_KRMAX;
+    if (kr < GEMM_KR)
+        kr = GEMM_KR;
+    nchk = (k + kr - 1) / kr;
+
+    if (m >= GEMM_MC || nchk < 2 ||
+        !(part = malloc (nchk * m * n * sizeof *part)) ||
+        !(cr = malloc ((size_t)nt * m * sizeof *cr))) {
+        free (part);
+        gemm_thrd (m, n, k, alpha, a, ja, 1, b, jb, beta, c, jc);
+        return;
+    }
+
+    if ((size_t)nt > nchk)
+        nt = (int)nchk;
+
+    for (i = 0; i < (size_t)nt; i++) {
+        t[i].g.a = a;
+        t[i].g.b = b;
+        t[i].g.ja = ja;
+        t[i].g.jb = jb;
+        t[i].g.jc = 0;
+        t[i].g.r0 = 0;
+        t[i].g.r1 = m;
+        t[i].g.n = n;
+        t[i].g.alpha = alpha;
+        t[i].g.beta = 0.0;
+        t[i].g.ta = 1;
+        t[i].part = part;
+        t[i].cr = cr + i * m;
+        t[i].kr = kr;
+        t[i].k = k;
+        t[i].c0 = i;
+        t[i].step = nt;
+    }
+
+    for (nrun = 1; nrun < nt; nrun++)
+        if (pthread_create (&tid[nrun], NULL, gemm_tn_run, &t[nrun]))
+            break;
+    gemm_tn_run (&t[0]);
+    for (i = nrun; i < (size_t)nt; i++) /* chunks of threads not created */
+        gemm_tn_run (&t[i]);
+    for (i = 1; i < (size_t)nrun; i++)
+        pthread_join (tid[i], NULL);
+
+    for (i = 0; i < m; i++) {           /* c = beta c + chunks in order */
+        if (beta == 0.0)
+            for (j = 0; j < n; j++)
+                c[i][jc + j] = 0.0;
+        else if (beta != 1.0)
+            mtrx_kern.scal (n, beta, c[i] + jc);
+        for (j = 0; j < nchk; j++)
+            mtrx_kern.axpy (n, 1.0, part + (j * m + i) * n, c[i] + jc);
+    }
+
+    free (cr);
+    free (part);
+}
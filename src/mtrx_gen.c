@@ -0,0 +1,59 @@
+#include "mtrx_t.h"
+#include "mtrx_gen.h"
+
+/** mtrx_solv_gaussj_sys - Gauss-Jordan solve of (n x n+k) mtrx_t m for
+ *  mtrx_gen_solv_gaussj(), mtrx_solv_sys() with SOLV_GAUSSJ.
+ */
+int mtrx_solv_gaussj_sys (mtrx_t *m)
+{
+    return mtrx_solv_sys (m, SOLV_GAUSSJ);
+}
+
+#define GEN_T float
+#define GEN_S f
+#define GEN_R float
+#define GEN_ABS(x) fabsf (x)
+#define GEN_STRTO(s,e) strtof (s, e)
+#define GEN_PRN(w,x) printf (" % *g", w, (double)(x))
+#include "mtrx_gen_impl.h"
+
+#define GEN_T long double
+#define GEN_S l
+#define GEN_R long double
+#define GEN_ABS(x) fabsl (x)
+#define GEN_STRTO(s,e) strtold (s, e)
+#define GEN_PRN(w,x) printf (" % *Lg", w, x)
+#include "mtrx_gen_impl.h"
+
+#ifndef __STDC_NO_COMPLEX__
+/* convert "re", "imi" or "re+imi" (no spaces, 'j' also accepted) */
+static double complex gen_strtoz (char *nptr, char **endptr)
+{
+    double re = strtod (nptr, endptr), im;
+    char *p = *endptr, *e;
+
+    if (p == nptr)
+        return 0;
+    if (*p == 'i' || *p == 'j') {       /* imaginary only */
+        *endptr = p + 1;
+        return CMPLX (0.0, re);
+    }
+    if (*p != '+' && *p != '-')         /* real only */
+        return re;
+
+    im = strtod (p, &e);                /* signed imaginary part */
+    if (e == p || (*e != 'i' && *e != 'j'))
+        return re;
+    *endptr = e + 1;
+
+    return CMPLX (re, im);
+}
+
+#define GEN_T double complex
+#define GEN_S z
+#define GEN_R double
+#define GEN_ABS(x) cabs (x)
+#define GEN_STRTO(s,e) gen_strtoz (s, e)
+#define GEN_PRN(w,x) printf (" % *g%+gi", w, creal (x), cimag (x))
+#include "mtrx_gen_impl.h"
+#endif
@@ -0,0 +1,260 @@
+#include "mtrx_inv.h"
+#include "mtrx_thrd.h"
+#include "mtrx_simd.h"
+#include "mtrx_cond.h"
+
+typedef struct {        /* column blocks b0, b0 + step, ... of the inverse */
+    T * const *lu;      /* LU factors of P A */
+    const size_t *pinv; /* row of P A holding row j of A */
+    const size_t *cols; /* inverse columns (NULL - 0 -> nc-1) */
+    size_t n, nc;       /* order, columns */
+    T * const *x;       /* result rows (n x nc), NULL - diagonal only */
+    T *diag;            /* diagonal (nc) when x is NULL */
+    size_t b0, step;
+    int err;            /* scratch allocation failed */
+} inv_arg_t;
+
+/* r[i] -= lu[i][p] r[p] for rows i0 -> i1 and p0 -> p1, four rows p per
+ * pass over r[i] (rounding as one axpy per p in turn).
+ */
+static void inv_upd (T * const *lu, T * const *r, const size_t i0,
+                     const size_t i1, const size_t p0, const size_t p1,
+                     const size_t nb)
+{
+    register size_t i, p;
+
+    for (i = i0; i < i1; i++) {
+        for (p = p0; p + 4 <= p1; p += 4) {
+            const T alpha[4] = { -lu[i][p], -lu[i][p + 1], -lu[i][p + 2],
+                                 -lu[i][p + 3] },
+                    *x[4] = { r[p], r[p + 1], r[p + 2], r[p + 3] };
+            mtrx_kern.axpy4 (nb, alpha, x, r[i]);
+        }
+        for (; p < p1; p++)
+            mtrx_kern.axpy (nb, -lu[i][p], r[p], r[i]);
+    }
+}
+
+/* r = L^-1 r, L unit lower, in INV_NB row blocks so each block of rows p
+ * stays in cache while the rows of block i are updated.
+ */
+static void inv_fwd (T * const *lu, T * const *r, const size_t n,
+                     const size_t nb)
+{
+    register size_t i;
+    size_t i0, i1, p0;
+
+    for (i0 = 0; i0 < n; i0 += INV_NB) {
+        i1 = i0 + INV_NB < n ? i0 + INV_NB : n;
+        for (p0 = 0; p0 < i0; p0 += INV_NB)
+            inv_upd (lu, r, i0, i1, p0, p0 + INV_NB, nb);
+        for (i = i0 + 1; i < i1; i++)
+            inv_upd (lu, r, i, i + 1, i0, i, nb);
+    }
+}
+
+/* r = U^-1 r, row blocks from the last, as inv_fwd() */
+static void inv_bwd (T * const *lu, T * const *r, const size_t n,
+                     const size_t nb)
+{
+    register size_t i;
+    size_t i0, i1, p0;
+
+    for (i1 = n; i1 > 0; i1 = i0) {
+        i0 = i1 > INV_NB ? i1 - INV_NB : 0;
+        for (p0 = i1; p0 < n; p0 += INV_NB)
+            inv_upd (lu, r, i0, i1, p0, p0 + INV_NB < n ? p0 + INV_NB : n,
+                     nb);
+        for (i = i1; i-- > i0;) {
+            inv_upd (lu, r, i, i + 1, i + 1, i1, nb);
+            mtrx_kern.scal (nb, 1.0 / lu[i][i], r[i]);
+        }
+    }
+}
+
+/* solve the unit right-hand sides of each column block in its columns of
+ * x (or a scratch block when only the diagonal is kept).
+ */
+static void *inv_run (void *arg)
+{
+    inv_arg_t *t = arg;
+    const size_t n = t->n, nblk = (t->nc + INV_NB - 1) / INV_NB;
+    register size_t i, j;
+    size_t b, j0, nb;
+    T **r = NULL, *s = NULL;
+
+    if (!(r = malloc (n * sizeof *r)) ||
+        (!t->x && !(s = malloc (n * INV_NB * sizeof *s)))) {
+        t->err = 1;
+        goto invdone;
+    }
+
+    for (b = t->b0; b < nblk; b += t->step) {
+        j0 = b * INV_NB;
+        nb = t->nc - j0 < INV_NB ? t->nc - j0 : INV_NB;
+
+        for (i = 0; i < n; i++) {       /* P e_j for each column */
+            r[i] = t->x ? t->x[i] + j0 : s + i * INV_NB;
+            for (j = 0; j < nb; j++)
+                r[i][j] = 0.0;
+        }
+        for (j = 0; j < nb; j++)
+            r[t->pinv[t->cols ? t->cols[j0 + j] : j0 + j]][j] = 1.0;
+
+        inv_fwd (t->lu, r, n, nb);
+        inv_bwd (t->lu, r, n, nb);
+
+        if (!t->x)
+            for (j = 0; j < nb; j++)
+                t->diag[j0 + j] = r[j0 + j][j];
+    }
+
+    invdone:;
+    free (r);
+    free (s);
+
+    return NULL;
+}
+
+/* factor the (n x n) block of m once, then solve columns cols (NULL - all
+ * nc) into rows x or the diagonal diag. returns 0 on success, -1 on
+ * invalid input or allocation failure, k + 1 if U[k][k] is exactly zero.
+ */
+static int inv_solv (const mtrx_t *m, const size_t *cols, const size_t nc,
+                     T * const *x, T *diag)
+{
+    inv_arg_t t[MTRX_THRD_MAX];
+    pthread_t tid[MTRX_THRD_MAX];
+    mtrx_t *lu = NULL;
+    size_t *piv = NULL, *rp = NULL, *pinv = NULL, n, nblk;
+    register size_t i;
+    int nt = mtrx_nthrd_get(), rtn = -1, k, nrun;
+
+    if (!m || !m->rows || m->cols < m->rows || MTRX_PACKED (m)) {
+        fprintf (stderr, "%s() error: invalid mtrx_t (cols < rows or "
+                "packed)\n", __func__);
+        return -1;
+    }
+    n = m->rows;
+
+    if (!(lu = mtrx_create_slab (n, n)) ||
+        !(piv = malloc (3 * n * sizeof *piv))) {
+        fprintf (stderr, "%s() error: allocation failed.\n", __func__);
+        goto invfree;
+    }
+    rp = piv + n;
+    pinv = rp + n;
+    lu->rows = lu->cols = n;
+    for (i = 0; i < n; i++)
+        memcpy (lu->mtrx[i], m->mtrx[i], n * sizeof (T));
+
+    if ((rtn = mtrx_lu_fact (lu->mtrx, piv, n))) {
+        fprintf (stderr, "%s() error: singular matrix, U[%d][%d] = 0.\n",
+                __func__, rtn - 1, rtn - 1);
+        goto invfree;
+    }
+    mtrx_piv_perm (piv, rp, n);
+    for (i = 0; i < n; i++)
+        pinv[rp[i]] = i;
+
+    nblk = (nc + INV_NB - 1) / INV_NB;
+    if ((size_t)nt > nblk)
+        nt = nblk ? (int)nblk : 1;
+
+    for (k = 0; k < nt; k++) {
+        t[k].lu = lu->mtrx;
+        t[k].pinv = pinv;
+        t[k].cols = cols;
+        t[k].n = n;
+        t[k].nc = nc;
+        t[k].x = x;
+        t[k].diag = diag;
+        t[k].b0 = k;
+        t[k].step = nt;
+        t[k].err = 0;
+    }
+
+    for (nrun = 1; nrun < nt; nrun++)
+        if (pthread_create (&tid[nrun], NULL, inv_run, &t[nrun]))
+            break;
+    inv_run (&t[0]);
+    for (k = nrun; k < nt; k++)         /* blocks of threads not created */
+        inv_run (&t[k]);
+    for (k = 1; k < nrun; k++)
+        pthread_join (tid[k], NULL);
+
+    for (k = 0; k < nt; k++)
+        if (t[k].err) {
+            fprintf (stderr, "%s() error: scratch allocation failed.\n",
+                    __func__);
+            rtn = -1;
+        }
+
+    invfree:;
+    if (lu)
+        mtrx_free (lu);
+    free (piv);
+
+    return rtn;
+}
+
+/** mtrx_inv - inverse of the (n x n) leading block of m, factored once by
+ *  blocked LU, the unit right-hand sides solved in column blocks across
+ *  threads directly into the result. returns the (n x n) inverse on
+ *  success, NULL otherwise.
+ */
+mtrx_t *mtrx_inv (const mtrx_t *m)
+{
+    return mtrx_inv_cols (m, NULL, m ? m->rows : 0);
+}
+
+/** mtrx_inv_cols - columns cols[0] -> cols[nc-1] of the inverse (cols
+ *  NULL, the first nc). returns the (n x nc) result on success, NULL on
+ *  invalid column, allocation failure or if the block is singular.
+ */
+mtrx_t *mtrx_inv_cols (const mtrx_t *m, const size_t *cols,
+                       const size_t nc)
+{
+    mtrx_t *x;
+    register size_t k;
+
+    if (!m || !nc || (!cols && nc > m->rows))
+        return NULL;
+    for (k = 0; cols && k < nc; k++)
+        if (cols[k] >= m->rows) {
+            fprintf (stderr, "%s() error: column %zu >= order %zu.\n",
+                    __func__, cols[k], m->rows);
+            return NULL;
+        }
+
+    if (!(x = mtrx_create_slab (m->rows, nc)))
+        return NULL;
+    x->rows = m->rows;
+    x->cols = nc;
+
+    if (inv_solv (m, cols, nc, x->mtrx, NULL)) {
+        mtrx_free (x);
+        return NULL;
+    }
+
+    return x;
+}
+
+/** mtrx_inv_diag - diagonal of the inverse, column blocks solved in
+ *  per-thread scratch so only O(n) of the inverse is stored. returns
+ *  allocated vector of n elements on success, NULL otherwise.
+ */
+T *mtrx_inv_diag (const mtrx_t *m)
+{
+    T *d;
+
+    if (!m || !(d = vect_calloc (m->rows ? m->rows : 1)))
+        return NULL;
+
+    if (inv_solv (m, NULL, m->rows, NULL, d)) {
+        free (d);
+        return NULL;
+    }
+
+    return d;
+}
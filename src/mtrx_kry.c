@@ -0,0 +1,606 @@
+#define _POSIX_C_SOURCE 200809L     /* clock_gettime (CLOCK_MONOTONIC) */
+
+#include <time.h>
+
+#include "mtrx_kry.h"
+#include "mtrx_thrd.h"
+#include "mtrx_simd.h"
+
+static const char *kry_name[] = { "cg", "bicgstab", "gmres" };
+
+typedef struct {            /* preconditioner */
+    int type;
+    T *dinv;                /* Jacobi inverse diagonal */
+    T *lu;                  /* ILU(0) factors on the pattern of a */
+    size_t *dp;             /* ILU(0) diagonal positions */
+} kry_pre_t;
+
+struct kry_thd;
+
+typedef struct {            /* shared solver state */
+    const csr_t *a;
+    const T *b;
+    T *x, *w;               /* solution, work vectors */
+    kry_t *opt;
+    const kry_pre_t *pre;
+    T *part;                /* partial sums, 2 slots x nthrd x pstride */
+    size_t pstride;
+    T *hw;                  /* per-thread GMRES Hessenberg/rotations */
+    size_t hsz;
+    int nthrd, info;
+    void (*fn) (struct kry_thd *t);
+    bar_t bar;
+} kry_sh_t;
+
+typedef struct kry_thd {    /* per-thread state */
+    kry_sh_t *s;
+    int id;
+    size_t lo, hi;          /* rows [lo, hi) of this thread */
+    unsigned seq;           /* reductions completed, selects partial slot */
+} kry_thd_t;
+
+static double kry_now (void)
+{
+    struct timespec ts;
+
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec + ts.tv_nsec * 1.0e-9;
+}
+
+/** kry_defaults - set k to GMRES(30) with ILU(0), tol 1.0e-10, maxit
+ *  1000, threads from mtrx_nthrd_get() and no log output.
+ */
+void kry_defaults (kry_t *k)
+{
+    memset (k, 0, sizeof *k);
+    k->method = KRY_GMRES;
+    k->precond = PRE_ILU0;
+    k->maxit = 1000;
+    k->restart = 30;
+    k->tol = 1.0e-10;
+}
+
+/* first row of partition id of nthrd, balanced by non-zeros + rows */
+static size_t kry_bound (const csr_t *a, const int id, const int nthrd)
+{
+    size_t lo = 0, hi = a->rows,
+           tgt = (a->nnz + a->rows) * (size_t)id / (size_t)nthrd;
+
+    if (id >= nthrd)
+        return a->rows;
+
+    while (lo < hi) {       /* first r with rp[r] + r >= tgt */
+        size_t mid = lo + (hi - lo) / 2;
+        if (a->rp[mid] + mid < tgt)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    return lo;
+}
+
+/* this thread's partial sums for the next reduction, reductions alternate
+ * between two slots so one barrier per reduction suffices.
+ */
+static T *kry_part (kry_thd_t *t)
+{
+    kry_sh_t *s = t->s;
+
+    return s->part + ((t->seq & 1) * s->nthrd + t->id) * s->pstride;
+}
+
+/* wait for all partials, then sum nd of them in thread order into out */
+static void kry_red (kry_thd_t *t, const size_t nd, T *out)
+{
+    kry_sh_t *s = t->s;
+    const T *p = s->part + (t->seq & 1) * s->nthrd * s->pstride;
+    register size_t d;
+    int i;
+
+    bar_wait (&s->bar);
+    for (d = 0; d < nd; d++)
+        out[d] = p[d];
+    for (i = 1; i < s->nthrd; i++)
+        for (d = 0; d < nd; d++)
+            out[d] += p[i * s->pstride + d];
+    t->seq++;
+}
+
+/* x . y over all rows */
+static T kry_dot (kry_thd_t *t, const T *x, const T *y)
+{
+    T r;
+
+    kry_part (t)[0] = mtrx_kern.dot (t->hi - t->lo, x + t->lo, y + t->lo);
+    kry_red (t, 1, &r);
+
+    return r;
+}
+
+/* y = A x for this thread's rows, once all rows of x are complete */
+static void kry_mv (kry_thd_t *t, const T *x, T *y)
+{
+    bar_wait (&t->s->bar);
+    csr_mv_rows (t->s->a, x, y, t->lo, t->hi);
+}
+
+/* z = M^-1 r, Jacobi by rows, ILU(0) sequentially by thread 0 */
+static void kry_prec (kry_thd_t *t, const T *r, T *z)
+{
+    const kry_pre_t *pre = t->s->pre;
+    register size_t i;
+
+    switch (pre->type) {
+        case PRE_ILU0:
+            bar_wait (&t->s->bar);
+            if (!t->id)
+                csr_ilu0_solv (t->s->a, pre->lu, pre->dp, r, z);
+            bar_wait (&t->s->bar);
+            break;
+        case PRE_JACOBI:
+            for (i = t->lo; i < t->hi; i++)
+                z[i] = r[i] * pre->dinv[i];
+            break;
+        default:
+            memcpy (z + t->lo, r + t->lo, (t->hi - t->lo) * sizeof *z);
+    }
+}
+
+static void kry_log (kry_thd_t *t, const size_t it, const T resid)
+{
+    if (!t->id && t->s->opt->log)
+        fprintf (t->s->opt->log, "%-8s iter %5zu  resid %.6e\n",
+                kry_name[t->s->opt->method], it, resid);
+}
+
+static void kry_done (kry_thd_t *t, const size_t it, const T resid, int info)
+{
+    if (t->id)
+        return;
+
+    t->s->opt->iter = it;
+    t->s->opt->resid = resid;
+    t->s->info = resid <= t->s->opt->tol ? 0 : info;
+}
+
+/** preconditioned conjugate gradient (symmetric positive definite) */
+static void kry_cg (kry_thd_t *t)
+{
+    kry_sh_t *s = t->s;
+    const size_t n = s->a->rows, lo = t->lo, nr = t->hi - t->lo;
+    const T *b = s->b, tol = s->opt->tol;
+    T *x = s->x, *r = s->w, *z = r + n, *p = z + n, *q = p + n,
+      *part, red[3], rz, bnrm, resid;
+    size_t it = 0;
+    register size_t i;
+    int info = 1;
+
+    kry_mv (t, x, q);                   /* r = b - A x */
+    for (i = lo; i < t->hi; i++)
+        r[i] = b[i] - q[i];
+    kry_prec (t, r, z);
+    memcpy (p + lo, z + lo, nr * sizeof *p);
+
+    part = kry_part (t);
+    part[0] = mtrx_kern.dot (nr, r + lo, z + lo);
+    part[1] = mtrx_kern.dot (nr, b + lo, b + lo);
+    part[2] = mtrx_kern.dot (nr, r + lo, r + lo);
+    kry_red (t, 3, red);
+    rz = red[0];
+    bnrm = red[1] > 0.0 ? sqrt (red[1]) : 1.0;
+    resid = sqrt (red[2]) / bnrm;
+    kry_log (t, it, resid);
+
+    while (resid > tol && it < s->opt->maxit) {
+        T pq, alpha, beta;
+
+        kry_mv (t, p, q);
+        if (rz == 0.0 || (pq = kry_dot (t, p, q)) == 0.0) {
+            info = 2;
+            break;
+        }
+        alpha = rz / pq;
+        mtrx_kern.axpy (nr, alpha, p + lo, x + lo);
+        mtrx_kern.axpy (nr, -alpha, q + lo, r + lo);
+        kry_prec (t, r, z);
+
+        part = kry_part (t);            /* r.r and r.z in one reduction */
+        part[0] = mtrx_kern.dot (nr, r + lo, r + lo);
+        part[1] = mtrx_kern.dot (nr, r + lo, z + lo);
+        kry_red (t, 2, red);
+        resid = sqrt (red[0]) / bnrm;
+        kry_log (t, ++it, resid);
+
+        beta = red[1] / rz;
+        rz = red[1];
+        for (i = lo; i < t->hi; i++)
+            p[i] = z[i] + beta * p[i];
+    }
+
+    kry_done (t, it, resid, info);
+}
+
+/** right preconditioned BiCGSTAB. the recursively updated residual can
+ *  drift from b - A x, so convergence is confirmed on the true residual
+ *  and the iteration restarted from it if not.
+ */
+static void kry_bicgstab (kry_thd_t *t)
+{
+    kry_sh_t *s = t->s;
+    const size_t n = s->a->rows, lo = t->lo, nr = t->hi - t->lo;
+    const T *b = s->b, tol = s->opt->tol;
+    T *x = s->x, *r = s->w, *rh = r + n, *p = rh + n, *v = p + n,
+      *ph = v + n, *sv = ph + n, *sh = sv + n, *tv = sh + n,
+      *part, red[2], rho, rho1, alpha, omega, bnrm, resid;
+    size_t it = 0;
+    register size_t i;
+    int info = 1;
+
+    for (;;) {
+        kry_mv (t, x, v);               /* r = rh = b - A x, p = v = 0 */
+        for (i = lo; i < t->hi; i++) {
+            rh[i] = r[i] = b[i] - v[i];
+            p[i] = v[i] = 0.0;
+        }
+
+        part = kry_part (t);
+        part[0] = mtrx_kern.dot (nr, r + lo, r + lo);
+        part[1] = mtrx_kern.dot (nr, b + lo, b + lo);
+        kry_red (t, 2, red);
+        rho = alpha = omega = 1.0;
+        rho1 = red[0];
+        bnrm = red[1] > 0.0 ? sqrt (red[1]) : 1.0;
+        resid = sqrt (red[0]) / bnrm;
+        if (!it)
+            kry_log (t, it, resid);
+        if (resid <= tol || it >= s->opt->maxit || info == 2)
+            break;
+
+        while (resid > tol && it < s->opt->maxit) {
+            T beta, rhv;
+
+            if (rho1 == 0.0) {
+                info = 2;
+                break;
+            }
+            beta = (rho1 / rho) * (alpha / omega);
+            for (i = lo; i < t->hi; i++)
+                p[i] = r[i] + beta * (p[i] - omega * v[i]);
+
+            kry_prec (t, p, ph);
+            kry_mv (t, ph, v);
+            if ((rhv = kry_dot (t, rh, v)) == 0.0) {
+                info = 2;
+                break;
+            }
+            alpha = rho1 / rhv;
+            for (i = lo; i < t->hi; i++)
+                sv[i] = r[i] - alpha * v[i];
+
+            kry_prec (t, sv, sh);
+            kry_mv (t, sh, tv);
+            part = kry_part (t);
+            part[0] = mtrx_kern.dot (nr, tv + lo, sv + lo);
+            part[1] = mtrx_kern.dot (nr, tv + lo, tv + lo);
+            kry_red (t, 2, red);
+            omega = red[1] > 0.0 ? red[0] / red[1] : 0.0;
+
+            for (i = lo; i < t->hi; i++) {
+                x[i] += alpha * ph[i] + omega * sh[i];
+                r[i] = sv[i] - omega * tv[i];
+            }
+            part = kry_part (t);        /* r.r and rh.r in one reduction */
+            part[0] = mtrx_kern.dot (nr, r + lo, r + lo);
+            part[1] = mtrx_kern.dot (nr, rh + lo, r + lo);
+            kry_red (t, 2, red);
+            resid = sqrt (red[0]) / bnrm;
+            kry_log (t, ++it, resid);
+
+            rho = rho1;
+            rho1 = red[1];
+            if (omega == 0.0) {
+                info = 2;
+                break;
+            }
+        }
+    }
+
+    kry_done (t, it, resid, info);
+}
+
+/** right preconditioned restarted GMRES(m), Arnoldi by classical
+ *  Gram-Schmidt applied twice (one reduction per pass for all of the
+ *  basis), the small Hessenberg least squares problem is reduced by Givens
+ *  rotations on every thread alike.
+ */
+static void kry_gmres (kry_thd_t *t)
+{
+    kry_sh_t *s = t->s;
+    const size_t n = s->a->rows, lo = t->lo, nr = t->hi - t->lo,
+                 m = s->opt->restart;
+    const T *b = s->b, tol = s->opt->tol;
+    T *x = s->x, *vb = s->w, *z = vb + (m + 1) * n, *u = z + n,
+      *h = s->hw + t->id * s->hsz,      /* (m+1 x m) Hessenberg */
+      *cs = h + (m + 1) * m, *sn = cs + m, *g = sn + m, *y = g + m + 1,
+      *c = y + m, bnrm, resid = 0.0, hn = 1.0;
+    size_t it = 0, j;
+    register size_t i, l;
+    int pass;
+
+    bnrm = sqrt (kry_dot (t, b, b));
+    if (bnrm == 0.0)
+        bnrm = 1.0;
+
+    for (;;) {
+        kry_mv (t, x, z);               /* v0 = b - A x, true residual */
+        for (i = lo; i < t->hi; i++)
+            vb[i] = b[i] - z[i];
+        g[0] = sqrt (kry_dot (t, vb, vb));
+        resid = g[0] / bnrm;
+        if (!it)
+            kry_log (t, it, resid);
+        if (resid <= tol || it >= s->opt->maxit || hn == 0.0)
+            break;
+
+        mtrx_kern.scal (nr, 1.0 / g[0], vb + lo);
+        for (i = 1; i <= m; i++)
+            g[i] = 0.0;
+
+        for (j = 0; j < m && it < s->opt->maxit; ) {
+            T *vj = vb + j * n, *w = vj + n, d;
+
+            kry_prec (t, vj, z);        /* w = A M^-1 v_j */
+            kry_mv (t, z, w);
+
+            for (i = 0; i <= j; i++)
+                h[i * m + j] = 0.0;
+            for (pass = 0; pass < 2; pass++) {  /* w -= V (V^T w) */
+                T *part = kry_part (t);
+                for (i = 0; i <= j; i++)
+                    part[i] = mtrx_kern.dot (nr, vb + i * n + lo, w + lo);
+                kry_red (t, j + 1, c);
+                for (i = 0; i <= j; i++) {
+                    mtrx_kern.axpy (nr, -c[i], vb + i * n + lo, w + lo);
+                    h[i * m + j] += c[i];
+                }
+            }
+            hn = sqrt (kry_dot (t, w, w));
+            h[(j + 1) * m + j] = hn;
+            if (hn != 0.0)
+                mtrx_kern.scal (nr, 1.0 / hn, w + lo);
+
+            for (i = 0; i < j; i++) {   /* apply previous rotations */
+                T tmp = cs[i] * h[i * m + j] + sn[i] * h[(i + 1) * m + j];
+                h[(i + 1) * m + j] = -sn[i] * h[i * m + j] +
+                                      cs[i] * h[(i + 1) * m + j];
+                h[i * m + j] = tmp;
+            }
+            d = hypot (h[j * m + j], hn);
+            cs[j] = d != 0.0 ? h[j * m + j] / d : 1.0;
+            sn[j] = d != 0.0 ? hn / d : 0.0;
+            h[j * m + j] = d;
+            g[j + 1] = -sn[j] * g[j];
+            g[j] *= cs[j];
+
+            resid = fabs (g[j + 1]) / bnrm;
+            kry_log (t, ++it, resid);
+            j++;
+            if (resid <= tol || hn == 0.0)
+                break;
+        }
+
+        for (i = j; i--; ) {            /* y = H^-1 g */
+            y[i] = g[i];
+            for (l = i + 1; l < j; l++)
+                y[i] -= h[i * m + l] * y[l];
+            y[i] = h[i * m + i] != 0.0 ? y[i] / h[i * m + i] : 0.0;
+        }
+        memset (u + lo, 0, nr * sizeof *u);     /* x += M^-1 V y */
+        for (i = 0; i < j; i++)
+            mtrx_kern.axpy (nr, y[i], vb + i * n + lo, u + lo);
+        kry_prec (t, u, z);
+        for (i = lo; i < t->hi; i++)
+            x[i] += z[i];
+    }
+
+    kry_done (t, it, resid, hn == 0.0 ? 2 : 1);
+}
+
+static void *kry_worker (void *arg)
+{
+    kry_thd_t *t = arg;
+    kry_sh_t *s = t->s;
+
+    bar_wait (&s->bar);         /* thread count final */
+    t->lo = kry_bound (s->a, t->id, s->nthrd);
+    t->hi = kry_bound (s->a, t->id + 1, s->nthrd);
+    s->fn (t);
+
+    return NULL;
+}
+
+static void kry_pre_free (kry_pre_t *pre)
+{
+    free (pre->dinv);
+    free (pre->lu);
+    free (pre->dp);
+}
+
+/* build preconditioner type for a, returns 0 on success */
+static int kry_pre_init (const csr_t *a, const int type, kry_pre_t *pre)
+{
+    memset (pre, 0, sizeof *pre);
+    pre->type = type;
+
+    if (type == PRE_JACOBI) {
+        if (!(pre->dinv = malloc (a->rows * sizeof *pre->dinv))) {
+            fprintf (stderr, "%s() error: malloc-dinv.\n", __func__);
+            return -1;
+        }
+        return csr_jacobi (a, pre->dinv);
+    }
+    if (type == PRE_ILU0) {
+        if (!(pre->lu = malloc ((a->nnz ? a->nnz : 1) * sizeof *pre->lu)) ||
+            !(pre->dp = malloc ((a->rows ? a->rows : 1) * sizeof *pre->dp))) {
+            fprintf (stderr, "%s() error: memory exhausted.\n", __func__);
+            return -1;
+        }
+        return csr_ilu0 (a, pre->lu, pre->dp);
+    }
+
+    return 0;
+}
+
+/* run opt->method on opt->nthrd threads with preconditioner pre */
+static int kry_run (const csr_t *a, const T *b, T *x, kry_t *opt,
+                    const kry_pre_t *pre)
+{
+    void (*fn[]) (kry_thd_t *) = { kry_cg, kry_bicgstab, kry_gmres };
+    kry_sh_t s = { .a = a, .b = b, .x = x, .opt = opt, .pre = pre,
+                   .info = -1 };
+    pthread_t tid[MTRX_THRD_MAX];
+    kry_thd_t thd[MTRX_THRD_MAX];
+    const size_t n = a->rows, m = opt->restart ? opt->restart : 30;
+    size_t nvec = 4;
+    int nthrd = opt->nthrd ? opt->nthrd : mtrx_nthrd_get (), t;
+
+    if (nthrd > MTRX_THRD_MAX)
+        nthrd = MTRX_THRD_MAX;
+    if ((size_t)nthrd > n)
+        nthrd = n ? (int)n : 1;
+    if (nthrd < 1)
+        nthrd = 1;
+
+    opt->restart = m;
+    s.fn = fn[opt->method];
+    s.pstride = 8;              /* 64 byte partials, (m + 1) for GMRES */
+    if (opt->method == KRY_BICGSTAB)
+        nvec = 8;
+    else if (opt->method == KRY_GMRES) {
+        nvec = m + 3;
+        s.pstride = (m + 8) & ~(size_t)7;
+        s.hsz = (m + 1) * m + 5 * m + 2;
+    }
+
+    if (!(s.w = malloc (nvec * n * sizeof *s.w)) ||
+        !(s.part = malloc (2 * nthrd * s.pstride * sizeof *s.part)) ||
+        (s.hsz && !(s.hw = malloc (nthrd * s.hsz * sizeof *s.hw)))) {
+        fprintf (stderr, "%s() error: memory exhausted.\n", __func__);
+        goto kryfree;
+    }
+
+    if (bar_init (&s.bar, nthrd)) {
+        fprintf (stderr, "%s() error: barrier init.\n", __func__);
+        goto kryfree;
+    }
+    s.nthrd = nthrd;
+
+    for (t = 0; t < nthrd; t++) {
+        thd[t].s = &s;
+        thd[t].id = t;
+        thd[t].seq = 0;
+        if (t && pthread_create (&tid[t], NULL, kry_worker, &thd[t])) {
+            fprintf (stderr, "%s() warning: %d of %d threads started.\n",
+                    __func__, t, nthrd);
+            break;
+        }
+    }
+    s.nthrd = t;
+    bar_setcount (&s.bar, t);
+
+    kry_worker (&thd[0]);       /* calling thread is partition 0 */
+
+    for (t = 1; t < s.nthrd; t++)
+        pthread_join (tid[t], NULL);
+    bar_destroy (&s.bar);
+    kryfree:;
+
+    free (s.hw);
+    free (s.part);
+    free (s.w);
+
+    return s.info;
+}
+
+/* validate square system and method */
+static int kry_valid (const csr_t *a, const kry_t *opt)
+{
+    if (!a || a->rows != a->cols) {
+        fprintf (stderr, "%s() error: invalid csr_t size (rows != cols)\n",
+                __func__);
+        return 0;
+    }
+    if (opt->method < KRY_CG || opt->method > KRY_GMRES) {
+        fprintf (stderr, "%s() error: invalid Krylov method '%d'.\n",
+                __func__, opt->method);
+        return 0;
+    }
+
+    return 1;
+}
+
+/** csr_solv_kry - solve A x = b by the preconditioned Krylov method in
+ *  opt, x holds the initial guess on entry and the solution on return.
+ *  returns 0 if converged, 1 if not converged in opt->maxit iterations,
+ *  2 on breakdown, -1 on failure (or preconditioner failure).
+ */
+int csr_solv_kry (const csr_t *a, const T *b, T *x, kry_t *opt)
+{
+    double t0 = kry_now ();
+    kry_pre_t pre = { .type = PRE_NONE };
+    int info = -1;
+
+    opt->iter = 0;
+    if (kry_valid (a, opt) && !kry_pre_init (a, opt->precond, &pre))
+        info = kry_run (a, b, x, opt, &pre);
+    kry_pre_free (&pre);
+    opt->secs = kry_now () - t0;
+
+    return info;
+}
+
+/** mtrx_solv_csr - solve each constant column of a by csr_solv_kry() from
+ *  a zero initial guess, the preconditioner is built once. on return
+ *  a->b holds the solution, opt->iter and opt->resid are the largest and
+ *  opt->secs the total over the columns. returns 0 if all converged,
+ *  otherwise the first non-zero csr_solv_kry() return.
+ */
+int mtrx_solv_csr (csr_t *a, kry_t *opt)
+{
+    double t0 = kry_now ();
+    kry_pre_t pre = { .type = PRE_NONE };
+    size_t c, iter = 0;
+    T resid = 0.0, *x = NULL;
+    int info = -1, r;
+
+    if (!kry_valid (a, opt) || kry_pre_init (a, opt->precond, &pre))
+        goto csrdone;
+    if (!(x = malloc ((a->rows ? a->rows : 1) * sizeof *x))) {
+        fprintf (stderr, "%s() error: malloc-x.\n", __func__);
+        goto csrdone;
+    }
+
+    for (info = 0, c = 0; c < a->nrhs; c++) {
+        T *bc = a->b + c * a->rows;
+
+        memset (x, 0, a->rows * sizeof *x);
+        if ((r = kry_run (a, bc, x, opt, &pre)) && !info)
+            info = r;
+        memcpy (bc, x, a->rows * sizeof *x);
+        if (opt->iter > iter)
+            iter = opt->iter;
+        if (opt->resid > resid)
+            resid = opt->resid;
+    }
+    opt->iter = iter;
+    opt->resid = resid;
+    csrdone:;
+
+    kry_pre_free (&pre);
+    free (x);
+    opt->secs = kry_now () - t0;
+
+    return info;
+}
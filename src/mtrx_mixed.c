@@ -0,0 +1,277 @@
+#include <float.h>
+
+#include "mtrx_mixed.h"
+#include "mtrx_simd.h"
+
+/* float row stride for n cols, as slab_stride() */
+static size_t slu_stride (const size_t n)
+{
+    const size_t per = MTRX_ALIGN / sizeof (float);
+    size_t stride = (n + per - 1) / per * per;
+
+    if (!stride)
+        stride = per;
+    if ((stride * sizeof (float)) % 4096 == 0)
+        stride += per;
+
+    return stride;
+}
+
+/* unblocked LU of the (n - k x kb) float panel at a[k][k], see lu_panel() */
+static int slu_panel (float **a, size_t *piv, const size_t k, const size_t kb,
+                      const size_t n)
+{
+    int info = 0;
+    register size_t i, j;
+    const size_t kend = k + kb;
+
+    for (j = k; j < kend; j++) {
+        size_t p = j;
+        float big = fabsf (a[j][j]), pivinv;
+
+        for (i = j + 1; i < n; i++)     /* find pivot row */
+            if (fabsf (a[i][j]) > big) {
+                big = fabsf (a[i][j]);
+                p = i;
+            }
+        piv[j] = p;
+
+        if (p != j) {                   /* exchange row pointers */
+            float *tmp = a[p];
+            a[p] = a[j];
+            a[j] = tmp;
+        }
+
+        if (a[j][j] == 0.0f) {
+            if (!info)
+                info = j + 1;
+            continue;
+        }
+
+        pivinv = 1.0f / a[j][j];
+        for (i = j + 1; i < n; i++) {
+            float lij = a[i][j] *= pivinv;
+            mtrx_kern.saxpy (kend - j - 1, -lij, a[j] + j + 1, a[i] + j + 1);
+        }
+    }
+
+    return info;
+}
+
+/* U12 solve and trailing update in SLU_NC column tiles, see lu_update() */
+static void slu_update (float **a, const size_t k, const size_t kb,
+                        const size_t n)
+{
+    register size_t i, p;
+    size_t j0, j1;
+    const size_t kend = k + kb;
+
+    for (j0 = kend; j0 < n; j0 += SLU_NC) {
+        j1 = j0 + SLU_NC < n ? j0 + SLU_NC : n;
+
+        for (i = k + 1; i < kend; i++)
+            for (p = k; p < i; p++)
+                mtrx_kern.saxpy (j1 - j0, -a[i][p], a[p] + j0, a[i] + j0);
+
+        for (i = kend; i < n; i++)
+            for (p = k; p < kend; p++)
+                mtrx_kern.saxpy (j1 - j0, -a[i][p], a[p] + j0, a[i] + j0);
+    }
+}
+
+/** mtrx_slu_fact - blocked LU with partial pivoting of the (n x n) float
+ *  matrix 'a' in place, as mtrx_lu_fact() with float row updates. returns
+ *  0 on success, k + 1 if U[k][k] is exactly zero.
+ */
+int mtrx_slu_fact (float **a, size_t *piv, const size_t n)
+{
+    int info = 0, rtn;
+    size_t k, kb;
+
+    for (k = 0; k < n; k += LU_NB) {
+        kb = n - k < LU_NB ? n - k : LU_NB;
+
+        if ((rtn = slu_panel (a, piv, k, kb, n)) && !info)
+            info = rtn;
+
+        slu_update (a, k, kb, n);
+    }
+
+    return info;
+}
+
+/** mtrx_slu_solv - solve a x = b from mtrx_slu_fact factors and pivots,
+ *  b is overwritten with the solution vector.
+ */
+void mtrx_slu_solv (float * const *lu, const size_t *piv, float *b,
+                    const size_t n)
+{
+    register size_t i, j;
+
+    for (i = 0; i < n; i++)     /* apply row interchanges */
+        if (piv[i] != i) {
+            float tmp = b[i];
+            b[i] = b[piv[i]];
+            b[piv[i]] = tmp;
+        }
+
+    for (i = 1; i < n; i++) {   /* forward substitution, unit L */
+        float sum = b[i];
+        for (j = 0; j < i; j++)
+            sum -= lu[i][j] * b[j];
+        b[i] = sum;
+    }
+
+    i = n;
+    while (i--) {               /* back substitution, U */
+        float sum = b[i];
+        for (j = i + 1; j < n; j++)
+            sum -= lu[i][j] * b[j];
+        b[i] = sum / lu[i][i];
+    }
+}
+
+/* d = A^-1 (r / s) in float, x += s * d. s = max |r| keeps the scaled
+ * residual in float range.
+ */
+static void mixed_corr (float * const *lu, const size_t *piv, const T *r,
+                        const T s, float *d, T *x, const size_t n)
+{
+    register size_t i;
+
+    for (i = 0; i < n; i++)
+        d[i] = (float)(r[i] / s);
+    mtrx_slu_solv (lu, piv, d, n);
+    for (i = 0; i < n; i++)
+        x[i] += s * d[i];
+}
+
+/** mtrx_solv_mixed - solve (n x n+k) system by mixed precision iterative
+ *  refinement. the coefficients are rounded to float and factored by
+ *  blocked LU (half the memory traffic, twice the vector width), then each
+ *  solution is refined, x += A^-1 r, with the residual r = b - A x formed
+ *  in double from m until |r| <= sqrt(n) eps |A| |x| (infinity norms, eps
+ *  the double epsilon) and |r| no longer halves. if the float factorization
+ *  fails or any column does not converge in MIXED_ITMAX iterations, the
+ *  system is solved by double blocked LU instead (mtrx_solv_lu_m()). iter,
+ *  if not NULL, receives the largest number of refinement iterations, or -1
+ *  on fallback. the coefficient block of m is unchanged unless it falls
+ *  back. on return the last k cols of m contain the (n x k) solution.
+ *  returns 0 on success, non-zero otherwise.
+ */
+int mtrx_solv_mixed (mtrx_t *m, int *iter)
+{
+    const size_t n = m->rows, nrhs = m->cols > n ? m->cols - n : 0,
+                 ld = slu_stride (n),
+                 nbytes = (n * ld + 1) * sizeof (float) + MTRX_ALIGN - 1;
+#if defined (_WIN32)
+    float *slab = _aligned_malloc (nbytes, MTRX_ALIGN),
+#else
+    float *slab = aligned_alloc (MTRX_ALIGN, nbytes / MTRX_ALIGN * MTRX_ALIGN),
+#endif
+          **a = malloc ((n ? n : 1) * sizeof *a),
+          *d = malloc ((n ? n : 1) * sizeof *d);
+    size_t *piv = malloc ((n ? n : 1) * sizeof *piv);
+    T *sol = malloc ((n && nrhs ? n * nrhs : 1) * sizeof *sol),
+      *r = malloc ((n ? n : 1) * sizeof *r), anrm = 0.0;
+    register size_t i, j, c;
+    int itmax = 0, ret;
+
+    if (!nrhs) {
+        fprintf (stderr, "%s() error: invalid mtrx_t size (cols <= rows)\n",
+                __func__);
+        ret = -1;
+        goto mixeddone;
+    }
+    if (!slab || !a || !d || !piv || !sol || !r) {
+        fprintf (stderr, "%s() error: memory exhausted.\n", __func__);
+        ret = -1;
+        goto mixeddone;
+    }
+
+    for (i = 0; i < n; i++) {           /* round to float, |A| */
+        T sum = 0.0;
+
+        a[i] = slab + i * ld;
+        for (j = 0; j < n; j++) {
+            if (fabs (m->mtrx[i][j]) > FLT_MAX)
+                goto mixedfall;
+            a[i][j] = (float)m->mtrx[i][j];
+            sum += fabs (m->mtrx[i][j]);
+        }
+        if (sum > anrm)
+            anrm = sum;
+    }
+
+    if (mtrx_slu_fact (a, piv, n))
+        goto mixedfall;
+
+    for (c = 0; c < nrhs; c++) {
+        T *x = sol + c * n, bmax = 0.0, rprev;
+        int it;
+
+        for (i = 0; i < n; i++)
+            if (fabs (m->mtrx[i][n + c]) > bmax)
+                bmax = fabs (m->mtrx[i][n + c]);
+        if (bmax > FLT_MAX)
+            goto mixedfall;
+
+        for (i = 0; i < n; i++)         /* x0 = A^-1 b in float */
+            d[i] = (float)m->mtrx[i][n + c];
+        mtrx_slu_solv (a, piv, d, n);
+        for (i = 0; i < n; i++)
+            x[i] = d[i];
+
+        for (it = 0, rprev = HUGE_VAL;; it++) {
+            T rmax = 0.0, xmax = 0.0;
+
+            for (i = 0; i < n; i++) {   /* r = b - A x in double */
+                r[i] = m->mtrx[i][n + c] - mtrx_kern.dot (n, m->mtrx[i], x);
+                if (fabs (r[i]) > rmax)
+                    rmax = fabs (r[i]);
+                if (fabs (x[i]) > xmax)
+                    xmax = fabs (x[i]);
+            }
+            if (!isfinite (rmax))
+                goto mixedfall;
+            /* converged, and stagnant (no longer halving) or at the limit */
+            if (rmax <= sqrt ((T)n) * DBL_EPSILON * anrm * xmax &&
+                (rmax >= 0.5 * rprev || it == MIXED_ITMAX))
+                break;
+            if (it == MIXED_ITMAX)
+                goto mixedfall;
+            rprev = rmax;
+
+            mixed_corr (a, piv, r, rmax, d, x, n);
+        }
+        if (it > itmax)
+            itmax = it;
+    }
+
+    for (c = 0; c < nrhs; c++)
+        for (i = 0; i < n; i++)
+            m->mtrx[i][n + c] = sol[c * n + i];
+    ret = 0;
+    goto mixeddone;
+
+    mixedfall:;                         /* full double precision */
+    itmax = -1;
+    ret = mtrx_solv_lu_m (m->mtrx, n, nrhs);
+
+    mixeddone:;
+    if (iter)
+        *iter = itmax;
+
+    free (r);
+    free (sol);
+    free (piv);
+    free (d);
+    free (a);
+#if defined (_WIN32)
+    _aligned_free (slab);
+#else
+    free (slab);
+#endif
+
+    return ret;
+}
@@ -0,0 +1,638 @@
+#define _POSIX_C_SOURCE 200809L     /* pread, pwrite, ftruncate, getline */
+#define _FILE_OFFSET_BITS 64
+
+#include "mtrx_ooc.h"
+
+#if !defined (_WIN32)
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "mtrx_thrd.h"
+#include "mtrx_simd.h"
+
+typedef struct {        /* asynchronous panel transfer */
+    pthread_t tid;
+    int fd, wr;
+    int busy, err;      /* thread running, transfer failed */
+    T *buf;
+    size_t nel;         /* elements */
+    size_t panel;       /* panel transferred */
+    off_t off;          /* file offset (bytes) */
+} ooc_io_t;
+
+typedef struct {        /* rows r0 -> r1 of the panel update */
+    T *c;               /* panel, (n x nb) */
+    const T *l, *u;     /* L (row i at l + (i - l0) * nb), U block */
+    size_t l0, r0, r1;
+    size_t w, nb;       /* L cols (U rows), panel width */
+} ooc_upd_t;
+
+/* offset of row r of panel p, panels of (n x nb) row-major tiles */
+static off_t ooc_off (const mtrx_ooc_t *o, const size_t p, const size_t r)
+{
+    return ((off_t)p * o->n + r) * o->nb * sizeof (T);
+}
+
+/* read or write nel elements at off, retrying short transfers,
+ * returns 0 on success, -1 on error.
+ */
+static int ooc_pio (const int fd, T *buf, const size_t nel, off_t off,
+                    const int wr)
+{
+    char *p = (char *)buf;
+    size_t left = nel * sizeof *buf;
+
+    while (left) {
+        ssize_t r = wr ? pwrite (fd, p, left, off) : pread (fd, p, left, off);
+
+        if (r < 0 && errno == EINTR)
+            continue;
+        if (r <= 0) {
+            fprintf (stderr, "%s() error: %s failed.\n", __func__,
+                    wr ? "pwrite" : "pread");
+            return -1;
+        }
+        p += r;
+        left -= (size_t)r;
+        off += r;
+    }
+
+    return 0;
+}
+
+static void *ooc_io_run (void *arg)
+{
+    ooc_io_t *io = arg;
+
+    io->err = ooc_pio (io->fd, io->buf, io->nel, io->off, io->wr);
+
+    return NULL;
+}
+
+/* start transfer of nel elements of panel p at off, done synchronously
+ * if a thread cannot be created.
+ */
+static void ooc_io_start (ooc_io_t *io, const int wr, T *buf,
+                          const size_t nel, const off_t off, const size_t p)
+{
+    io->wr = wr;
+    io->buf = buf;
+    io->nel = nel;
+    io->off = off;
+    io->panel = p;
+    io->err = 0;
+
+    if (pthread_create (&io->tid, NULL, ooc_io_run, io))
+        ooc_io_run (io);
+    else
+        io->busy = 1;
+}
+
+/* wait for transfer, returns 0 or -1 if the last transfer failed */
+static int ooc_io_wait (ooc_io_t *io)
+{
+    if (io->busy) {
+        pthread_join (io->tid, NULL);
+        io->busy = 0;
+    }
+
+    return io->err;
+}
+
+/* start read of rows r0 -> r1 of panel p into buf, once any write of
+ * panel p in progress is complete.
+ */
+static void ooc_read (const mtrx_ooc_t *o, ooc_io_t *rd, ooc_io_t *wr, T *buf,
+                      const size_t p, const size_t r0, const size_t r1)
+{
+    if (wr->busy && wr->panel == p)
+        ooc_io_wait (wr);
+
+    ooc_io_start (rd, 0, buf, (r1 - r0) * o->nb, ooc_off (o, p, r0), p);
+}
+
+/* apply the row exchanges piv[i0 -> i1) to panel rows a (row r0 first) */
+static void ooc_swap (T *a, const size_t *piv, const size_t i0,
+                      const size_t i1, const size_t r0, const size_t nb)
+{
+    register size_t i;
+
+    for (i = i0; i < i1; i++)
+        if (piv[i] != i)
+            mtrx_kern.swap (nb, a + (i - r0) * nb, a + (piv[i] - r0) * nb);
+}
+
+/* c[i] -= l[i] u for rows r0 -> r1, in LU_NB x LU_NC tiles so the tile of
+ * u stays in cache while every row is updated.
+ */
+static void *ooc_upd_run (void *arg)
+{
+    const ooc_upd_t *t = arg;
+    const size_t nb = t->nb;
+    register size_t i, p;
+    size_t j0, j1, p0, p1;
+
+    for (j0 = 0; j0 < nb; j0 += LU_NC) {
+        j1 = j0 + LU_NC < nb ? j0 + LU_NC : nb;
+        for (p0 = 0; p0 < t->w; p0 += LU_NB) {
+            p1 = p0 + LU_NB < t->w ? p0 + LU_NB : t->w;
+            for (i = t->r0; i < t->r1; i++) {
+                const T *li = t->l + (i - t->l0) * nb;
+                T *ci = t->c + i * nb;
+
+                for (p = p0; p < p1; p++)
+                    mtrx_kern.axpy (j1 - j0, -li[p], t->u + p * nb + j0,
+                                    ci + j0);
+            }
+        }
+    }
+
+    return NULL;
+}
+
+/* update rows r0 -> r1 of panel c by L rows l (row l0 first) times the
+ * (w x nb) U block u, rows split over mtrx_nthrd_get() threads.
+ */
+static void ooc_upd (T *c, const T *l, const T *u, const size_t l0,
+                     const size_t r0, const size_t r1, const size_t w,
+                     const size_t nb)
+{
+    ooc_upd_t t[MTRX_THRD_MAX];
+    pthread_t tid[MTRX_THRD_MAX];
+    const size_t nr = r1 - r0;
+    int nt = mtrx_nthrd_get(), i, nrun;
+
+    if (nr < (size_t)nt * LU_NB)        /* at least LU_NB rows each */
+        nt = nr / LU_NB ? (int)(nr / LU_NB) : 1;
+
+    for (i = 0; i < nt; i++) {
+        t[i].c = c;
+        t[i].l = l;
+        t[i].u = u;
+        t[i].l0 = l0;
+        t[i].r0 = r0 + nr * i / nt;
+        t[i].r1 = r0 + nr * (i + 1) / nt;
+        t[i].w = w;
+        t[i].nb = nb;
+    }
+
+    for (nrun = 1; nrun < nt; nrun++)
+        if (pthread_create (&tid[nrun], NULL, ooc_upd_run, &t[nrun]))
+            break;
+    ooc_upd_run (&t[0]);
+    for (i = nrun; i < nt; i++)         /* rows of threads not created */
+        ooc_upd_run (&t[i]);
+    for (i = 1; i < nrun; i++)
+        pthread_join (tid[i], NULL);
+}
+
+/** mtrx_ooc_create - create scratch file path for a (n x n+nrhs) system
+ *  solved within mem bytes (0, OOC_MEM). the matrix is stored as panels of
+ *  nb columns, each a column of (nb x nb) row-major tiles, nb chosen so
+ *  four panels fit in mem. the file is zero filled (sparse where the file
+ *  system allows). returns pointer to mtrx_ooc_t on success, NULL if the
+ *  file cannot be created or mem is too small for OOC_NBMIN.
+ */
+mtrx_ooc_t *mtrx_ooc_create (const char *path, const size_t n,
+                             const size_t nrhs, size_t mem)
+{
+    mtrx_ooc_t *o;
+    size_t nb, nbmax, fixed;
+
+    if (!n || !nrhs) {
+        fprintf (stderr, "%s() error: invalid system (n %zu, nrhs %zu).\n",
+                __func__, n, nrhs);
+        return NULL;
+    }
+    if (!mem)
+        mem = OOC_MEM;
+
+    /* pivots, row pointers and solution, then four (n x nb) panels */
+    fixed = n * (2 * sizeof (size_t) + sizeof (T *) + nrhs * sizeof (T));
+    nb = mem > fixed ? (mem - fixed) / (4 * n * sizeof (T)) : 0;
+    nb = nb / OOC_NBMIN * OOC_NBMIN;
+    if (nb < OOC_NBMIN) {
+        fprintf (stderr, "%s() error: memory budget %zu too small for "
+                "n %zu.\n", __func__, mem, n);
+        return NULL;
+    }
+    nbmax = (n + nrhs + OOC_NBMIN - 1) / OOC_NBMIN * OOC_NBMIN;
+    if (nb > nbmax)
+        nb = nbmax;
+
+    if (!(o = calloc (1, sizeof *o)) || !(o->path = strdup (path))) {
+        fprintf (stderr, "%s() error: memory exhausted.\n", __func__);
+        free (o);
+        return NULL;
+    }
+    o->n = n;
+    o->nrhs = nrhs;
+    o->ncol = n + nrhs;
+    o->nb = nb;
+    o->np = (o->ncol + nb - 1) / nb;
+    o->npa = (n + nb - 1) / nb;
+    o->mem = mem;
+
+    if ((o->fd = open (path, O_RDWR | O_CREAT | O_TRUNC, 0600)) == -1) {
+        fprintf (stderr, "%s() error: cannot create '%s'.\n", __func__, path);
+        free (o->path);
+        free (o);
+        return NULL;
+    }
+    if (ftruncate (o->fd, ooc_off (o, o->np, 0))) {
+        fprintf (stderr, "%s() error: cannot size '%s'.\n", __func__, path);
+        mtrx_ooc_free (o);
+        return NULL;
+    }
+
+    return o;
+}
+
+/** mtrx_ooc_free - close and remove the scratch file, free o */
+void mtrx_ooc_free (mtrx_ooc_t *o)
+{
+    if (!o)
+        return;
+
+    close (o->fd);
+    remove (o->path);
+    free (o->path);
+    free (o);
+}
+
+/** mtrx_ooc_set_rows - store nr rows of ncol values (row-major, contiguous)
+ *  as rows i0 -> i0+nr-1 of the system. returns 0 on success, -1 on
+ *  invalid rows or write error.
+ */
+int mtrx_ooc_set_rows (mtrx_ooc_t *o, const size_t i0, const size_t nr,
+                       const T *rows)
+{
+    register size_t r, p;
+
+    if (i0 + nr > o->n) {
+        fprintf (stderr, "%s() error: rows %zu -> %zu exceed n %zu.\n",
+                __func__, i0, i0 + nr, o->n);
+        return -1;
+    }
+
+    for (r = 0; r < nr; r++)            /* row segment per panel */
+        for (p = 0; p < o->np; p++) {
+            const size_t c0 = p * o->nb,
+                         nc = o->ncol - c0 < o->nb ? o->ncol - c0 : o->nb;
+
+            if (ooc_pio (o->fd, (T *)(rows + r * o->ncol + c0), nc,
+                         ooc_off (o, p, i0 + r), 1))
+                return -1;
+        }
+
+    return 0;
+}
+
+/** mtrx_ooc_solv - left-looking LU with partial pivoting of the system in
+ *  the scratch file, streaming the factored panels to the left through
+ *  memory for the update of each panel. the read of the next panel and
+ *  the write of the last factored panel overlap the updates, which are
+ *  split over mtrx_nthrd_get() threads. the constant columns are carried
+ *  through the factorization, then the (n x nrhs) solution is formed by
+ *  back substitution into x (row-major). the file holds the factors on
+ *  return. returns 0 on success, -1 on allocation or i/o failure, k + 1
+ *  if U[k][k] is exactly zero (factoring stops).
+ */
+int mtrx_ooc_solv (mtrx_ooc_t *o, T *x)
+{
+    const size_t n = o->n, nb = o->nb, nrhs = o->nrhs, pel = n * nb;
+    T *buf[4] = { NULL }, **rows = malloc (n * sizeof *rows);
+    size_t *piv = malloc (n * sizeof *piv),
+           *lp = malloc (n * sizeof *lp), J, K, ns = 0;
+    ooc_io_t rd = { .fd = o->fd }, wr = { .fd = o->fd };
+    register size_t i, p;
+    int info = -1, rtn;
+
+    for (i = 0; i < 4; i++)             /* 2 panels updated, 2 of L */
+        if (!(buf[i] = malloc (pel * sizeof *buf[i])))
+            break;
+    if (i < 4 || !rows || !piv || !lp) {
+        fprintf (stderr, "%s() error: memory exhausted.\n", __func__);
+        goto oocdone;
+    }
+
+    if (!mtrx_kern.isa)
+        mtrx_simd_init();
+
+    for (J = 0; J < o->np; J++) {
+        T *c = buf[J & 1];
+        const size_t j0 = J * nb, kend = J < o->npa ? J : o->npa,
+                     w = j0 < n ? (n - j0 < nb ? n - j0 : nb) : 0;
+
+        ooc_read (o, &rd, &wr, c, J, 0, n);
+        if (ooc_io_wait (&rd))
+            goto oocdone;
+        ooc_swap (c, piv, 0, ns, 0, nb);    /* exchanges so far */
+
+        if (kend)
+            ooc_read (o, &rd, &wr, buf[2], 0, 0, n);
+        for (K = 0; K < kend; K++) {    /* update by panels to the left */
+            T *l = buf[2 + (K & 1)];
+            const size_t k0 = K * nb, wk = n - k0 < nb ? n - k0 : nb;
+
+            if (ooc_io_wait (&rd))
+                goto oocdone;
+            if (K + 1 < kend)           /* prefetch next L panel */
+                ooc_read (o, &rd, &wr, buf[2 + ((K + 1) & 1)], K + 1,
+                          k0 + nb, n);
+            ooc_swap (l, piv, k0 + wk, ns, k0, nb);
+
+            /* U(K,J) = L(K,K)^-1 A(K,J) (unit lower) */
+            for (i = 1; i < wk; i++)
+                for (p = 0; p < i; p++)
+                    mtrx_kern.axpy (nb, -l[i * nb + p], c + (k0 + p) * nb,
+                                    c + (k0 + i) * nb);
+            /* A(K+1:,J) -= L(K+1:,K) U(K,J) */
+            ooc_upd (c, l, c + k0 * nb, k0, k0 + wk, n, wk, nb);
+        }
+
+        if (w) {                        /* factor panel J, rows j0 -> n */
+            for (i = 0; i < n - j0; i++)
+                rows[i] = c + (j0 + i) * nb;
+            if ((rtn = mtrx_lu_fact_rect (rows, lp, n - j0, w, nb))) {
+                fprintf (stderr, "%s() error: singular matrix.\n", __func__);
+                info = (int)j0 + rtn;
+                goto oocdone;
+            }
+            for (i = 0; i < w; i++) {   /* rows to pointer order */
+                piv[j0 + i] = lp[i] + j0;
+                if (lp[i] != i)
+                    mtrx_kern.swap (nb, c + (j0 + i) * nb,
+                                    c + piv[j0 + i] * nb);
+            }
+            ns = j0 + w;
+        }
+
+        if (ooc_io_wait (&wr))
+            goto oocdone;
+        ooc_io_start (&wr, 1, c, pel, ooc_off (o, J, 0), J);
+    }
+    if (ooc_io_wait (&wr))
+        goto oocdone;
+
+    for (J = n / nb; J < o->np; J++) {  /* Y = L^-1 P B from the panels */
+        const size_t j0 = J * nb;
+
+        ooc_read (o, &rd, &wr, buf[0], J, 0, n);
+        if (ooc_io_wait (&rd))
+            goto oocdone;
+        for (p = j0 < n ? n - j0 : 0; p < nb && j0 + p < o->ncol; p++)
+            for (i = 0; i < n; i++)
+                x[i * nrhs + j0 + p - n] = buf[0][i * nb + p];
+    }
+
+    K = o->npa;                         /* X = U^-1 Y, panels right to left */
+    ooc_read (o, &rd, &wr, buf[2 + ((K - 1) & 1)], K - 1, 0, n);
+    while (K--) {
+        const T *u = buf[2 + (K & 1)];
+        const size_t k0 = K * nb, wk = n - k0 < nb ? n - k0 : nb;
+        T *xk = x + k0 * nrhs;
+
+        if (ooc_io_wait (&rd))
+            goto oocdone;
+        if (K)                          /* prefetch U of next panel */
+            ooc_read (o, &rd, &wr, buf[2 + ((K - 1) & 1)], K - 1, 0, k0);
+
+        i = wk;                         /* X(K) = U(K,K)^-1 Y(K) */
+        while (i--) {
+            const T *ui = u + (k0 + i) * nb;
+            for (p = i + 1; p < wk; p++)
+                mtrx_kern.axpy (nrhs, -ui[p], xk + p * nrhs, xk + i * nrhs);
+            mtrx_kern.scal (nrhs, 1.0 / ui[i], xk + i * nrhs);
+        }
+        for (i = 0; i < k0; i++) {      /* Y(0:K) -= U(0:K,K) X(K) */
+            const T *ui = u + i * nb;
+            if (nrhs == 1)
+                x[i] -= mtrx_kern.dot (wk, ui, xk);
+            else
+                for (p = 0; p < wk; p++)
+                    mtrx_kern.axpy (nrhs, -ui[p], xk + p * nrhs,
+                                    x + i * nrhs);
+        }
+    }
+    info = 0;
+    oocdone:;
+
+    ooc_io_wait (&rd);                  /* no transfer left running */
+    ooc_io_wait (&wr);
+    if (info == -1 && (rd.err || wr.err))
+        fprintf (stderr, "%s() error: scratch file i/o failed.\n", __func__);
+
+    free (lp);
+    free (piv);
+    free (rows);
+    for (i = 0; i < 4; i++)
+        free (buf[i]);
+
+    return info;
+}
+
+/* parse the values of line buf into *row (grown while max is 0, else
+ * max values are stored), returns the number of values on the line.
+ */
+static size_t ooc_parse (char *buf, T **row, size_t *cap, const size_t max)
+{
+    char *nptr = buf, *endptr;
+    size_t nv = 0;
+    T v;
+
+    for (;;) {
+        while (*nptr && !((*nptr >= '0' && *nptr <= '9') ||
+                ((*nptr == '-' || *nptr == '+' || *nptr == '.') &&
+                 ((nptr[1] >= '0' && nptr[1] <= '9') || nptr[1] == '.'))))
+            nptr++;
+        if (!*nptr)
+            break;
+
+        v = strtod (nptr, &endptr);
+        if (nptr == endptr) {           /* e.g. "-.", skip the sign */
+            nptr++;
+            continue;
+        }
+        nptr = endptr;
+
+        if (nv == *cap && !max) {
+            void *tmp = realloc (*row, (*cap ? *cap * 2 : COLSZ) *
+                                 sizeof **row);
+            if (!tmp) {
+                fprintf (stderr, "%s() error: realloc-row.\n", __func__);
+                return 0;
+            }
+            *row = tmp;
+            *cap = *cap ? *cap * 2 : COLSZ;
+        }
+        if (nv < *cap)
+            (*row)[nv] = v;
+        nv++;
+    }
+
+    return nv;
+}
+
+/** mtrx_ooc_solv_file - headless solve of the (n x n+k) system read as
+ *  text from in (any delimiters, one row per line, rows of any length)
+ *  using scratch file path and at most mem bytes (0, OOC_MEM) of matrix
+ *  storage. rows are staged in path.in while n is counted. the (n x k)
+ *  solution is written to out, one row per line at full precision.
+ *  returns as mtrx_ooc_solv().
+ */
+int mtrx_ooc_solv_file (FILE *in, FILE *out, const char *path, size_t mem)
+{
+    char *line = NULL, *spath = malloc (strlen (path) + 4);
+    size_t lcap = 0, cap = 0, n = 0, ncol = 0, nv, rb, i0, r;
+    register size_t i, c;
+    T *row = NULL, *blk = NULL, *x = NULL;
+    FILE *stg = NULL;
+    mtrx_ooc_t *o = NULL;
+    int info = -1;
+
+    if (!spath) {
+        fprintf (stderr, "%s() error: malloc-spath.\n", __func__);
+        return -1;
+    }
+    sprintf (spath, "%s.in", path);
+    if (!(stg = fopen (spath, "w+b"))) {
+        fprintf (stderr, "%s() error: cannot create '%s'.\n", __func__,
+                spath);
+        goto filedone;
+    }
+
+    while (getline (&line, &lcap, in) != -1) {  /* stage rows, count n */
+        if (!(nv = ooc_parse (line, &row, &cap, ncol)))
+            continue;
+        if (!ncol) {
+            ncol = cap = nv;
+            if (!(row = realloc (row, ncol * sizeof *row))) {
+                fprintf (stderr, "%s() error: realloc-row.\n", __func__);
+                goto filedone;
+            }
+        }
+        else if (nv != ncol) {          /* zero-fill short row */
+            fprintf (stderr, "%s() error: column mismatch row[%zu]\n",
+                    __func__, n);
+            for (c = nv; c < ncol; c++)
+                row[c] = 0.0;
+        }
+        if (fwrite (row, sizeof *row, ncol, stg) != ncol) {
+            fprintf (stderr, "%s() error: write '%s' failed.\n", __func__,
+                    spath);
+            goto filedone;
+        }
+        n++;
+    }
+    if (!n || ncol <= n) {
+        fprintf (stderr, "%s() error: invalid system size (cols <= rows)\n",
+                __func__);
+        goto filedone;
+    }
+
+    if (!(o = mtrx_ooc_create (path, n, ncol - n, mem)))
+        goto filedone;
+
+    rb = o->mem / 2 / (ncol * sizeof *blk);     /* rows per block */
+    rb = rb < 1 ? 1 : rb > n ? n : rb;
+    if (!(blk = malloc (rb * ncol * sizeof *blk))) {
+        fprintf (stderr, "%s() error: malloc-blk.\n", __func__);
+        goto filedone;
+    }
+    rewind (stg);
+    for (i0 = 0; i0 < n; i0 += r) {    /* staged rows to panels */
+        r = n - i0 < rb ? n - i0 : rb;
+        if (fread (blk, sizeof *blk, r * ncol, stg) != r * ncol ||
+            mtrx_ooc_set_rows (o, i0, r, blk)) {
+            fprintf (stderr, "%s() error: staging rows failed.\n", __func__);
+            goto filedone;
+        }
+    }
+    free (blk);
+    blk = NULL;
+    fclose (stg);
+    stg = NULL;
+    remove (spath);
+
+    if (!(x = malloc (n * o->nrhs * sizeof *x))) {
+        fprintf (stderr, "%s() error: malloc-x.\n", __func__);
+        goto filedone;
+    }
+    if ((info = mtrx_ooc_solv (o, x)))
+        goto filedone;
+
+    for (i = 0; i < n; i++) {
+        for (c = 0; c < o->nrhs; c++)
+            fprintf (out, c ? " %.17g" : "%.17g", x[i * o->nrhs + c]);
+        fputc ('\n', out);
+    }
+    filedone:;
+
+    if (stg) {
+        fclose (stg);
+        remove (spath);
+    }
+    mtrx_ooc_free (o);
+    free (x);
+    free (blk);
+    free (row);
+    free (line);
+    free (spath);
+
+    return info;
+}
+
+#else   /* no pread/pwrite */
+
+mtrx_ooc_t *mtrx_ooc_create (const char *path, const size_t n,
+                             const size_t nrhs, size_t mem)
+{
+    (void)path;
+    (void)n;
+    (void)nrhs;
+    (void)mem;
+    fprintf (stderr, "%s() error: out-of-core solver not available.\n",
+            __func__);
+
+    return NULL;
+}
+
+void mtrx_ooc_free (mtrx_ooc_t *o)
+{
+    (void)o;
+}
+
+int mtrx_ooc_set_rows (mtrx_ooc_t *o, const size_t i0, const size_t nr,
+                       const T *rows)
+{
+    (void)o;
+    (void)i0;
+    (void)nr;
+    (void)rows;
+
+    return -1;
+}
+
+int mtrx_ooc_solv (mtrx_ooc_t *o, T *x)
+{
+    (void)o;
+    (void)x;
+
+    return -1;
+}
+
+int mtrx_ooc_solv_file (FILE *in, FILE *out, const char *path, size_t mem)
+{
+    (void)in;
+    (void)out;
+    (void)path;
+    (void)mem;
+    fprintf (stderr, "%s() error: out-of-core solver not available.\n",
+            __func__);
+
+    return -1;
+}
+
+#endif
@@ -0,0 +1,414 @@
+#include <float.h>
+
+#include "mtrx_qr.h"
+#include "mtrx_gemm.h"
+#include "mtrx_thrd.h"
+#include "mtrx_simd.h"
+
+/* sum of squares s over or underflowed (zero included, squares of tiny
+ * nonzero elements flush to it)
+ */
+static int qr_range (const T s)
+{
+    return !isfinite (s) || s < DBL_MIN;
+}
+
+typedef struct {        /* unblocked QR of the panel of a at (k0, k0) */
+    T **a, *tau;
+    T *p;               /* (mp x kb) copy of the panel, cols contiguous */
+    T *part;            /* two buffers of (nchk x kb) chunk sums */
+    size_t k0, mp, kb, nchk;
+    int nthrd, info;
+    bar_t bar;
+} qr_sh_t;
+
+typedef struct {
+    qr_sh_t *s;
+    int id;
+} qr_thd_t;
+
+/* reflector H = I - tau v v^T with H x = beta e1 for the n elements of
+ * x (LAPACK dlarfg), v (v[0] = 1 implied) being x below x[0] times the
+ * returned factor (0 when H = I, beta then x[0]). s is the sum of squares
+ * of x below x[0], recomputed scaled by max |x| if out of range. x is
+ * only read.
+ */
+static T qr_house (const T *x, const size_t n, T s, T *tau, T *beta)
+{
+    T alpha = x[0], xmax, r, xnorm;
+    register size_t i;
+
+    if (n > 1 && qr_range (s)) {
+        xmax = fabs (x[1 + mtrx_kern.iamax (n - 1, x + 1, NULL)]);
+        r = xmax > 0.0 ? 1.0 / xmax : 0.0;
+        for (s = 0.0, i = 1; i < n; i++)
+            s += (x[i] * r) * (x[i] * r);
+        xnorm = xmax * sqrt (s);
+    }
+    else
+        xnorm = sqrt (s);
+
+    if (n < 2 || xnorm == 0.0) {        /* already reduced, H = I */
+        *tau = 0.0;
+        *beta = alpha;
+        return 0.0;
+    }
+
+    *beta = -copysign (hypot (alpha, xnorm), alpha);
+    *tau = (*beta - alpha) / *beta;
+
+    return 1.0 / (alpha - *beta);
+}
+
+/* rows lo -> hi of chunk c of the panel, from row r0 at the earliest */
+static void qr_rows (const qr_sh_t *s, const size_t c, const size_t r0,
+                     size_t *lo, size_t *hi)
+{
+    *lo = c * QR_MC;
+    *hi = *lo + QR_MC < s->mp ? *lo + QR_MC : s->mp;
+    if (*lo < r0)
+        *lo = r0 < *hi ? r0 : *hi;
+}
+
+/* sums of chunk c for col j from row r0, out[0] = x^T x and out[k] = x^T
+ * col k for the cols k right of j (zero where the chunk ends above r0).
+ */
+static void qr_sums (const qr_sh_t *s, const size_t c, const size_t j,
+                     const size_t r0, T *out)
+{
+    const T *x = s->p + j * s->mp;
+    size_t lo, hi, k;
+
+    qr_rows (s, c, r0, &lo, &hi);
+    out[0] = mtrx_kern.dot (hi - lo, x + lo, x + lo);
+    for (k = j + 1; k < s->kb; k++)
+        out[k] = mtrx_kern.dot (hi - lo, x + lo, s->p + k * s->mp + lo);
+}
+
+/* wait for the chunk sums in b, then add them in chunk order into out */
+static void qr_red (qr_sh_t *s, const T *b, T *out)
+{
+    register size_t c, k;
+
+    bar_wait (&s->bar);
+    for (k = 0; k < s->kb; k++)
+        out[k] = 0.0;
+    for (c = 0; c < s->nchk; c++)
+        for (k = 0; k < s->kb; k++)
+            out[k] += b[c * s->kb + k];
+}
+
+/* row j of R, written once no thread reads it */
+static void qr_row (qr_sh_t *s, const size_t j, const T beta, const T *w)
+{
+    register size_t k;
+
+    s->p[j * s->mp + j] = beta;
+    for (k = j + 1; k < s->kb; k++)
+        s->p[k * s->mp + j] -= w[k];
+}
+
+/* each thread takes chunks id, id + nthrd, ... of QR_MC rows. per
+ * reflector the sums of its col are reduced in chunk order (identical in
+ * every thread, so each forms the same reflector and w = tau v^T C from
+ * x^T C), then one pass over the chunk scales v, updates C -= v w and
+ * takes the sums of the next col while the chunk is in cache. sums out
+ * of range are redone from the scaled v.
+ */
+static void *qr_unb_run (void *arg)
+{
+    qr_thd_t *t = arg;
+    qr_sh_t *s = t->s;
+    const size_t mp = s->mp, kb = s->kb;
+    T *b = s->part, *bn = s->part + s->nchk * kb, *bt, *x;
+    T u[QR_NBMIN], w[QR_NBMIN], tau, beta = 0.0, r;
+    register size_t i, k;
+    size_t c, j, lo, hi;
+    int redo;
+
+    bar_wait (&s->bar);                 /* thread count final */
+    for (c = t->id; c < s->nchk; c += s->nthrd) {  /* copy in, col 0 */
+        qr_rows (s, c, 0, &lo, &hi);
+        for (i = lo; i < hi; i++)
+            for (k = 0; k < kb; k++)
+                s->p[k * mp + i] = s->a[s->k0 + i][s->k0 + k];
+        qr_sums (s, c, 0, 1, b + c * kb);
+    }
+
+    for (j = 0; j < kb; j++) {
+        x = s->p + j * mp;
+        qr_red (s, b, u);
+        if (!t->id && j)
+            qr_row (s, j - 1, beta, w);
+
+        redo = qr_range (u[0]);
+        r = qr_house (x + j, mp - j, u[0], &tau, &beta);
+        if (!t->id) {
+            s->tau[j] = tau;
+            if (beta == 0.0 && !s->info)
+                s->info = (int)j + 1;
+        }
+
+        if (redo) {                     /* x^T C from the scaled v */
+            bar_wait (&s->bar);
+            for (c = t->id; c < s->nchk; c += s->nthrd) {
+                qr_rows (s, c, j + 1, &lo, &hi);
+                mtrx_kern.scal (hi - lo, r, x + lo);
+                qr_sums (s, c, j, j + 1, bn + c * kb);
+            }
+            qr_red (s, bn, u);
+            bt = b, b = bn, bn = bt;
+            r = 1.0;
+        }
+
+        for (k = j + 1; k < kb; k++)
+            w[k] = tau * (s->p[k * mp + j] + r * u[k]);
+
+        for (c = t->id; c < s->nchk; c += s->nthrd) {
+            qr_rows (s, c, j + 1, &lo, &hi);
+            if (!redo)
+                mtrx_kern.scal (hi - lo, r, x + lo);
+            for (k = j + 1; k < kb; k++)
+                mtrx_kern.axpy (hi - lo, -w[k], x + lo, s->p + k * mp + lo);
+            if (j + 1 < kb)
+                qr_sums (s, c, j + 1, j + 2, bn + c * kb);
+        }
+        bt = b, b = bn, bn = bt;
+    }
+
+    bar_wait (&s->bar);                 /* last row of R, then copy out */
+    if (!t->id)
+        qr_row (s, kb - 1, beta, w);
+    bar_wait (&s->bar);
+    for (c = t->id; c < s->nchk; c += s->nthrd) {
+        qr_rows (s, c, 0, &lo, &hi);
+        for (i = lo; i < hi; i++)
+            for (k = 0; k < kb; k++)
+                s->a[s->k0 + i][s->k0 + k] = s->p[k * mp + i];
+    }
+
+    return NULL;
+}
+
+/* unblocked QR of cols k0 -> k0+kb of a over rows k0 -> m-1. the panel
+ * is copied to contiguous cols so each reflector is formed and applied by
+ * the dot, scal and axpy kernels, QR_MC row chunks dealt to threads. the
+ * chunks depend on m alone, so results do not depend on the number of
+ * threads. returns k + 1 for the first zero R[k][k], 0 otherwise, -1 on
+ * allocation failure.
+ */
+static int qr_unb (T **a, T *tau, const size_t k0, const size_t kb,
+                   const size_t m)
+{
+    qr_sh_t s;
+    qr_thd_t thd[MTRX_THRD_MAX];
+    pthread_t tid[MTRX_THRD_MAX];
+    int nt = mtrx_nthrd_get(), i, rtn = -1;
+
+    s.a = a;
+    s.tau = tau + k0;
+    s.k0 = k0;
+    s.mp = m - k0;
+    s.kb = kb;
+    s.nchk = (s.mp + QR_MC - 1) / QR_MC;
+    s.info = 0;
+    s.part = NULL;
+
+    if (!(s.p = malloc (s.mp * kb * sizeof *s.p)) ||
+        !(s.part = malloc (2 * s.nchk * kb * sizeof *s.part))) {
+        fprintf (stderr, "%s() error: malloc-p.\n", __func__);
+        goto unbfree;
+    }
+
+    if ((size_t)nt > s.nchk)
+        nt = (int)s.nchk;
+    if (bar_init (&s.bar, nt)) {
+        fprintf (stderr, "%s() error: barrier init.\n", __func__);
+        goto unbfree;
+    }
+    s.nthrd = nt;
+
+    for (i = 0; i < nt; i++) {
+        thd[i].s = &s;
+        thd[i].id = i;
+        if (i && pthread_create (&tid[i], NULL, qr_unb_run, &thd[i]))
+            break;
+    }
+    s.nthrd = i;
+    bar_setcount (&s.bar, i);
+
+    qr_unb_run (&thd[0]);       /* calling thread takes chunks 0, nt, ... */
+
+    for (i = 1; i < s.nthrd; i++)
+        pthread_join (tid[i], NULL);
+    bar_destroy (&s.bar);
+    rtn = s.info ? s.info + (int)k0 : 0;
+
+    unbfree:;
+    free (s.part);
+    free (s.p);
+
+    return rtn;
+}
+
+/* C = Q^T C for the reflectors k0 -> ke-1 of a (rows k0 -> m-1) and C
+ * cols ke -> c1, Q = I - V T V^T (compact WY, LAPACK dlarft/dlarfb). V is
+ * split as the unit lower (kb x kb) V1 in rows k0 -> ke-1, computed
+ * directly, and V2 in rows ke -> m-1 used in place. C follows V, so G =
+ * V^T V and W = V^T C are one mtrx_gemm_tn() pass V2^T [V2 C2] into the
+ * rows [G W], then C -= V (T^T W) by mtrx_gemm(). returns 0 on success,
+ * -1 on allocation failure.
+ */
+static int qr_apply (T **a, const T *tau, const size_t k0, const size_t kb,
+                     const size_t m, const size_t c1)
+{
+    const size_t ke = k0 + kb, nc = c1 - ke, ld = kb + nc;
+    register size_t i, p;
+    size_t q;
+    T *s, **t;
+
+    if (!kb || !nc)
+        return 0;
+
+    if (!(s = malloc (kb * ld * sizeof *s + kb * sizeof *t))) {
+        fprintf (stderr, "%s() error: malloc-s.\n", __func__);
+        return -1;
+    }
+    t = (T **)(s + kb * ld);
+    for (i = 0; i < kb; i++)            /* row i: G[i] then W[i] */
+        t[i] = s + i * ld;
+
+    for (p = 0; p < kb; p++) {          /* V1^T [V1 C1], G above diagonal */
+        for (q = 0; q < kb; q++) {
+            t[p][q] = 0.0;
+            if (q > p) {
+                t[p][q] = a[k0 + q][k0 + p];
+                for (i = q + 1; i < kb; i++)
+                    t[p][q] += a[k0 + i][k0 + p] * a[k0 + i][k0 + q];
+            }
+        }
+        memcpy (t[p] + kb, a[k0 + p] + ke, nc * sizeof *s);
+        for (i = p + 1; i < kb; i++)
+            mtrx_kern.axpy (nc, a[k0 + i][k0 + p], a[k0 + i] + ke,
+                            t[p] + kb);
+    }
+    if (m > ke)                         /* += V2^T [V2 C2] */
+        mtrx_gemm_tn (kb, ld, m - ke, 1.0, a + ke, k0, a + ke, k0,
+                      1.0, t, 0);
+
+    for (q = 0; q < kb; q++) {          /* T col q in place of G col q */
+        for (p = 0; p < q; p++) {       /* -tau T[0:q][0:q] G[0:q][q] */
+            T sum = 0.0;
+            for (i = p; i < q; i++)
+                sum += t[p][i] * t[i][q];
+            t[p][q] = -tau[k0 + q] * sum;
+        }
+        t[q][q] = tau[k0 + q];
+    }
+
+    for (p = kb; p-- > 0;) {            /* W = T^T W, from the last row */
+        mtrx_kern.scal (nc, t[p][p], t[p] + kb);
+        for (q = 0; q < p; q++)
+            mtrx_kern.axpy (nc, t[q][p], t[q] + kb, t[p] + kb);
+    }
+
+    for (i = 0; i < kb; i++) {          /* C1 -= V1 W */
+        mtrx_kern.axpy (nc, -1.0, t[i] + kb, a[k0 + i] + ke);
+        for (p = 0; p < i; p++)
+            mtrx_kern.axpy (nc, -a[k0 + i][k0 + p], t[p] + kb,
+                            a[k0 + i] + ke);
+    }
+    if (m > ke)                         /* C2 -= V2 W */
+        mtrx_gemm (m - ke, nc, kb, -1.0, a + ke, k0, t, kb, 1.0, a + ke, ke);
+
+    free (s);
+
+    return 0;
+}
+
+/* QR of the panel cols k0 -> k0+kb of a, halves factored in turn to the
+ * QR_NBMIN col base case, the left half applied to the right by
+ * qr_apply(). returns as mtrx_qr_fact().
+ */
+static int qr_panel (T **a, T *tau, const size_t k0, const size_t kb,
+                     const size_t m)
+{
+    const size_t h = kb / 2;
+    int info, info2;
+
+    if (kb <= QR_NBMIN)
+        return qr_unb (a, tau, k0, kb, m);
+
+    if ((info = qr_panel (a, tau, k0, h, m)) < 0 ||
+        qr_apply (a, tau, k0, h, m, k0 + kb) ||
+        (info2 = qr_panel (a, tau, k0 + h, kb - h, m)) < 0)
+        return -1;
+
+    return info ? info : info2;
+}
+
+/** mtrx_qr_fact - blocked Householder QR of the (m x n) block of a, Q^T
+ *  applied to cols n -> ncol-1, QR_NB col panels with compact WY updates
+ *  of the trailing cols. returns 0 on success, -1 on allocation failure,
+ *  k + 1 if R[k][k] is exactly zero.
+ */
+int mtrx_qr_fact (T **a, T *tau, const size_t m, const size_t n,
+                  const size_t ncol)
+{
+    size_t k0, kb;
+    int info = 0, r;
+
+    for (k0 = 0; k0 < n; k0 += QR_NB) {
+        kb = n - k0 < QR_NB ? n - k0 : QR_NB;
+        if ((r = qr_panel (a, tau, k0, kb, m)) < 0)
+            return -1;
+        if (r && !info)
+            info = r;
+        if (qr_apply (a, tau, k0, kb, m, ncol))
+            return -1;
+    }
+
+    return info;
+}
+
+/** mtrx_solv_ls - least-squares solution of the (m x n+k) system in a by
+ *  mtrx_qr_fact() and back substitution with R. on return rows 0 -> n-1
+ *  of the last k cols hold the solution, rows n -> m-1 the residual in
+ *  Q. returns 0 on success, -1 on invalid size or allocation failure,
+ *  k + 1 if R[k][k] is exactly zero.
+ */
+int mtrx_solv_ls (T **a, const size_t m, const size_t n, const size_t nrhs)
+{
+    T *tau;
+    register size_t i, p;
+    int info;
+
+    if (!n || m < n || !nrhs) {
+        fprintf (stderr, "%s() error: invalid size (%zu x %zu+%zu).\n",
+                __func__, m, n, nrhs);
+        return -1;
+    }
+
+    if (!(tau = malloc (n * sizeof *tau))) {
+        fprintf (stderr, "%s() error: malloc-tau.\n", __func__);
+        return -1;
+    }
+
+    if ((info = mtrx_qr_fact (a, tau, m, n, n + nrhs))) {
+        if (info > 0)
+            fprintf (stderr, "%s() error: rank deficient, R[%d][%d] = 0.\n",
+                    __func__, info - 1, info - 1);
+        goto lsdone;
+    }
+
+    for (i = n; i-- > 0;) {             /* R x = (Q^T b)[0:n] */
+        for (p = i + 1; p < n; p++)
+            mtrx_kern.axpy (nrhs, -a[i][p], a[p] + n, a[i] + n);
+        mtrx_kern.scal (nrhs, 1.0 / a[i][i], a[i] + n);
+    }
+
+    lsdone:;
+    free (tau);
+
+    return info;
+}
@@ -0,0 +1,884 @@
+#include <pthread.h>
+
+#include "mtrx_simd.h"
+
+/* -Ofast enables -ffp-contract=fast, and avx512f implies FMA, keep
+ * mul + add separate so every isa rounds identically to the scalar loop.
+ * (and keep the dot product partial sums in the order written)
+ */
+#ifdef __GNUC__
+# pragma GCC optimize ("fp-contract=off", "no-associative-math")
+#endif
+
+#if (defined (__x86_64__) || defined (__i386__)) && defined (__GNUC__)
+# define HAVE_X86_SIMD 1
+# include <immintrin.h>
+#endif
+
+/*
+ * generic C kernels
+ */
+static void scal_c (const size_t n, const T alpha, T *x)
+{
+    register size_t i;
+
+    for (i = 0; i < n; i++)
+        x[i] *= alpha;
+}
+
+static void axpy_c (const size_t n, const T alpha, const T *x, T *y)
+{
+    register size_t i;
+
+    for (i = 0; i < n; i++)
+        y[i] += alpha * x[i];
+}
+
+static void axpy4_c (const size_t n, const T *alpha, const T * const *x,
+                     T *y)
+{
+    register size_t i;
+
+    for (i = 0; i < n; i++) {
+        T t = y[i];
+        t += alpha[0] * x[0][i];
+        t += alpha[1] * x[1][i];
+        t += alpha[2] * x[2][i];
+        t += alpha[3] * x[3][i];
+        y[i] = t;
+    }
+}
+
+static void gemm_c (const size_t k, const T *a, const T *b, T * const *c)
+{
+    T t[GEMM_MR][GEMM_NR];
+    register size_t i, j, p;
+
+    for (i = 0; i < GEMM_MR; i++)
+        for (j = 0; j < GEMM_NR; j++)
+            t[i][j] = c[i][j];
+
+    for (p = 0; p < k; p++, a += GEMM_MR, b += GEMM_NR)
+        for (i = 0; i < GEMM_MR; i++)
+            for (j = 0; j < GEMM_NR; j++)
+                t[i][j] += a[i] * b[j];
+
+    for (i = 0; i < GEMM_MR; i++)
+        for (j = 0; j < GEMM_NR; j++)
+            c[i][j] = t[i][j];
+}
+
+static void trans_c (T * const *x, const size_t jx, T * const *y,
+                     const size_t jy)
+{
+    register size_t i, j;
+
+    for (i = 0; i < TRANS_NR; i++)
+        for (j = 0; j < TRANS_NR; j++)
+            y[j][jy + i] = x[i][jx + j];
+}
+
+static void swap_c (const size_t n, T *x, T *y)
+{
+    register size_t i;
+
+    for (i = 0; i < n; i++) {
+        T tmp = x[i];
+        x[i] = y[i];
+        y[i] = tmp;
+    }
+}
+
+/* scalar tail shared by all iamax kernels, continues from i with best */
+static size_t iamax_tail (size_t i, const size_t n, const T *x, const T *msk,
+                            T big, size_t idx)
+{
+    for (; i < n; i++)
+        if ((!msk || msk[i] != 0.0) && fabs (x[i]) >= big) {
+            big = fabs (x[i]);
+            idx = i;
+        }
+
+    return idx;
+}
+
+static size_t iamax_c (const size_t n, const T *x, const T *msk)
+{
+    return iamax_tail (0, n, x, msk, 0.0, n);
+}
+
+/* dot products keep 8 partial sums, p[j] over i % 8 == j for the first
+ * n - n % 8 elements, folded in a fixed order before adding the tail, so
+ * every isa returns the identical sum.
+ */
+static T dot_fold (const T *p, size_t i, const size_t n,
+                    const T *x, const T *y)
+{
+    T sum = ((p[0] + p[1]) + (p[2] + p[3])) + ((p[4] + p[5]) + (p[6] + p[7]));
+
+    for (; i < n; i++)
+        sum += x[i] * y[i];
+
+    return sum;
+}
+
+static T dot_c (const size_t n, const T *x, const T *y)
+{
+    T p[8] = { 0.0 };
+    size_t i = 0, j;
+
+    for (; i + 8 <= n; i += 8)
+        for (j = 0; j < 8; j++)
+            p[j] += x[i + j] * y[i + j];
+
+    return dot_fold (p, i, n, x, y);
+}
+
+static void saxpy_c (const size_t n, const float alpha, const float *x,
+                     float *y)
+{
+    register size_t i;
+
+    for (i = 0; i < n; i++)
+        y[i] += alpha * x[i];
+}
+
+#ifdef HAVE_X86_SIMD
+/*
+ * SSE2 kernels (2 x double)
+ */
+__attribute__ ((target ("sse2")))
+static void scal_sse2 (const size_t n, const T alpha, T *x)
+{
+    size_t i = 0;
+    __m128d va = _mm_set1_pd (alpha);
+
+    for (; i + 2 <= n; i += 2)
+        _mm_storeu_pd (x + i, _mm_mul_pd (_mm_loadu_pd (x + i), va));
+    for (; i < n; i++)
+        x[i] *= alpha;
+}
+
+__attribute__ ((target ("sse2")))
+static void axpy_sse2 (const size_t n, const T alpha, const T *x, T *y)
+{
+    size_t i = 0;
+    __m128d va = _mm_set1_pd (alpha);
+
+    for (; i + 4 <= n; i += 4) {
+        __m128d y0 = _mm_loadu_pd (y + i), y1 = _mm_loadu_pd (y + i + 2);
+        y0 = _mm_add_pd (y0, _mm_mul_pd (va, _mm_loadu_pd (x + i)));
+        y1 = _mm_add_pd (y1, _mm_mul_pd (va, _mm_loadu_pd (x + i + 2)));
+        _mm_storeu_pd (y + i, y0);
+        _mm_storeu_pd (y + i + 2, y1);
+    }
+    for (; i < n; i++)
+        y[i] += alpha * x[i];
+}
+
+__attribute__ ((target ("sse2")))
+static void axpy4_sse2 (const size_t n, const T *alpha, const T * const *x,
+                        T *y)
+{
+    size_t i = 0;
+    __m128d a0 = _mm_set1_pd (alpha[0]), a1 = _mm_set1_pd (alpha[1]),
+            a2 = _mm_set1_pd (alpha[2]), a3 = _mm_set1_pd (alpha[3]);
+
+    for (; i + 2 <= n; i += 2) {
+        __m128d y0 = _mm_loadu_pd (y + i);
+        y0 = _mm_add_pd (y0, _mm_mul_pd (a0, _mm_loadu_pd (x[0] + i)));
+        y0 = _mm_add_pd (y0, _mm_mul_pd (a1, _mm_loadu_pd (x[1] + i)));
+        y0 = _mm_add_pd (y0, _mm_mul_pd (a2, _mm_loadu_pd (x[2] + i)));
+        y0 = _mm_add_pd (y0, _mm_mul_pd (a3, _mm_loadu_pd (x[3] + i)));
+        _mm_storeu_pd (y + i, y0);
+    }
+    if (i < n)
+        axpy4_c (n - i, alpha, (const T * const []){ x[0] + i, x[1] + i,
+                 x[2] + i, x[3] + i }, y + i);
+}
+
+/* two (GEMM_MR x 4) halves, 12 accumulators each */
+__attribute__ ((target ("sse2")))
+static void gemm_sse2 (const size_t k, const T *a, const T *b, T * const *c)
+{
+    size_t h, i, p;
+
+    for (h = 0; h < GEMM_NR; h += 4) {
+        __m128d c0[GEMM_MR], c1[GEMM_MR];
+        const T *ap = a, *bp = b + h;
+
+        for (i = 0; i < GEMM_MR; i++) {
+            c0[i] = _mm_loadu_pd (c[i] + h);
+            c1[i] = _mm_loadu_pd (c[i] + h + 2);
+        }
+        for (p = 0; p < k; p++, ap += GEMM_MR, bp += GEMM_NR) {
+            __m128d b0 = _mm_loadu_pd (bp), b1 = _mm_loadu_pd (bp + 2);
+
+            for (i = 0; i < GEMM_MR; i++) {
+                __m128d ai = _mm_set1_pd (ap[i]);
+                c0[i] = _mm_add_pd (c0[i], _mm_mul_pd (ai, b0));
+                c1[i] = _mm_add_pd (c1[i], _mm_mul_pd (ai, b1));
+            }
+        }
+        for (i = 0; i < GEMM_MR; i++) {
+            _mm_storeu_pd (c[i] + h, c0[i]);
+            _mm_storeu_pd (c[i] + h + 2, c1[i]);
+        }
+    }
+}
+
+/* (2 x 2) blocks by unpack */
+__attribute__ ((target ("sse2")))
+static void trans_sse2 (T * const *x, const size_t jx, T * const *y,
+                        const size_t jy)
+{
+    size_t i, j;
+
+    for (i = 0; i < TRANS_NR; i += 2)
+        for (j = 0; j < TRANS_NR; j += 2) {
+            __m128d x0 = _mm_loadu_pd (x[i] + jx + j),
+                    x1 = _mm_loadu_pd (x[i + 1] + jx + j);
+            _mm_storeu_pd (y[j] + jy + i, _mm_unpacklo_pd (x0, x1));
+            _mm_storeu_pd (y[j + 1] + jy + i, _mm_unpackhi_pd (x0, x1));
+        }
+}
+
+__attribute__ ((target ("sse2")))
+static void swap_sse2 (const size_t n, T *x, T *y)
+{
+    size_t i = 0;
+
+    for (; i + 2 <= n; i += 2) {
+        __m128d vx = _mm_loadu_pd (x + i), vy = _mm_loadu_pd (y + i);
+        _mm_storeu_pd (x + i, vy);
+        _mm_storeu_pd (y + i, vx);
+    }
+    for (; i < n; i++) {
+        T tmp = x[i];
+        x[i] = y[i];
+        y[i] = tmp;
+    }
+}
+
+/* lanes track their own max and index, >= keeps the last index per lane,
+ * masked out elements get key -2 which never beats the initial -1.
+ */
+__attribute__ ((target ("sse2")))
+static size_t iamax_sse2 (const size_t n, const T *x, const T *msk)
+{
+    size_t i = 0, j, idx = n;
+    T big = -1.0, vbuf[2], ibuf[2];
+    __m128d sign = _mm_set1_pd (-0.0), zero = _mm_setzero_pd(),
+            excl = _mm_set1_pd (-2.0), vmax = _mm_set1_pd (-1.0),
+            vidx = _mm_setzero_pd(), vi = _mm_set_pd (1.0, 0.0),
+            step = _mm_set1_pd (2.0);
+
+    for (; i + 2 <= n; i += 2) {
+        __m128d key = _mm_andnot_pd (sign, _mm_loadu_pd (x + i)), ge;
+        if (msk) {
+            __m128d sel = _mm_cmpneq_pd (_mm_loadu_pd (msk + i), zero);
+            key = _mm_or_pd (_mm_and_pd (sel, key), _mm_andnot_pd (sel, excl));
+        }
+        ge = _mm_cmpge_pd (key, vmax);
+        vmax = _mm_or_pd (_mm_and_pd (ge, key), _mm_andnot_pd (ge, vmax));
+        vidx = _mm_or_pd (_mm_and_pd (ge, vi), _mm_andnot_pd (ge, vidx));
+        vi = _mm_add_pd (vi, step);
+    }
+    _mm_storeu_pd (vbuf, vmax);
+    _mm_storeu_pd (ibuf, vidx);
+    for (j = 0; j < 2; j++)
+        if (vbuf[j] > big || (vbuf[j] == big && vbuf[j] >= 0.0 &&
+                                (size_t)ibuf[j] > idx)) {
+            big = vbuf[j];
+            idx = (size_t)ibuf[j];
+        }
+    if (big < 0.0) {        /* nothing selected in vector part */
+        big = 0.0;
+        idx = n;
+    }
+
+    return iamax_tail (i, n, x, msk, big, idx);
+}
+
+__attribute__ ((target ("sse2")))
+static T dot_sse2 (const size_t n, const T *x, const T *y)
+{
+    size_t i = 0;
+    T p[8];
+    __m128d s0 = _mm_setzero_pd(), s1 = _mm_setzero_pd(),
+            s2 = _mm_setzero_pd(), s3 = _mm_setzero_pd();
+
+    for (; i + 8 <= n; i += 8) {
+        s0 = _mm_add_pd (s0, _mm_mul_pd (_mm_loadu_pd (x + i),
+                                        _mm_loadu_pd (y + i)));
+        s1 = _mm_add_pd (s1, _mm_mul_pd (_mm_loadu_pd (x + i + 2),
+                                        _mm_loadu_pd (y + i + 2)));
+        s2 = _mm_add_pd (s2, _mm_mul_pd (_mm_loadu_pd (x + i + 4),
+                                        _mm_loadu_pd (y + i + 4)));
+        s3 = _mm_add_pd (s3, _mm_mul_pd (_mm_loadu_pd (x + i + 6),
+                                        _mm_loadu_pd (y + i + 6)));
+    }
+    _mm_storeu_pd (p, s0);
+    _mm_storeu_pd (p + 2, s1);
+    _mm_storeu_pd (p + 4, s2);
+    _mm_storeu_pd (p + 6, s3);
+
+    return dot_fold (p, i, n, x, y);
+}
+
+__attribute__ ((target ("sse2")))
+static void saxpy_sse2 (const size_t n, const float alpha, const float *x,
+                        float *y)
+{
+    size_t i = 0;
+    __m128 va = _mm_set1_ps (alpha);
+
+    for (; i + 8 <= n; i += 8) {
+        __m128 y0 = _mm_loadu_ps (y + i), y1 = _mm_loadu_ps (y + i + 4);
+        y0 = _mm_add_ps (y0, _mm_mul_ps (va, _mm_loadu_ps (x + i)));
+        y1 = _mm_add_ps (y1, _mm_mul_ps (va, _mm_loadu_ps (x + i + 4)));
+        _mm_storeu_ps (y + i, y0);
+        _mm_storeu_ps (y + i + 4, y1);
+    }
+    for (; i < n; i++)
+        y[i] += alpha * x[i];
+}
+
+/*
+ * AVX2 kernels (4 x double)
+ */
+__attribute__ ((target ("avx2")))
+static void scal_avx2 (const size_t n, const T alpha, T *x)
+{
+    size_t i = 0;
+    __m256d va = _mm256_set1_pd (alpha);
+
+    for (; i + 4 <= n; i += 4)
+        _mm256_storeu_pd (x + i, _mm256_mul_pd (_mm256_loadu_pd (x + i), va));
+    for (; i < n; i++)
+        x[i] *= alpha;
+}
+
+__attribute__ ((target ("avx2")))
+static void axpy_avx2 (const size_t n, const T alpha, const T *x, T *y)
+{
+    size_t i = 0;
+    __m256d va = _mm256_set1_pd (alpha);
+
+    for (; i + 8 <= n; i += 8) {
+        __m256d y0 = _mm256_loadu_pd (y + i), y1 = _mm256_loadu_pd (y + i + 4);
+        y0 = _mm256_add_pd (y0, _mm256_mul_pd (va, _mm256_loadu_pd (x + i)));
+        y1 = _mm256_add_pd (y1, _mm256_mul_pd (va, _mm256_loadu_pd (x + i + 4)));
+        _mm256_storeu_pd (y + i, y0);
+        _mm256_storeu_pd (y + i + 4, y1);
+    }
+    for (; i < n; i++)
+        y[i] += alpha * x[i];
+}
+
+__attribute__ ((target ("avx2")))
+static void axpy4_avx2 (const size_t n, const T *alpha, const T * const *x,
+                        T *y)
+{
+    size_t i = 0;
+    __m256d a0 = _mm256_set1_pd (alpha[0]), a1 = _mm256_set1_pd (alpha[1]),
+            a2 = _mm256_set1_pd (alpha[2]), a3 = _mm256_set1_pd (alpha[3]);
+
+    for (; i + 4 <= n; i += 4) {
+        __m256d y0 = _mm256_loadu_pd (y + i);
+        y0 = _mm256_add_pd (y0, _mm256_mul_pd (a0, _mm256_loadu_pd (x[0] + i)));
+        y0 = _mm256_add_pd (y0, _mm256_mul_pd (a1, _mm256_loadu_pd (x[1] + i)));
+        y0 = _mm256_add_pd (y0, _mm256_mul_pd (a2, _mm256_loadu_pd (x[2] + i)));
+        y0 = _mm256_add_pd (y0, _mm256_mul_pd (a3, _mm256_loadu_pd (x[3] + i)));
+        _mm256_storeu_pd (y + i, y0);
+    }
+    if (i < n)
+        axpy4_c (n - i, alpha, (const T * const []){ x[0] + i, x[1] + i,
+                 x[2] + i, x[3] + i }, y + i);
+}
+
+__attribute__ ((target ("avx2")))
+static void gemm_avx2 (const size_t k, const T *a, const T *b, T * const *c)
+{
+    __m256d c0[GEMM_MR], c1[GEMM_MR];
+    size_t i, p;
+
+    for (i = 0; i < GEMM_MR; i++) {
+        c0[i] = _mm256_loadu_pd (c[i]);
+        c1[i] = _mm256_loadu_pd (c[i] + 4);
+    }
+    for (p = 0; p < k; p++, a += GEMM_MR, b += GEMM_NR) {
+        __m256d b0 = _mm256_loadu_pd (b), b1 = _mm256_loadu_pd (b + 4);
+
+        for (i = 0; i < GEMM_MR; i++) {
+            __m256d ai = _mm256_broadcast_sd (a + i);
+            c0[i] = _mm256_add_pd (c0[i], _mm256_mul_pd (ai, b0));
+            c1[i] = _mm256_add_pd (c1[i], _mm256_mul_pd (ai, b1));
+        }
+    }
+    for (i = 0; i < GEMM_MR; i++) {
+        _mm256_storeu_pd (c[i], c0[i]);
+        _mm256_storeu_pd (c[i] + 4, c1[i]);
+    }
+}
+
+/* pairs by unpack, then 128-bit halves exchanged (also used for avx512) */
+__attribute__ ((target ("avx2")))
+static void trans_avx2 (T * const *x, const size_t jx, T * const *y,
+                        const size_t jy)
+{
+    __m256d x0 = _mm256_loadu_pd (x[0] + jx), x1 = _mm256_loadu_pd (x[1] + jx),
+            x2 = _mm256_loadu_pd (x[2] + jx), x3 = _mm256_loadu_pd (x[3] + jx),
+            t0 = _mm256_unpacklo_pd (x0, x1), t1 = _mm256_unpackhi_pd (x0, x1),
+            t2 = _mm256_unpacklo_pd (x2, x3), t3 = _mm256_unpackhi_pd (x2, x3);
+
+    _mm256_storeu_pd (y[0] + jy, _mm256_permute2f128_pd (t0, t2, 0x20));
+    _mm256_storeu_pd (y[1] + jy, _mm256_permute2f128_pd (t1, t3, 0x20));
+    _mm256_storeu_pd (y[2] + jy, _mm256_permute2f128_pd (t0, t2, 0x31));
+    _mm256_storeu_pd (y[3] + jy, _mm256_permute2f128_pd (t1, t3, 0x31));
+}
+
+__attribute__ ((target ("avx2")))
+static void swap_avx2 (const size_t n, T *x, T *y)
+{
+    size_t i = 0;
+
+    for (; i + 4 <= n; i += 4) {
+        __m256d vx = _mm256_loadu_pd (x + i), vy = _mm256_loadu_pd (y + i);
+        _mm256_storeu_pd (x + i, vy);
+        _mm256_storeu_pd (y + i, vx);
+    }
+    for (; i < n; i++) {
+        T tmp = x[i];
+        x[i] = y[i];
+        y[i] = tmp;
+    }
+}
+
+__attribute__ ((target ("avx2")))
+static size_t iamax_avx2 (const size_t n, const T *x, const T *msk)
+{
+    size_t i = 0, j, idx = n;
+    T big = -1.0, vbuf[4], ibuf[4];
+    __m256d sign = _mm256_set1_pd (-0.0), zero = _mm256_setzero_pd(),
+            excl = _mm256_set1_pd (-2.0), vmax = _mm256_set1_pd (-1.0),
+            vidx = _mm256_setzero_pd(),
+            vi = _mm256_set_pd (3.0, 2.0, 1.0, 0.0),
+            step = _mm256_set1_pd (4.0);
+
+    for (; i + 4 <= n; i += 4) {
+        __m256d key = _mm256_andnot_pd (sign, _mm256_loadu_pd (x + i)), ge;
+        if (msk) {
+            __m256d sel = _mm256_cmp_pd (_mm256_loadu_pd (msk + i), zero,
+                                        _CMP_NEQ_UQ);
+            key = _mm256_blendv_pd (excl, key, sel);
+        }
+        ge = _mm256_cmp_pd (key, vmax, _CMP_GE_OQ);
+        vmax = _mm256_blendv_pd (vmax, key, ge);
+        vidx = _mm256_blendv_pd (vidx, vi, ge);
+        vi = _mm256_add_pd (vi, step);
+    }
+    _mm256_storeu_pd (vbuf, vmax);
+    _mm256_storeu_pd (ibuf, vidx);
+    for (j = 0; j < 4; j++)
+        if (vbuf[j] > big || (vbuf[j] == big && vbuf[j] >= 0.0 &&
+                                (size_t)ibuf[j] > idx)) {
+            big = vbuf[j];
+            idx = (size_t)ibuf[j];
+        }
+    if (big < 0.0) {
+        big = 0.0;
+        idx = n;
+    }
+
+    return iamax_tail (i, n, x, msk, big, idx);
+}
+
+__attribute__ ((target ("avx2")))
+static T dot_avx2 (const size_t n, const T *x, const T *y)
+{
+    size_t i = 0;
+    T p[8];
+    __m256d s0 = _mm256_setzero_pd(), s1 = _mm256_setzero_pd();
+
+    for (; i + 8 <= n; i += 8) {
+        s0 = _mm256_add_pd (s0, _mm256_mul_pd (_mm256_loadu_pd (x + i),
+                                            _mm256_loadu_pd (y + i)));
+        s1 = _mm256_add_pd (s1, _mm256_mul_pd (_mm256_loadu_pd (x + i + 4),
+                                            _mm256_loadu_pd (y + i + 4)));
+    }
+    _mm256_storeu_pd (p, s0);
+    _mm256_storeu_pd (p + 4, s1);
+
+    return dot_fold (p, i, n, x, y);
+}
+
+__attribute__ ((target ("avx2")))
+static void saxpy_avx2 (const size_t n, const float alpha, const float *x,
+                        float *y)
+{
+    size_t i = 0;
+    __m256 va = _mm256_set1_ps (alpha);
+
+    for (; i + 16 <= n; i += 16) {
+        __m256 y0 = _mm256_loadu_ps (y + i), y1 = _mm256_loadu_ps (y + i + 8);
+        y0 = _mm256_add_ps (y0, _mm256_mul_ps (va, _mm256_loadu_ps (x + i)));
+        y1 = _mm256_add_ps (y1, _mm256_mul_ps (va, _mm256_loadu_ps (x + i + 8)));
+        _mm256_storeu_ps (y + i, y0);
+        _mm256_storeu_ps (y + i + 8, y1);
+    }
+    for (; i < n; i++)
+        y[i] += alpha * x[i];
+}
+
+/*
+ * AVX-512F kernels (8 x double)
+ */
+__attribute__ ((target ("avx512f")))
+static void scal_avx512 (const size_t n, const T alpha, T *x)
+{
+    size_t i = 0;
+    __m512d va = _mm512_set1_pd (alpha);
+
+    for (; i + 8 <= n; i += 8)
+        _mm512_storeu_pd (x + i, _mm512_mul_pd (_mm512_loadu_pd (x + i), va));
+    if (i < n) {
+        __mmask8 k = (__mmask8)((1u << (n - i)) - 1);
+        _mm512_mask_storeu_pd (x + i, k,
+                    _mm512_mul_pd (_mm512_maskz_loadu_pd (k, x + i), va));
+    }
+}
+
+__attribute__ ((target ("avx512f")))
+static void axpy_avx512 (const size_t n, const T alpha, const T *x, T *y)
+{
+    size_t i = 0;
+    __m512d va = _mm512_set1_pd (alpha);
+
+    for (; i + 16 <= n; i += 16) {
+        __m512d y0 = _mm512_loadu_pd (y + i), y1 = _mm512_loadu_pd (y + i + 8);
+        y0 = _mm512_add_pd (y0, _mm512_mul_pd (va, _mm512_loadu_pd (x + i)));
+        y1 = _mm512_add_pd (y1, _mm512_mul_pd (va, _mm512_loadu_pd (x + i + 8)));
+        _mm512_storeu_pd (y + i, y0);
+        _mm512_storeu_pd (y + i + 8, y1);
+    }
+    for (; i + 8 <= n; i += 8) {
+        __m512d y0 = _mm512_loadu_pd (y + i);
+        y0 = _mm512_add_pd (y0, _mm512_mul_pd (va, _mm512_loadu_pd (x + i)));
+        _mm512_storeu_pd (y + i, y0);
+    }
+    if (i < n) {
+        __mmask8 k = (__mmask8)((1u << (n - i)) - 1);
+        __m512d y0 = _mm512_maskz_loadu_pd (k, y + i);
+        y0 = _mm512_add_pd (y0, _mm512_mul_pd (va,
+                                _mm512_maskz_loadu_pd (k, x + i)));
+        _mm512_mask_storeu_pd (y + i, k, y0);
+    }
+}
+
+__attribute__ ((target ("avx512f")))
+static void axpy4_avx512 (const size_t n, const T *alpha, const T * const *x,
+                          T *y)
+{
+    size_t i = 0;
+    __m512d a0 = _mm512_set1_pd (alpha[0]), a1 = _mm512_set1_pd (alpha[1]),
+            a2 = _mm512_set1_pd (alpha[2]), a3 = _mm512_set1_pd (alpha[3]);
+    __mmask8 k = 0xff;
+
+    for (; i < n; i += 8) {
+        __m512d y0;
+
+        if (n - i < 8)
+            k = (__mmask8)((1u << (n - i)) - 1);
+        y0 = _mm512_maskz_loadu_pd (k, y + i);
+        y0 = _mm512_add_pd (y0, _mm512_mul_pd (a0,
+                                _mm512_maskz_loadu_pd (k, x[0] + i)));
+        y0 = _mm512_add_pd (y0, _mm512_mul_pd (a1,
+                                _mm512_maskz_loadu_pd (k, x[1] + i)));
+        y0 = _mm512_add_pd (y0, _mm512_mul_pd (a2,
+                                _mm512_maskz_loadu_pd (k, x[2] + i)));
+        y0 = _mm512_add_pd (y0, _mm512_mul_pd (a3,
+                                _mm512_maskz_loadu_pd (k, x[3] + i)));
+        _mm512_mask_storeu_pd (y + i, k, y0);
+    }
+}
+
+__attribute__ ((target ("avx512f")))
+static void gemm_avx512 (const size_t k, const T *a, const T *b, T * const *c)
+{
+    __m512d c0[GEMM_MR];
+    size_t i, p;
+
+    for (i = 0; i < GEMM_MR; i++)
+        c0[i] = _mm512_loadu_pd (c[i]);
+    for (p = 0; p < k; p++, a += GEMM_MR, b += GEMM_NR) {
+        __m512d b0 = _mm512_loadu_pd (b);
+
+        for (i = 0; i < GEMM_MR; i++)
+            c0[i] = _mm512_add_pd (c0[i], _mm512_mul_pd (_mm512_set1_pd (a[i]),
+                                                         b0));
+    }
+    for (i = 0; i < GEMM_MR; i++)
+        _mm512_storeu_pd (c[i], c0[i]);
+}
+
+__attribute__ ((target ("avx512f")))
+static void swap_avx512 (const size_t n, T *x, T *y)
+{
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8) {
+        __m512d vx = _mm512_loadu_pd (x + i), vy = _mm512_loadu_pd (y + i);
+        _mm512_storeu_pd (x + i, vy);
+        _mm512_storeu_pd (y + i, vx);
+    }
+    if (i < n) {
+        __mmask8 k = (__mmask8)((1u << (n - i)) - 1);
+        __m512d vx = _mm512_maskz_loadu_pd (k, x + i),
+                vy = _mm512_maskz_loadu_pd (k, y + i);
+        _mm512_mask_storeu_pd (x + i, k, vy);
+        _mm512_mask_storeu_pd (y + i, k, vx);
+    }
+}
+
+__attribute__ ((target ("avx512f")))
+static size_t iamax_avx512 (const size_t n, const T *x, const T *msk)
+{
+    size_t i = 0, j, idx = n;
+    T big = -1.0, vbuf[8], ibuf[8];
+    __m512d excl = _mm512_set1_pd (-2.0), vmax = _mm512_set1_pd (-1.0),
+            vidx = _mm512_setzero_pd(),
+            vi = _mm512_set_pd (7.0, 6.0, 5.0, 4.0, 3.0, 2.0, 1.0, 0.0),
+            step = _mm512_set1_pd (8.0);
+
+    for (; i + 8 <= n; i += 8) {
+        __m512d key = _mm512_abs_pd (_mm512_loadu_pd (x + i));
+        __mmask8 ge;
+        if (msk) {
+            __mmask8 sel = _mm512_cmp_pd_mask (_mm512_loadu_pd (msk + i),
+                                    _mm512_setzero_pd(), _CMP_NEQ_UQ);
+            key = _mm512_mask_blend_pd (sel, excl, key);
+        }
+        ge = _mm512_cmp_pd_mask (key, vmax, _CMP_GE_OQ);
+        vmax = _mm512_mask_blend_pd (ge, vmax, key);
+        vidx = _mm512_mask_blend_pd (ge, vidx, vi);
+        vi = _mm512_add_pd (vi, step);
+    }
+    _mm512_storeu_pd (vbuf, vmax);
+    _mm512_storeu_pd (ibuf, vidx);
+    for (j = 0; j < 8; j++)
+        if (vbuf[j] > big || (vbuf[j] == big && vbuf[j] >= 0.0 &&
+                                (size_t)ibuf[j] > idx)) {
+            big = vbuf[j];
+            idx = (size_t)ibuf[j];
+        }
+    if (big < 0.0) {
+        big = 0.0;
+        idx = n;
+    }
+
+    return iamax_tail (i, n, x, msk, big, idx);
+}
+
+__attribute__ ((target ("avx512f")))
+static T dot_avx512 (const size_t n, const T *x, const T *y)
+{
+    size_t i = 0;
+    T p[8];
+    __m512d s0 = _mm512_setzero_pd();
+
+    for (; i + 8 <= n; i += 8)
+        s0 = _mm512_add_pd (s0, _mm512_mul_pd (_mm512_loadu_pd (x + i),
+                                            _mm512_loadu_pd (y + i)));
+    _mm512_storeu_pd (p, s0);
+
+    return dot_fold (p, i, n, x, y);
+}
+
+__attribute__ ((target ("avx512f")))
+static void saxpy_avx512 (const size_t n, const float alpha, const float *x,
+                          float *y)
+{
+    size_t i = 0;
+    __m512 va = _mm512_set1_ps (alpha);
+
+    for (; i + 32 <= n; i += 32) {
+        __m512 y0 = _mm512_loadu_ps (y + i), y1 = _mm512_loadu_ps (y + i + 16);
+        y0 = _mm512_add_ps (y0, _mm512_mul_ps (va, _mm512_loadu_ps (x + i)));
+        y1 = _mm512_add_ps (y1, _mm512_mul_ps (va, _mm512_loadu_ps (x + i + 16)));
+        _mm512_storeu_ps (y + i, y0);
+        _mm512_storeu_ps (y + i + 16, y1);
+    }
+    for (; i + 16 <= n; i += 16) {
+        __m512 y0 = _mm512_loadu_ps (y + i);
+        y0 = _mm512_add_ps (y0, _mm512_mul_ps (va, _mm512_loadu_ps (x + i)));
+        _mm512_storeu_ps (y + i, y0);
+    }
+    if (i < n) {
+        __mmask16 k = (__mmask16)((1u << (n - i)) - 1);
+        __m512 y0 = _mm512_maskz_loadu_ps (k, y + i);
+        y0 = _mm512_add_ps (y0, _mm512_mul_ps (va,
+                                _mm512_maskz_loadu_ps (k, x + i)));
+        _mm512_mask_storeu_ps (y + i, k, y0);
+    }
+}
+#endif
+
+/*
+ * kernel tables and dispatch
+ */
+static const mtrx_kern_t kern_c =
+    { scal_c, axpy_c, swap_c, iamax_c, dot_c, saxpy_c, axpy4_c, gemm_c,
+      trans_c, "generic" };
+#ifdef HAVE_X86_SIMD
+static const mtrx_kern_t kern_sse2 =
+    { scal_sse2, axpy_sse2, swap_sse2, iamax_sse2, dot_sse2, saxpy_sse2,
+      axpy4_sse2, gemm_sse2, trans_sse2, "sse2" };
+static const mtrx_kern_t kern_avx2 =
+    { scal_avx2, axpy_avx2, swap_avx2, iamax_avx2, dot_avx2, saxpy_avx2,
+      axpy4_avx2, gemm_avx2, trans_avx2, "avx2" };
+static const mtrx_kern_t kern_avx512 =
+    { scal_avx512, axpy_avx512, swap_avx512, iamax_avx512, dot_avx512,
+      saxpy_avx512, axpy4_avx512, gemm_avx512, trans_avx2, "avx512" };
+#endif
+
+static pthread_once_t kern_once = PTHREAD_ONCE_INIT;
+
+static void kern_sel (void)
+{
+    mtrx_simd_init();
+}
+
+/* select the table at load time, before any thread can read it. the
+ * first-use stubs below remain for calls made before constructors run.
+ */
+__attribute__ ((constructor))
+static void kern_ctor (void)
+{
+    pthread_once (&kern_once, kern_sel);
+}
+
+/* first-use stubs, select table from CPUID (once, threads calling first
+ * wait for it) then forward the call
+ */
+static void scal_init (const size_t n, const T alpha, T *x)
+{
+    pthread_once (&kern_once, kern_sel);
+    mtrx_kern.scal (n, alpha, x);
+}
+
+static void axpy_init (const size_t n, const T alpha, const T *x, T *y)
+{
+    pthread_once (&kern_once, kern_sel);
+    mtrx_kern.axpy (n, alpha, x, y);
+}
+
+static void swap_init (const size_t n, T *x, T *y)
+{
+    pthread_once (&kern_once, kern_sel);
+    mtrx_kern.swap (n, x, y);
+}
+
+static size_t iamax_init (const size_t n, const T *x, const T *msk)
+{
+    pthread_once (&kern_once, kern_sel);
+    return mtrx_kern.iamax (n, x, msk);
+}
+
+static T dot_init (const size_t n, const T *x, const T *y)
+{
+    pthread_once (&kern_once, kern_sel);
+    return mtrx_kern.dot (n, x, y);
+}
+
+static void saxpy_init (const size_t n, const float alpha, const float *x,
+                        float *y)
+{
+    pthread_once (&kern_once, kern_sel);
+    mtrx_kern.saxpy (n, alpha, x, y);
+}
+
+static void axpy4_init (const size_t n, const T *alpha, const T * const *x,
+                        T *y)
+{
+    pthread_once (&kern_once, kern_sel);
+    mtrx_kern.axpy4 (n, alpha, x, y);
+}
+
+static void gemm_init (const size_t k, const T *a, const T *b, T * const *c)
+{
+    pthread_once (&kern_once, kern_sel);
+    mtrx_kern.gemm (k, a, b, c);
+}
+
+static void trans_init (T * const *x, const size_t jx, T * const *y,
+                        const size_t jy)
+{
+    pthread_once (&kern_once, kern_sel);
+    mtrx_kern.trans (x, jx, y, jy);
+}
+
+mtrx_kern_t mtrx_kern = { scal_init, axpy_init, swap_init, iamax_init,
+                          dot_init, saxpy_init, axpy4_init, gemm_init,
+                          trans_init, NULL };
+
+/* check processor support for isa name, 1 if supported */
+static int isa_supported (const char *isa)
+{
+    if (strcmp (isa, "generic") == 0)
+        return 1;
+#ifdef HAVE_X86_SIMD
+    __builtin_cpu_init();
+    if (strcmp (isa, "sse2") == 0)
+        return __builtin_cpu_supports ("sse2");
+    if (strcmp (isa, "avx2") == 0)
+        return __builtin_cpu_supports ("avx2");
+    if (strcmp (isa, "avx512") == 0)
+        return __builtin_cpu_supports ("avx512f");
+#endif
+    return 0;
+}
+
+/** mtrx_simd_select - select kernels by isa name ("avx512", "avx2",
+ *  "sse2" or "generic"). returns 0 on success, -1 if isa is unknown or
+ *  not supported by the processor (current table is unchanged).
+ */
+int mtrx_simd_select (const char *isa)
+{
+    const mtrx_kern_t *k = NULL;
+
+    if (!isa || !isa_supported (isa))
+        return -1;
+
+    if (strcmp (isa, "generic") == 0)
+        k = &kern_c;
+#ifdef HAVE_X86_SIMD
+    else if (strcmp (isa, "sse2") == 0)
+        k = &kern_sse2;
+    else if (strcmp (isa, "avx2") == 0)
+        k = &kern_avx2;
+    else if (strcmp (isa, "avx512") == 0)
+        k = &kern_avx512;
+#endif
+    if (!k)
+        return -1;
+
+    mtrx_kern = *k;
+
+    return 0;
+}
+
+/** mtrx_simd_init - select widest kernels supported by the processor.
+ *  (AVX-512F, AVX2, SSE2 or generic C) returns the selected isa name.
+ */
+const char *mtrx_simd_init (void)
+{
+    static const char *isa[] = { "avx512", "avx2", "sse2", "generic" };
+    size_t i;
+
+    for (i = 0; i < sizeof isa / sizeof *isa; i++)
+        if (mtrx_simd_select (isa[i]) == 0)
+            break;
+
+    return mtrx_kern.isa;
+}
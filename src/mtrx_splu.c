@@ -0,0 +1,1088 @@
+#include <float.h>
+
+#include "mtrx_splu.h"
+#include "mtrx_simd.h"
+
+#define SPLU_NONE ((size_t)-1)
+
+/* adjacency of the pattern of b + b^T less the diagonal, b = a with row i
+ * moved to rinv[i] (NULL, b = a), neighbors of i at adj[xadj[i]..xadj[i+1]).
+ * returns 0 on success, -1 on failure.
+ */
+static int splu_adj (const csr_t *a, const size_t *rinv,
+                     size_t **xadj, size_t **adj)
+{
+    const size_t n = a->rows;
+    size_t *xa = calloc (n + 1, sizeof *xa),
+           *ad = NULL,
+           *mark = malloc ((n ? n : 1) * sizeof *mark),
+           nz;
+    register size_t i, p, q;
+
+    if (!xa || !mark)
+        goto adjerr;
+
+    for (i = 0; i < n; i++) {
+        const size_t r = rinv ? rinv[i] : i;
+        for (p = a->rp[i]; p < a->rp[i + 1]; p++)
+            if (a->ci[p] != r) {
+                xa[r + 1]++;
+                xa[a->ci[p] + 1]++;
+            }
+    }
+    for (i = 0; i < n; i++)
+        xa[i + 1] += xa[i];
+    if (!(ad = malloc ((xa[n] ? xa[n] : 1) * sizeof *ad)))
+        goto adjerr;
+
+    for (i = 0; i < n; i++)             /* both directions, mark as position */
+        mark[i] = xa[i];
+    for (i = 0; i < n; i++) {
+        const size_t r = rinv ? rinv[i] : i;
+        for (p = a->rp[i]; p < a->rp[i + 1]; p++)
+            if (a->ci[p] != r) {
+                ad[mark[r]++] = a->ci[p];
+                ad[mark[a->ci[p]]++] = r;
+            }
+    }
+
+    for (i = 0; i < n; i++)             /* drop duplicates, reset xa */
+        mark[i] = SPLU_NONE;
+    for (nz = 0, p = 0, i = 0; i < n; i++) {
+        size_t end = xa[i + 1];
+
+        xa[i] = nz;
+        for (q = p; q < end; q++)
+            if (mark[ad[q]] != i) {
+                mark[ad[q]] = i;
+                ad[nz++] = ad[q];
+            }
+        p = end;
+    }
+    xa[n] = nz;
+
+    free (mark);
+    *xadj = xa;
+    *adj = ad;
+
+    return 0;
+
+    adjerr:;
+    fprintf (stderr, "%s() error: memory exhausted.\n", __func__);
+    free (mark);
+    free (ad);
+    free (xa);
+
+    return -1;
+}
+
+/* breadth-first level structure from root, q receives the nodes level by
+ * level (mark[] set to tag). returns the number of levels, *last the start
+ * of the last level and *cnt the nodes reached.
+ */
+static size_t rcm_levels (const size_t *xadj, const size_t *adj,
+                          const size_t root, size_t *q, size_t *mark,
+                          const size_t tag, size_t *last, size_t *cnt)
+{
+    size_t head = 0, tail = 0, nlev = 0;
+    register size_t p;
+
+    q[tail++] = root;
+    mark[root] = tag;
+
+    while (head < tail) {
+        const size_t lend = tail;
+
+        *last = head;
+        nlev++;
+        for (; head < lend; head++)
+            for (p = xadj[q[head]]; p < xadj[q[head] + 1]; p++)
+                if (mark[adj[p]] != tag) {
+                    mark[adj[p]] = tag;
+                    q[tail++] = adj[p];
+                }
+    }
+    *cnt = tail;
+
+    return nlev;
+}
+
+/* reverse Cuthill-McKee order of the graph (xadj, adj) into perm */
+static int splu_rcm (const size_t n, const size_t *xadj, const size_t *adj,
+                     size_t *perm)
+{
+    size_t *q = malloc ((n ? n : 1) * sizeof *q),
+           *mark = malloc ((n ? n : 1) * sizeof *mark),
+           tag = 0, k = 0;
+    unsigned char *num = calloc (n ? n : 1, 1);
+    register size_t i, p;
+
+    if (!q || !mark || !num) {
+        fprintf (stderr, "%s() error: memory exhausted.\n", __func__);
+        free (num);
+        free (mark);
+        free (q);
+        return -1;
+    }
+    for (i = 0; i < n; i++)
+        mark[i] = SPLU_NONE;
+
+    for (i = 0; i < n; i++) {
+        size_t root = i, last, cnt, nlev, head;
+
+        if (num[i])
+            continue;
+
+        /* pseudo-peripheral root, min degree node of the last level until
+         * the eccentricity stops growing.
+         */
+        nlev = rcm_levels (xadj, adj, root, q, mark, tag++, &last, &cnt);
+        for (;;) {
+            size_t v = q[last], nl;
+
+            for (p = last + 1; p < cnt; p++)
+                if (xadj[q[p] + 1] - xadj[q[p]] < xadj[v + 1] - xadj[v])
+                    v = q[p];
+            nl = rcm_levels (xadj, adj, v, q, mark, tag++, &last, &cnt);
+            if (nl <= nlev)
+                break;
+            root = v;
+            nlev = nl;
+        }
+
+        /* Cuthill-McKee, neighbors numbered by increasing degree */
+        perm[k++] = root;
+        num[root] = 1;
+        for (head = k - 1; head < k; head++) {
+            const size_t u = perm[head], s = k;
+
+            for (p = xadj[u]; p < xadj[u + 1]; p++)
+                if (!num[adj[p]]) {
+                    size_t v = adj[p], d = xadj[v + 1] - xadj[v], j = k++;
+
+                    num[v] = 1;
+                    for (; j > s && xadj[perm[j-1] + 1] - xadj[perm[j-1]] > d;
+                            j--)
+                        perm[j] = perm[j - 1];
+                    perm[j] = v;
+                }
+        }
+    }
+
+    for (i = 0; i < n / 2; i++) {       /* reverse */
+        size_t t = perm[i];
+        perm[i] = perm[n - 1 - i];
+        perm[n - 1 - i] = t;
+    }
+
+    free (num);
+    free (mark);
+    free (q);
+
+    return 0;
+}
+
+/** mtrx_rcm - reverse Cuthill-McKee ordering of the pattern of a + a^T,
+ *  each component started from a pseudo-peripheral node (George-Liu).
+ *  perm (n) receives the new order, new i is old perm[i]. returns 0 on
+ *  success, -1 on allocation failure.
+ */
+int mtrx_rcm (const csr_t *a, size_t *perm)
+{
+    size_t *xadj, *adj;
+    int ret;
+
+    if (splu_adj (a, NULL, &xadj, &adj))
+        return -1;
+
+    ret = splu_rcm (a->rows, xadj, adj, perm);
+
+    free (adj);
+    free (xadj);
+
+    return ret;
+}
+
+/* indexed binary min-heap of cols keyed on d[], hpos[c] the position of
+ * c in the heap (SPLU_NONE if not in it). insert or decrease key of c.
+ */
+static void heap_up (size_t *heap, size_t *hpos, const T *d, size_t c,
+                     size_t k)
+{
+    if (hpos[c] == SPLU_NONE)
+        hpos[c] = k;
+    else
+        k = hpos[c];
+    while (k) {
+        const size_t up = (k - 1) / 2;
+        if (d[heap[up]] <= d[c])
+            break;
+        heap[k] = heap[up];
+        hpos[heap[k]] = k;
+        k = up;
+    }
+    heap[k] = c;
+    hpos[c] = k;
+}
+
+/* remove and return the col with the least d[] from the heap of *nh */
+static size_t heap_pop (size_t *heap, size_t *hpos, const T *d, size_t *nh)
+{
+    const size_t top = heap[0], c = heap[--*nh];
+    size_t k = 0, ch;
+
+    hpos[top] = SPLU_NONE;
+    if (!*nh)
+        return top;
+    while ((ch = 2 * k + 1) < *nh) {
+        if (ch + 1 < *nh && d[heap[ch + 1]] < d[heap[ch]])
+            ch++;
+        if (d[c] <= d[heap[ch]])
+            break;
+        heap[k] = heap[ch];
+        hpos[heap[k]] = k;
+        k = ch;
+    }
+    heap[k] = c;
+    hpos[c] = k;
+
+    return top;
+}
+
+/* maximum product transversal (MC64 job 5): the cols matched to the rows
+ * maximize the product of |a(i,imatch[i])|, so a tiny (or stored zero)
+ * diagonal is not kept where larger values can be placed on it. with cost
+ * c(i,j) = log max_k |a(i,k)| - log |a(i,j)| (non-zeros only), each
+ * unmatched row is matched by a shortest augmenting path (Dijkstra on
+ * costs reduced by row and col potentials, kept >= 0). imatch[i] receives
+ * the col matched to row i. returns the structural rank, or n + 1 on
+ * allocation failure.
+ */
+static size_t splu_match (const csr_t *a, size_t *imatch)
+{
+    const size_t n = a->rows;
+    size_t *jmatch = malloc (n * sizeof *jmatch),
+           *pred = malloc (n * sizeof *pred),   /* row reaching col */
+           *heap = malloc (n * sizeof *heap),
+           *hpos = malloc (n * sizeof *hpos),
+           *vis = malloc (n * sizeof *vis),     /* cols labeled, in order */
+           rank = 0;
+    T *c = malloc ((a->nnz ? a->nnz : 1) * sizeof *c),
+      *u = malloc (n * sizeof *u), *v = malloc (n * sizeof *v),
+      *d = malloc (n * sizeof *d);
+    unsigned char *done = calloc (n, 1);       /* col distance final */
+    register size_t i, j, p;
+
+    if (!jmatch || !pred || !heap || !hpos || !vis || !c || !u || !v ||
+        !d || !done) {
+        fprintf (stderr, "%s() error: memory exhausted.\n", __func__);
+        rank = n + 1;
+        goto matchdone;
+    }
+
+    for (j = 0; j < n; j++) {
+        jmatch[j] = hpos[j] = SPLU_NONE;
+        v[j] = 0.0;
+        d[j] = HUGE_VAL;
+    }
+    for (i = 0; i < n; i++) {           /* costs, cheap assignment */
+        T rmax = 0.0;
+
+        imatch[i] = SPLU_NONE;
+        u[i] = 0.0;
+        for (p = a->rp[i]; p < a->rp[i + 1]; p++)
+            if (fabs (a->v[p]) > rmax)
+                rmax = fabs (a->v[p]);
+        for (p = a->rp[i]; p < a->rp[i + 1]; p++)
+            c[p] = a->v[p] != 0.0 ? log (rmax) - log (fabs (a->v[p]))
+                                  : HUGE_VAL;
+        for (p = a->rp[i]; p < a->rp[i + 1]; p++)   /* diagonal first */
+            if (a->ci[p] == i && c[p] == 0.0 && jmatch[i] == SPLU_NONE)
+                imatch[i] = i;
+        for (p = a->rp[i]; p < a->rp[i + 1] && imatch[i] == SPLU_NONE; p++)
+            if (c[p] == 0.0 && jmatch[a->ci[p]] == SPLU_NONE)
+                imatch[i] = a->ci[p];
+        if (imatch[i] != SPLU_NONE) {
+            jmatch[imatch[i]] = i;
+            rank++;
+        }
+    }
+
+    for (i = 0; i < n; i++) {           /* shortest augmenting paths */
+        size_t nh = 0, nv = 0, r = i, fc = SPLU_NONE;
+        T dr = 0.0, dmax;
+
+        if (imatch[i] != SPLU_NONE)
+            continue;
+        for (;;) {
+            for (p = a->rp[r]; p < a->rp[r + 1]; p++) {
+                const size_t col = a->ci[p];
+                T dn;
+
+                if (c[p] == HUGE_VAL || done[col])
+                    continue;
+                dn = dr + c[p] - u[r] - v[col];
+                if (dn < d[col]) {
+                    const int ins = hpos[col] == SPLU_NONE;
+
+                    if (d[col] == HUGE_VAL)
+                        vis[nv++] = col;
+                    d[col] = dn;
+                    pred[col] = r;
+                    heap_up (heap, hpos, d, col, nh);
+                    nh += ins;
+                }
+            }
+            if (!nh)                    /* row i cannot be matched */
+                break;
+            j = heap_pop (heap, hpos, d, &nh);
+            done[j] = 1;
+            if (jmatch[j] == SPLU_NONE) {
+                fc = j;
+                break;
+            }
+            r = jmatch[j];              /* matched edge, reduced cost 0 */
+            dr = d[j];
+        }
+
+        dmax = fc != SPLU_NONE ? d[fc] : 0.0;
+        if (fc != SPLU_NONE) {          /* potentials, labeled rows/cols */
+            u[i] += dmax;
+            for (p = 0; p < nv; p++)
+                if (done[j = vis[p]] && j != fc) {
+                    u[jmatch[j]] += dmax - d[j];
+                    v[j] -= dmax - d[j];
+                }
+            for (j = fc; j != SPLU_NONE; ) {    /* augment */
+                const size_t row = pred[j], next = imatch[row];
+                imatch[row] = j;
+                jmatch[j] = row;
+                j = next;
+            }
+            rank++;
+        }
+        while (nh)                      /* reset labels */
+            hpos[heap[--nh]] = SPLU_NONE;
+        for (p = 0; p < nv; p++) {
+            d[vis[p]] = HUGE_VAL;
+            done[vis[p]] = 0;
+        }
+    }
+
+    matchdone:;
+    free (done);
+    free (d);
+    free (v);
+    free (u);
+    free (c);
+    free (vis);
+    free (hpos);
+    free (heap);
+    free (pred);
+    free (jmatch);
+
+    return rank;
+}
+
+/* elimination tree of the permuted symmetric pattern (Liu) */
+static void splu_etree (const size_t n, const size_t *xadj, const size_t *adj,
+                        const size_t *perm, const size_t *pinv,
+                        size_t *parent, size_t *anc)
+{
+    register size_t i, j, p;
+
+    for (j = 0; j < n; j++) {
+        parent[j] = anc[j] = SPLU_NONE;
+        for (p = xadj[perm[j]]; p < xadj[perm[j] + 1]; p++) {
+            if ((i = pinv[adj[p]]) >= j)
+                continue;
+            while (anc[i] != SPLU_NONE && anc[i] != j) {  /* compress path */
+                size_t next = anc[i];
+                anc[i] = j;
+                i = next;
+            }
+            if (anc[i] == SPLU_NONE) {
+                anc[i] = j;
+                parent[i] = j;
+            }
+        }
+    }
+}
+
+/* postorder of the etree, children before parents, in post */
+static void splu_post (const size_t n, const size_t *parent, size_t *post,
+                       size_t *head, size_t *next, size_t *stack)
+{
+    size_t k = 0, top;
+    register size_t j;
+
+    for (j = 0; j < n; j++)
+        head[j] = SPLU_NONE;
+    for (j = n; j--;)                   /* child lists in ascending order */
+        if (parent[j] != SPLU_NONE) {
+            next[j] = head[parent[j]];
+            head[parent[j]] = j;
+        }
+
+    for (j = 0; j < n; j++) {
+        if (parent[j] != SPLU_NONE)
+            continue;
+        stack[0] = j;
+        top = 1;
+        while (top) {
+            size_t p = stack[top - 1], i = head[p];
+
+            if (i == SPLU_NONE) {
+                top--;
+                post[k++] = p;
+            }
+            else {
+                head[p] = next[i];
+                stack[top++] = i;
+            }
+        }
+    }
+}
+
+/** free splu_sym_t and storage */
+void splu_sym_free (splu_sym_t *s)
+{
+    free (s->cx);
+    free (s->cr);
+    free (s->cp);
+    free (s->up);
+    free (s->lp);
+    free (s->ri);
+    free (s->rp);
+    free (s->snode);
+    free (s->sup);
+    free (s->qinv);
+    free (s->q);
+    free (s->pinv);
+    free (s->perm);
+    free (s);
+}
+
+/** splu_analyze - symbolic analysis of square a: row matching to a zero-free
+ *  diagonal (maximum product transversal, large values of a placed on the
+ *  diagonal), fill-reducing order (ORD_RCM or ORD_NATURAL) of the symmetric
+ *  pattern b + b^T of the matched b, postordered elimination tree, relaxed
+ *  supernodes (chains of up to SPLU_NSMAX cols sharing one structure,
+ *  explicit zeros within SPLU_RELAX) and their row structure. storage is
+ *  O(nnz(L + U)), the analysis is reused by splu_factor()/splu_refactor()
+ *  for any a of the same pattern (the matching is made on the values of a
+ *  given here). returns pointer to splu_sym_t on success, NULL otherwise.
+ */
+splu_sym_t *splu_analyze (const csr_t *a, const int order)
+{
+    const size_t n = a->rows, nw = n ? n : 1;
+    splu_sym_t *s = NULL;
+    size_t *xadj = NULL, *adj = NULL,
+           *parent = malloc (nw * sizeof *parent),
+           *w1 = malloc (nw * sizeof *w1),
+           *w2 = malloc (nw * sizeof *w2),
+           *w3 = malloc (nw * sizeof *w3);
+    register size_t i, j, k, p, nz;
+
+    if (a->rows != a->cols || !n) {
+        fprintf (stderr, "%s() error: invalid (%zu x %zu) matrix.\n",
+                __func__, a->rows, a->cols);
+        goto symdone;
+    }
+    if (!parent || !w1 || !w2 || !w3 || !(s = calloc (1, sizeof *s)) ||
+        !(s->perm = malloc (n * sizeof *s->perm)) ||
+        !(s->pinv = malloc (n * sizeof *s->pinv)) ||
+        !(s->q = malloc (n * sizeof *s->q)) ||
+        !(s->qinv = malloc (n * sizeof *s->qinv)) ||
+        !(s->sup = malloc ((n + 1) * sizeof *s->sup)) ||
+        !(s->snode = malloc (n * sizeof *s->snode)) ||
+        !(s->cp = calloc (n + 1, sizeof *s->cp)) ||
+        !(s->cr = malloc ((a->nnz ? a->nnz : 1) * sizeof *s->cr)) ||
+        !(s->cx = malloc ((a->nnz ? a->nnz : 1) * sizeof *s->cx))) {
+        fprintf (stderr, "%s() error: memory exhausted.\n", __func__);
+        goto symerr;
+    }
+    s->n = n;
+    s->nnz = a->nnz;
+
+    for (p = 0; p < a->nnz; p++)        /* column access to a */
+        s->cp[a->ci[p] + 1]++;
+    for (j = 0; j < n; j++) {
+        s->cp[j + 1] += s->cp[j];
+        w1[j] = s->cp[j];
+    }
+    for (i = 0; i < n; i++)
+        for (p = a->rp[i]; p < a->rp[i + 1]; p++) {
+            k = w1[a->ci[p]]++;
+            s->cr[k] = i;
+            s->cx[k] = p;
+        }
+
+    /* rows to a zero-free diagonal, qinv holds row -> matched col */
+    if ((k = splu_match (a, s->qinv)) != n) {
+        if (k < n)
+            fprintf (stderr, "%s() error: structurally singular matrix, "
+                    "rank %zu.\n", __func__, k);
+        goto symerr;
+    }
+    if (splu_adj (a, s->qinv, &xadj, &adj))
+        goto symerr;
+
+    if (order == ORD_RCM) {
+        if (splu_rcm (n, xadj, adj, s->perm))
+            goto symerr;
+    }
+    else
+        for (i = 0; i < n; i++)
+            s->perm[i] = i;
+    for (i = 0; i < n; i++)
+        s->pinv[s->perm[i]] = i;
+
+    /* postorder the etree (same fill, contiguous supernodes) */
+    splu_etree (n, xadj, adj, s->perm, s->pinv, parent, w1);
+    splu_post (n, parent, w1, w2, w3, s->snode);
+    for (i = 0; i < n; i++)
+        w2[i] = s->perm[w1[i]];
+    memcpy (s->perm, w2, n * sizeof *s->perm);
+    for (i = 0; i < n; i++)
+        s->pinv[s->perm[i]] = i;
+    splu_etree (n, xadj, adj, s->perm, s->pinv, parent, w1);
+    for (i = 0; i < n; i++)
+        w1[s->qinv[i]] = i;
+    for (i = 0; i < n; i++)
+        s->q[i] = w1[s->perm[i]];
+    for (i = 0; i < n; i++)
+        s->qinv[s->q[i]] = i;
+
+    /* column counts of L, row subtrees of the etree, w1 counts, w2 marks */
+    for (j = 0; j < n; j++)
+        w1[j] = 0;
+    for (i = 0; i < n; i++) {
+        w2[i] = i;
+        w1[i]++;
+        for (p = xadj[s->perm[i]]; p < xadj[s->perm[i] + 1]; p++)
+            if ((k = s->pinv[adj[p]]) < i)
+                for (j = k; w2[j] != i; j = parent[j]) {
+                    w2[j] = i;
+                    w1[j]++;
+                }
+    }
+
+    /* relaxed supernodes, col j joins its child j-1 while the explicit
+     * zeros stay within SPLU_RELAX of the (nr x ns) block, struct of the
+     * supernode is its cols and the struct of its last col.
+     */
+    s->sup[0] = 0;
+    s->snode[0] = 0;
+    for (nz = w1[0], s->nsup = 1, j = 1; j < n; j++) {
+        const size_t ns = j + 1 - s->sup[s->nsup - 1], nr = ns + w1[j] - 1,
+                     tot = ns * nr - ns * (ns - 1) / 2;
+
+        if (parent[j - 1] == j && ns <= SPLU_NSMAX &&
+            (ns <= 4 || tot - nz - w1[j] <= SPLU_RELAX * tot))
+            nz += w1[j];
+        else {
+            s->sup[s->nsup++] = j;
+            nz = w1[j];
+        }
+        s->snode[j] = s->nsup - 1;
+    }
+    s->sup[s->nsup] = n;
+
+    if (!(s->rp = malloc ((s->nsup + 1) * sizeof *s->rp)) ||
+        !(s->lp = malloc ((s->nsup + 1) * sizeof *s->lp)) ||
+        !(s->up = malloc ((s->nsup + 1) * sizeof *s->up))) {
+        fprintf (stderr, "%s() error: memory exhausted.\n", __func__);
+        goto symerr;
+    }
+    s->rp[0] = s->lp[0] = s->up[0] = 0;
+    for (k = 0; k < s->nsup; k++) {
+        const size_t ns = s->sup[k + 1] - s->sup[k],
+                     nr = ns + w1[s->sup[k + 1] - 1] - 1;
+
+        s->rp[k + 1] = s->rp[k] + nr;
+        s->lp[k + 1] = s->lp[k] + nr * ns;
+        s->up[k + 1] = s->up[k] + ns * (nr - ns);
+    }
+    s->lnz = s->lp[s->nsup];
+    s->unz = s->up[s->nsup];
+
+    if (!(s->ri = malloc (s->rp[s->nsup] * sizeof *s->ri))) {
+        fprintf (stderr, "%s() error: memory exhausted malloc-ri.\n",
+                __func__);
+        goto symerr;
+    }
+
+    /* row structure of each supernode, its cols then the struct of its
+     * last col ascending by row.
+     */
+    for (k = 0; k < s->nsup; k++) {
+        w1[k] = s->rp[k];
+        for (j = s->sup[k]; j + 1 < s->sup[k + 1]; j++)
+            s->ri[w1[k]++] = j;
+    }
+    for (i = 0; i < n; i++) {
+        w2[i] = i;
+        if (s->sup[s->snode[i] + 1] - 1 == i)
+            s->ri[w1[s->snode[i]]++] = i;
+        for (p = xadj[s->perm[i]]; p < xadj[s->perm[i] + 1]; p++)
+            if ((k = s->pinv[adj[p]]) < i)
+                for (j = k; w2[j] != i; j = parent[j]) {
+                    w2[j] = i;
+                    if (s->sup[s->snode[j] + 1] - 1 == j)
+                        s->ri[w1[s->snode[j]]++] = i;
+                }
+    }
+    goto symdone;
+
+    symerr:;
+    if (s)
+        splu_sym_free (s);
+    s = NULL;
+
+    symdone:;
+    free (adj);
+    free (xadj);
+    free (w3);
+    free (w2);
+    free (w1);
+    free (parent);
+
+    return s;
+}
+
+/** free splu_t and storage */
+void splu_free (splu_t *f)
+{
+    free (f->piv);
+    free (f->ux);
+    free (f->lx);
+    free (f);
+}
+
+/** splu_factor - allocate and compute numeric factors of a (pattern as
+ *  analyzed by sym), see splu_refactor(). returns pointer to splu_t on
+ *  success, NULL otherwise.
+ */
+splu_t *splu_factor (const splu_sym_t *sym, const csr_t *a)
+{
+    splu_t *f = calloc (1, sizeof *f);
+
+    if (!f || !(f->lx = malloc ((sym->lnz ? sym->lnz : 1) * sizeof *f->lx)) ||
+        !(f->ux = malloc ((sym->unz ? sym->unz : 1) * sizeof *f->ux)) ||
+        !(f->piv = malloc (sym->n * sizeof *f->piv))) {
+        fprintf (stderr, "%s() error: memory exhausted.\n", __func__);
+        if (f)
+            splu_free (f);
+        return NULL;
+    }
+    f->sym = sym;
+
+    if (splu_refactor (f, a)) {
+        splu_free (f);
+        return NULL;
+    }
+
+    return f;
+}
+
+/* pos[row] = index of row in the structure of supernode t */
+static void splu_pos (const splu_sym_t *s, const size_t t, size_t *pos)
+{
+    register size_t k;
+
+    for (k = s->rp[t]; k < s->rp[t + 1]; k++)
+        pos[s->ri[k]] = k - s->rp[t];
+}
+
+/** splu_refactor - numeric right-looking supernodal LU of a into f. each
+ *  supernode panel is factored with row pivoting inside its dense diagonal
+ *  block (structure is unchanged), pivots smaller than f->eps are replaced
+ *  by +/- f->eps (counted in f->npert), and the Schur complement of the
+ *  panel is formed densely and scattered into the later supernodes.
+ *  returns 0 on success, -1 on invalid pattern or allocation failure.
+ */
+int splu_refactor (splu_t *f, const csr_t *a)
+{
+    const splu_sym_t *s = f->sym;
+    const size_t n = s->n;
+    size_t *pos = NULL, wmax = 1;
+    T *w = NULL, amax = 0.0;
+    register size_t i, j, k, p, t;
+
+    if (a->rows != n || a->cols != n || a->nnz != s->nnz) {
+        fprintf (stderr, "%s() error: pattern differs from analysis.\n",
+                __func__);
+        return -1;
+    }
+    for (t = 0; t < s->nsup; t++) {     /* largest Schur block */
+        size_t nb = s->rp[t + 1] - s->rp[t] - (s->sup[t + 1] - s->sup[t]);
+        if (nb * nb > wmax)
+            wmax = nb * nb;
+    }
+    if (!(pos = malloc (n * sizeof *pos)) || !(w = malloc (wmax * sizeof *w))) {
+        fprintf (stderr, "%s() error: memory exhausted.\n", __func__);
+        free (pos);
+        return -1;
+    }
+
+    for (f->anrm = 0.0, i = 0; i < n; i++) {
+        T sum = 0.0;
+        for (p = a->rp[i]; p < a->rp[i + 1]; p++) {
+            sum += fabs (a->v[p]);
+            if (fabs (a->v[p]) > amax)
+                amax = fabs (a->v[p]);
+        }
+        if (sum > f->anrm)
+            f->anrm = sum;
+    }
+    f->eps = amax > 0.0 ? sqrt (DBL_EPSILON) * amax : DBL_EPSILON;
+    f->npert = 0;
+    memset (f->lx, 0, s->lnz * sizeof *f->lx);
+    memset (f->ux, 0, s->unz * sizeof *f->ux);
+
+    for (t = 0; t < s->nsup; t++) {     /* scatter a into the supernodes */
+        const size_t fc = s->sup[t], lc = s->sup[t + 1], ns = lc - fc,
+                     nb = s->rp[t + 1] - s->rp[t] - ns;
+        T *L = f->lx + s->lp[t], *U = f->ux + s->up[t];
+
+        splu_pos (s, t, pos);
+        for (j = fc; j < lc; j++) {
+            const size_t c = s->perm[j], r = s->q[j];
+
+            for (p = s->cp[c]; p < s->cp[c + 1]; p++)     /* col j, L */
+                if ((i = s->qinv[s->cr[p]]) >= j)
+                    L[pos[i] * ns + j - fc] += a->v[s->cx[p]];
+            for (p = a->rp[r]; p < a->rp[r + 1]; p++)     /* row j, U */
+                if ((k = s->pinv[a->ci[p]]) > j) {
+                    if (k < lc)
+                        L[(j - fc) * ns + k - fc] += a->v[p];
+                    else
+                        U[(j - fc) * nb + pos[k] - ns] += a->v[p];
+                }
+        }
+    }
+
+    for (t = 0; t < s->nsup; t++) {
+        const size_t fc = s->sup[t], ns = s->sup[t + 1] - fc,
+                     nr = s->rp[t + 1] - s->rp[t], nb = nr - ns,
+                     *rb = s->ri + s->rp[t] + ns;
+        T *L = f->lx + s->lp[t], *U = f->ux + s->up[t];
+        size_t tt, ii, jj;
+
+        /* panel, pivot rows restricted to the diagonal block */
+        for (k = 0; k < ns; k++) {
+            T *lk = L + k * ns, piv;
+
+            for (p = k, i = k + 1; i < ns; i++)
+                if (fabs (L[i * ns + k]) > fabs (L[p * ns + k]))
+                    p = i;
+            f->piv[fc + k] = fc + p;
+            if (p != k) {
+                mtrx_kern.swap (ns, lk, L + p * ns);
+                mtrx_kern.swap (nb, U + k * nb, U + p * nb);
+            }
+            if (fabs (lk[k]) < f->eps) {
+                lk[k] = lk[k] < 0.0 ? -f->eps : f->eps;
+                f->npert++;
+            }
+            piv = lk[k];
+
+            for (i = k + 1; i < nr; i++) {
+                T *li = L + i * ns, l;
+
+                if (li[k] == 0.0)
+                    continue;
+                l = li[k] /= piv;
+                mtrx_kern.axpy (ns - k - 1, -l, lk + k + 1, li + k + 1);
+                if (i < ns)
+                    mtrx_kern.axpy (nb, -l, U + k * nb, U + i * nb);
+            }
+        }
+        if (!nb)
+            continue;
+
+        /* Schur complement w = L21 U12 (nb x nb) */
+        memset (w, 0, nb * nb * sizeof *w);
+        for (i = 0; i < nb; i++) {
+            const T *li = L + (ns + i) * ns;
+            for (k = 0; k < ns; k++)
+                if (li[k] != 0.0)
+                    mtrx_kern.axpy (nb, li[k], U + k * nb, w + i * nb);
+        }
+
+        /* scatter-subtract, row >= col into L of the col's supernode */
+        for (tt = SPLU_NONE, jj = 0; jj < nb; jj++) {
+            const size_t c = rb[jj], u = s->snode[c],
+                         nsu = s->sup[u + 1] - s->sup[u];
+            T *Lu = f->lx + s->lp[u] + c - s->sup[u];
+
+            if (u != tt)
+                splu_pos (s, tt = u, pos);
+            for (ii = jj; ii < nb; ii++)
+                Lu[pos[rb[ii]] * nsu] -= w[ii * nb + jj];
+        }
+        /* row < col into the diagonal block or U of the row's supernode */
+        for (tt = SPLU_NONE, ii = 0; ii < nb; ii++) {
+            const size_t r = rb[ii], u = s->snode[r], fu = s->sup[u],
+                         lu = s->sup[u + 1], nsu = lu - fu,
+                         nbu = s->rp[u + 1] - s->rp[u] - nsu;
+            T *Lu = f->lx + s->lp[u] + (r - fu) * nsu,
+              *Uu = f->ux + s->up[u] + (r - fu) * nbu;
+            const T *wi = w + ii * nb;
+
+            if (u != tt)
+                splu_pos (s, tt = u, pos);
+            for (jj = ii + 1; jj < nb; jj++) {
+                const size_t c = rb[jj];
+                if (c < lu)
+                    Lu[c - fu] -= wi[jj];
+                else
+                    Uu[pos[c] - nsu] -= wi[jj];
+            }
+        }
+    }
+
+    free (w);
+    free (pos);
+
+    return 0;
+}
+
+/* y = (L U)^-1 y in the permuted order */
+static void splu_lusolv (const splu_t *f, T *y)
+{
+    const splu_sym_t *s = f->sym;
+    register size_t i, j, k, t;
+
+    for (t = 0; t < s->nsup; t++) {     /* L y = P y, unit diagonal */
+        const size_t fc = s->sup[t], lc = s->sup[t + 1], ns = lc - fc,
+                     nr = s->rp[t + 1] - s->rp[t], *r = s->ri + s->rp[t];
+        const T *L = f->lx + s->lp[t];
+
+        for (k = fc; k < lc; k++)
+            if (f->piv[k] != k) {
+                T tmp = y[k];
+                y[k] = y[f->piv[k]];
+                y[f->piv[k]] = tmp;
+            }
+        for (k = 0; k < ns; k++) {
+            const T yk = y[fc + k];
+            if (yk == 0.0)
+                continue;
+            for (i = k + 1; i < nr; i++)
+                y[r[i]] -= L[i * ns + k] * yk;
+        }
+    }
+
+    t = s->nsup;
+    while (t--) {                       /* U y = y */
+        const size_t fc = s->sup[t], ns = s->sup[t + 1] - fc,
+                     nb = s->rp[t + 1] - s->rp[t] - ns,
+                     *rb = s->ri + s->rp[t] + ns;
+        const T *L = f->lx + s->lp[t], *U = f->ux + s->up[t];
+
+        k = ns;
+        while (k--) {
+            const T *lk = L + k * ns, *uk = U + k * nb;
+            T sum = y[fc + k];
+
+            for (j = k + 1; j < ns; j++)
+                sum -= lk[j] * y[fc + j];
+            for (j = 0; j < nb; j++)
+                sum -= uk[j] * y[rb[j]];
+            y[fc + k] = sum / lk[k];
+        }
+    }
+}
+
+/* z = (P^T L U Q^T)^-1 r, y work */
+static void splu_apply (const splu_t *f, const T *r, T *z, T *y)
+{
+    const splu_sym_t *s = f->sym;
+    register size_t i;
+
+    for (i = 0; i < s->n; i++)
+        y[i] = r[s->q[i]];
+    splu_lusolv (f, y);
+    for (i = 0; i < s->n; i++)
+        z[s->perm[i]] = y[i];
+}
+
+/* r = b - A x, returns ||r|| */
+static T splu_resid (const csr_t *a, const T *b, const T *x, T *r)
+{
+    T nrm = 0.0;
+    register size_t i;
+
+    csr_mv (a, x, r);
+    for (i = 0; i < a->rows; i++) {
+        r[i] = b[i] - r[i];
+        nrm += r[i] * r[i];
+    }
+
+    return sqrt (nrm);
+}
+
+/* refine x by GMRES(SPLU_RESTART) on A x = b, right preconditioned by the
+ * perturbed factors (exact in about npert + 1 steps), at most SPLU_REFINE
+ * cycles. returns 0 on success, 1 if the residual is above tol (or not
+ * finite) after the last cycle, -1 on allocation failure.
+ */
+static int splu_refine (const splu_t *f, const csr_t *a, const T *b, T *x)
+{
+    const size_t n = a->rows, m = n < SPLU_RESTART ? n : SPLU_RESTART;
+    T *v = malloc ((m + 1) * n * sizeof *v),
+      *h = malloc ((m + 1) * m * sizeof *h),
+      *g = malloc ((m + 1) * sizeof *g),
+      *cs = malloc (m * sizeof *cs), *sn = malloc (m * sizeof *sn),
+      *z = malloc (n * sizeof *z), *y = malloc (n * sizeof *y),
+      bnrm = 0.0, xnrm, tol;
+    register size_t i, j, it;
+    int ret = 0;
+
+    if (!v || !h || !g || !cs || !sn || !z || !y) {
+        fprintf (stderr, "%s() error: memory exhausted.\n", __func__);
+        ret = -1;
+        goto refdone;
+    }
+    for (i = 0; i < n; i++)
+        bnrm += b[i] * b[i];
+    bnrm = sqrt (bnrm);
+
+    for (it = 0; ; it++) {
+        T beta;
+        size_t k = 0;
+
+        for (xnrm = 0.0, i = 0; i < n; i++)
+            xnrm += x[i] * x[i];
+        tol = 8.0 * DBL_EPSILON * (f->anrm * sqrt (xnrm) + bnrm);
+        beta = splu_resid (a, b, x, v);
+        if (isfinite (beta) && isfinite (tol) && beta <= tol)
+            break;
+        if (it == SPLU_REFINE) {
+            fprintf (stderr, "%s() error: no convergence, ||r|| %.3e > "
+                    "tol %.3e.\n", __func__, beta, tol);
+            ret = 1;
+            break;
+        }
+
+        mtrx_kern.scal (n, 1.0 / beta, v);
+        g[0] = beta;
+        for (j = 0; j < m; j++) {       /* v_j+1 = A M^-1 v_j, MGS */
+            T *vj = v + j * n, *w = vj + n, t;
+
+            splu_apply (f, vj, z, y);
+            csr_mv (a, z, w);
+            for (i = 0; i <= j; i++) {
+                h[i * m + j] = mtrx_kern.dot (n, w, v + i * n);
+                mtrx_kern.axpy (n, -h[i * m + j], v + i * n, w);
+            }
+            h[(j + 1) * m + j] = sqrt (mtrx_kern.dot (n, w, w));
+            if (h[(j + 1) * m + j] != 0.0)
+                mtrx_kern.scal (n, 1.0 / h[(j + 1) * m + j], w);
+
+            for (i = 0; i < j; i++) {   /* apply previous rotations */
+                t = cs[i] * h[i * m + j] + sn[i] * h[(i + 1) * m + j];
+                h[(i + 1) * m + j] = -sn[i] * h[i * m + j] +
+                                      cs[i] * h[(i + 1) * m + j];
+                h[i * m + j] = t;
+            }
+            t = hypot (h[j * m + j], h[(j + 1) * m + j]);
+            cs[j] = t != 0.0 ? h[j * m + j] / t : 1.0;
+            sn[j] = t != 0.0 ? h[(j + 1) * m + j] / t : 0.0;
+            h[j * m + j] = t;
+            g[j + 1] = -sn[j] * g[j];
+            g[j] *= cs[j];
+            k = j + 1;
+            if (fabs (g[j + 1]) <= tol || t == 0.0)
+                break;
+        }
+
+        j = k;                          /* H y = g, x += M^-1 V y */
+        while (j--) {
+            for (i = j + 1; i < k; i++)
+                g[j] -= h[j * m + i] * g[i];
+            g[j] /= h[j * m + j];
+        }
+        memset (y, 0, n * sizeof *y);
+        for (j = 0; j < k; j++)
+            mtrx_kern.axpy (n, g[j], v + j * n, y);
+        splu_apply (f, y, z, v);
+        for (i = 0; i < n; i++)
+            x[i] += z[i];
+    }
+
+    refdone:;
+    free (y);
+    free (z);
+    free (sn);
+    free (cs);
+    free (g);
+    free (h);
+    free (v);
+
+    return ret;
+}
+
+/** splu_solv - solve A x = b from the factors, b is overwritten with x.
+ *  if pivots were perturbed, the solution is refined by up to SPLU_REFINE
+ *  cycles of GMRES(SPLU_RESTART) against a, preconditioned by the factors.
+ *  returns 0 on success, 1 if the refined residual is still above the
+ *  tolerance or not finite (b holds the last iterate), -1 on allocation
+ *  failure.
+ */
+int splu_solv (const splu_t *f, const csr_t *a, T *b)
+{
+    const size_t n = f->sym->n;
+    T *x = malloc (n * sizeof *x), *y = malloc (n * sizeof *y);
+    int ret = 0;
+
+    if (!x || !y) {
+        fprintf (stderr, "%s() error: memory exhausted.\n", __func__);
+        free (y);
+        free (x);
+        return -1;
+    }
+
+    splu_apply (f, b, x, y);
+    if (f->npert)
+        ret = splu_refine (f, a, b, x);
+    memcpy (b, x, n * sizeof *b);
+
+    free (y);
+    free (x);
+
+    return ret;
+}
+
+/** mtrx_solv_splu - solve each constant column of a by sparse LU with
+ *  ordering order, the factorization is computed once. on return a->b
+ *  holds the solution. returns 0 on success, 1 if refinement did not
+ *  reach the tolerance for a column (see splu_solv()), -1 on failure.
+ */
+int mtrx_solv_splu (csr_t *a, const int order)
+{
+    splu_sym_t *sym = splu_analyze (a, order);
+    splu_t *f = NULL;
+    register size_t j;
+    int ret = -1, r, nconv = 0;
+
+    if (!sym || !(f = splu_factor (sym, a)))
+        goto spludone;
+
+    for (j = 0; j < a->nrhs; j++) {
+        if ((r = splu_solv (f, a, a->b + j * a->rows)) < 0)
+            goto spludone;
+        nconv |= r;
+    }
+    ret = nconv;
+
+    spludone:;
+    if (f)
+        splu_free (f);
+    if (sym)
+        splu_sym_free (sym);
+
+    return ret;
+}
@@ -0,0 +1,408 @@
+#include "mtrx_sym.h"
+#include "mtrx_simd.h"
+#include "mtrx_cond.h"
+
+static void SWAP (T *a, T *b)
+{
+    T tmp = *a;
+    *a = *b;
+    *b = tmp;
+}
+
+/** mtrx_is_sym - return 1 if the (n x n) coefficient block of the
+ *  (n x n+k) system m is exactly symmetric, 0 otherwise.
+ */
+int mtrx_is_sym (const mtrx_t *m)
+{
+    register size_t i, j;
+
+    if (!m || m->cols < m->rows)
+        return 0;
+
+    for (i = 1; i < m->rows; i++)
+        for (j = 0; j < i; j++)
+            if (m->mtrx[i][j] != m->mtrx[j][i])
+                return 0;
+
+    return 1;
+}
+
+/** mtrx_pack_sym - copy lower triangle of the (n x n) coefficient block of
+ *  m into a newly allocated packed mtrx_t (see mtrx_create_packed()).
+ *  user is responsible for freeing return. returns NULL on failure.
+ */
+mtrx_t *mtrx_pack_sym (const mtrx_t *m)
+{
+    register size_t i;
+    mtrx_t *p = mtrx_create_packed (m->rows);
+
+    if (!p)
+        return NULL;
+
+    for (i = 0; i < m->rows; i++)
+        memcpy (p->mtrx[i], m->mtrx[i], (i + 1) * sizeof **p->mtrx);
+
+    return p;
+}
+
+/** mtrx_chol_fact - Cholesky factorization A = L L^T of packed symmetric
+ *  positive definite l, overwritten by L. rows are computed as dot
+ *  products of contiguous packed rows, LU_NB rows at a time so each
+ *  finished row is reused by the whole block while in cache. returns 0
+ *  on success, k + 1 if the leading (k+1 x k+1) minor is not positive
+ *  definite.
+ */
+int mtrx_chol_fact (mtrx_t *l)
+{
+    T **a = l->mtrx;
+    const size_t n = l->rows;
+    register size_t i, j;
+    size_t i0, i1;
+
+    for (i0 = 0; i0 < n; i0 += LU_NB) {
+        i1 = i0 + LU_NB < n ? i0 + LU_NB : n;
+
+        for (j = 0; j < i1; j++) {
+            if (j >= i0) {      /* diagonal of row j in this block */
+                T d = a[j][j] - mtrx_kern.dot (j, a[j], a[j]);
+                if (!(d > 0.0))
+                    return j + 1;
+                a[j][j] = sqrt (d);
+            }
+            for (i = j + 1 > i0 ? j + 1 : i0; i < i1; i++)
+                a[i][j] = (a[i][j] - mtrx_kern.dot (j, a[i], a[j])) /
+                            a[j][j];
+        }
+    }
+
+    return 0;
+}
+
+/** mtrx_chol_solv - solve A x = b from mtrx_chol_fact factor, b is
+ *  overwritten with the solution vector.
+ */
+void mtrx_chol_solv (const mtrx_t *l, T *b)
+{
+    T **a = l->mtrx;
+    register size_t i;
+
+    for (i = 0; i < l->rows; i++)   /* L y = b */
+        b[i] = (b[i] - mtrx_kern.dot (i, a[i], b)) / a[i][i];
+
+    i = l->rows;
+    while (i--) {                   /* L^T x = y, by rows of L */
+        b[i] /= a[i][i];
+        mtrx_kern.axpy (i, -b[i], a[i], b);
+    }
+}
+
+/** mtrx_ldlt_fact - Bunch-Kaufman factorization P A P^T = L D L^T of
+ *  packed symmetric indefinite l (LAPACK dsytf2, lower). the pivot tests
+ *  and interchanges follow dsytf2, the rank-1 and rank-2 updates of the
+ *  trailing triangle are applied by packed rows from contiguous copies of
+ *  the pivot columns. ipiv (n) records the interchanges: ipiv[k] >= 0 a
+ *  1x1 block with rows k and ipiv[k] exchanged, ipiv[k] = ipiv[k+1] =
+ *  -(p + 1) a 2x2 block with rows k+1 and p exchanged. returns 0 on
+ *  success, k + 1 if D is exactly singular at k, -1 on allocation failure.
+ */
+int mtrx_ldlt_fact (mtrx_t *l, int *ipiv)
+{
+    const T alpha = (1.0 + sqrt (17.0)) / 8.0;
+    T **a = l->mtrx;
+    const size_t n = l->rows;
+    T *wk = malloc (n * sizeof *wk),        /* pivot column copies */
+      *wkp1 = malloc (n * sizeof *wkp1);
+    register size_t i, j;
+    size_t k = 0, kk, kp, imax = 0, kstep;
+    int info = 0;
+
+    if (!wk || !wkp1) {
+        fprintf (stderr, "%s() error: malloc-wk.\n", __func__);
+        info = -1;
+        goto ldltdone;
+    }
+
+    while (k < n) {
+        T absakk = fabs (a[k][k]), colmax = 0.0, rowmax;
+
+        kstep = 1;
+        for (i = k + 1; i < n; i++)     /* largest below diagonal */
+            if (fabs (a[i][k]) > colmax) {
+                colmax = fabs (a[i][k]);
+                imax = i;
+            }
+
+        if (absakk == 0.0 && colmax == 0.0) {
+            fprintf (stderr, "%s() error: singular matrix.\n", __func__);
+            info = k + 1;
+            goto ldltdone;
+        }
+
+        if (absakk >= alpha * colmax)
+            kp = k;
+        else {  /* largest off-diagonal in row/col imax */
+            j = k + mtrx_kern.iamax (imax - k, a[imax] + k, NULL);
+            rowmax = fabs (a[imax][j]);
+            for (i = imax + 1; i < n; i++)
+                if (fabs (a[i][imax]) > rowmax)
+                    rowmax = fabs (a[i][imax]);
+
+            if (absakk >= alpha * colmax * (colmax / rowmax))
+                kp = k;
+            else if (fabs (a[imax][imax]) >= alpha * rowmax)
+                kp = imax;
+            else {
+                kp = imax;
+                kstep = 2;
+            }
+        }
+
+        kk = k + kstep - 1;
+        if (kp != kk) { /* interchange rows/cols kk and kp in A(k:n,k:n) */
+            for (i = kp + 1; i < n; i++)
+                SWAP (&a[i][kk], &a[i][kp]);
+            for (j = kk + 1; j < kp; j++)
+                SWAP (&a[j][kk], &a[kp][j]);
+            SWAP (&a[kk][kk], &a[kp][kp]);
+            if (kstep == 2)
+                SWAP (&a[k + 1][k], &a[kp][k]);
+        }
+
+        if (kstep == 1) {   /* A22 -= x d11 x^T, L21 = x d11 */
+            T d11 = 1.0 / a[k][k];
+
+            for (i = k + 1; i < n; i++)
+                wk[i] = a[i][k];
+            for (i = k + 1; i < n; i++) {
+                mtrx_kern.axpy (i - k, -d11 * wk[i], wk + k + 1, a[i] + k + 1);
+                a[i][k] = d11 * wk[i];
+            }
+            ipiv[k] = (int)kp;
+        }
+        else {              /* A22 -= (x y) D^-1 (x y)^T, L21 = (x y) D^-1 */
+            if (k + 2 < n) {
+                T d21 = a[k + 1][k],
+                  d11 = a[k + 1][k + 1] / d21,
+                  d22 = a[k][k] / d21,
+                  t = 1.0 / (d11 * d22 - 1.0);
+
+                d21 = t / d21;
+                for (j = k + 2; j < n; j++) {
+                    wk[j] = d21 * (d11 * a[j][k] - a[j][k + 1]);
+                    wkp1[j] = d21 * (d22 * a[j][k + 1] - a[j][k]);
+                }
+                for (i = k + 2; i < n; i++) {
+                    mtrx_kern.axpy (i - k - 1, -a[i][k], wk + k + 2,
+                                    a[i] + k + 2);
+                    mtrx_kern.axpy (i - k - 1, -a[i][k + 1], wkp1 + k + 2,
+                                    a[i] + k + 2);
+                    a[i][k] = wk[i];
+                    a[i][k + 1] = wkp1[i];
+                }
+            }
+            ipiv[k] = ipiv[k + 1] = -(int)(kp + 1);
+        }
+
+        k += kstep;
+    }
+    ldltdone:;
+
+    free (wkp1);
+    free (wk);
+
+    return info;
+}
+
+/** mtrx_ldlt_solv - solve A x = b from mtrx_ldlt_fact factors and ipiv,
+ *  b is overwritten with the solution vector. (LAPACK dsytrs, lower)
+ */
+void mtrx_ldlt_solv (const mtrx_t *l, const int *ipiv, T *b)
+{
+    T **a = l->mtrx;
+    const size_t n = l->rows;
+    register size_t i;
+    size_t k = 0, kp;
+
+    while (k < n) {     /* L D y = P b */
+        if (ipiv[k] >= 0) {
+            kp = ipiv[k];
+            if (kp != k)
+                SWAP (&b[k], &b[kp]);
+            for (i = k + 1; i < n; i++)
+                b[i] -= a[i][k] * b[k];
+            b[k] /= a[k][k];
+            k++;
+        }
+        else {
+            T akm1k, akm1, ak, denom, bkm1, bk;
+
+            kp = -ipiv[k] - 1;
+            if (kp != k + 1)
+                SWAP (&b[k + 1], &b[kp]);
+            for (i = k + 2; i < n; i++)
+                b[i] -= a[i][k] * b[k] + a[i][k + 1] * b[k + 1];
+
+            akm1k = a[k + 1][k];
+            akm1 = a[k][k] / akm1k;
+            ak = a[k + 1][k + 1] / akm1k;
+            denom = akm1 * ak - 1.0;
+            bkm1 = b[k] / akm1k;
+            bk = b[k + 1] / akm1k;
+            b[k] = (ak * bkm1 - bk) / denom;
+            b[k + 1] = (akm1 * bk - bkm1) / denom;
+            k += 2;
+        }
+    }
+
+    k = n;
+    while (k--) {       /* L^T P x = y */
+        T sum = 0.0;
+
+        for (i = k + 1; i < n; i++)
+            sum += a[i][k] * b[i];
+        b[k] -= sum;
+
+        if (ipiv[k] >= 0) {
+            kp = ipiv[k];
+            if (kp != k)
+                SWAP (&b[k], &b[kp]);
+        }
+        else {          /* 2x2 block k-1, k */
+            sum = 0.0;
+            for (i = k + 1; i < n; i++)
+                sum += a[i][k - 1] * b[i];
+            b[k - 1] -= sum;
+
+            kp = -ipiv[k] - 1;
+            if (kp != k)
+                SWAP (&b[k], &b[kp]);
+            k--;
+        }
+    }
+}
+
+typedef struct {        /* packed factors for sym_op() */
+    const mtrx_t *l;
+    const int *ipiv;    /* NULL - Cholesky */
+} sym_op_t;
+
+/* x = A^-1 x from the Cholesky or LDL^T factors, (A^-T = A^-1) */
+static void sym_op (const void *f, T *x, const int trans)
+{
+    const sym_op_t *op = f;
+
+    (void)trans;
+    if (op->ipiv)
+        mtrx_ldlt_solv (op->l, op->ipiv, x);
+    else
+        mtrx_chol_solv (op->l, x);
+}
+
+/* log|det|, sign, growth (max |D| or L(k,k)^2) and condition estimate
+ * from the packed factors l, det A = det D (LDL^T) or prod L(k,k)^2.
+ */
+static void sym_stat (mtrx_stat_t *st, const mtrx_t *l, const int *ipiv)
+{
+    T **a = l->mtrx, dmax = 0.0;
+    const size_t n = l->rows;
+    sym_op_t op = { l, ipiv };
+    size_t k = 0;
+
+    st->logdet = 0.0;
+    st->sign = 1;
+    while (k < n) {
+        if (!ipiv || ipiv[k] >= 0) {    /* 1x1 pivot */
+            T d = ipiv ? a[k][k] : a[k][k] * a[k][k];
+            st->logdet += log (fabs (d));
+            if (d < 0.0)
+                st->sign = -st->sign;
+            if (fabs (d) > dmax)
+                dmax = fabs (d);
+            k++;
+        }
+        else {                          /* 2x2 pivot */
+            T d = a[k][k] * a[k + 1][k + 1] - a[k + 1][k] * a[k + 1][k];
+            st->logdet += log (fabs (d));
+            if (d < 0.0)
+                st->sign = -st->sign;
+            if (fabs (a[k][k]) > dmax)
+                dmax = fabs (a[k][k]);
+            if (fabs (a[k + 1][k]) > dmax)
+                dmax = fabs (a[k + 1][k]);
+            if (fabs (a[k + 1][k + 1]) > dmax)
+                dmax = fabs (a[k + 1][k + 1]);
+            k += 2;
+        }
+    }
+    st->growth = st->amax > 0.0 ? dmax / st->amax : 0.0;
+    st->cond = mtrx_cond1_est (sym_op, &op, n, st->anrm);
+}
+
+/** mtrx_solv_sym - solve (n x n+k) system with symmetric coefficients.
+ *  the lower triangle is packed and factored by Cholesky, if it is not
+ *  positive definite by Bunch-Kaufman LDL^T, and each constant column is
+ *  solved from the factors. the coefficient block of m is unchanged, on
+ *  return the last k cols of m contain the (n x k) solution. returns 0 on
+ *  success, non-zero if the matrix is singular or on failure.
+ */
+int mtrx_solv_sym (mtrx_t *m)
+{
+    return mtrx_solv_sym_st (m, NULL);
+}
+
+/** mtrx_solv_sym_st - mtrx_solv_sym() recording log|det|, sign, growth
+ *  and the estimated condition number of the factors in st (if not NULL),
+ *  O(n^2) in addition to the solve.
+ */
+int mtrx_solv_sym_st (mtrx_t *m, mtrx_stat_t *st)
+{
+    const size_t n = m->rows;
+    mtrx_t *p = NULL;
+    int *ipiv = NULL, info = 0;
+    register size_t i, c;
+    T *b = NULL;
+
+    if (!(p = mtrx_pack_sym (m)) || !(b = malloc (n * sizeof *b))) {
+        fprintf (stderr, "%s() error: memory exhausted.\n", __func__);
+        info = -1;
+        goto symdone;
+    }
+    if (st)
+        mtrx_stat_init (st, m->mtrx, n);
+
+    for (i = 0; i < n; i++)     /* positive diagonal required for SPD */
+        if (!(p->mtrx[i][i] > 0.0))
+            break;
+
+    if (i < n || mtrx_chol_fact (p)) {  /* indefinite, repack for LDL^T */
+        mtrx_free (p);
+        if (!(p = mtrx_pack_sym (m)) || !(ipiv = malloc (n * sizeof *ipiv))) {
+            fprintf (stderr, "%s() error: memory exhausted.\n", __func__);
+            info = -1;
+            goto symdone;
+        }
+        if ((info = mtrx_ldlt_fact (p, ipiv)))
+            goto symdone;
+    }
+    if (st)
+        sym_stat (st, p, ipiv);
+
+    for (c = n; c < m->cols; c++) {
+        for (i = 0; i < n; i++)
+            b[i] = m->mtrx[i][c];
+        if (ipiv)
+            mtrx_ldlt_solv (p, ipiv, b);
+        else
+            mtrx_chol_solv (p, b);
+        for (i = 0; i < n; i++)
+            m->mtrx[i][c] = b[i];
+    }
+    symdone:;
+
+    if (p)
+        mtrx_free (p);
+    free (ipiv);
+    free (b);
+
+    return info;
+}
@@ -1,4 +1,14 @@
+#include <stdint.h>
 #include "mtrx_t.h"
+#include "mtrx_thrd.h"
+#include "mtrx_simd.h"
+#include "mtrx_sym.h"
+#include "mtrx_band.h"
+#include "mtrx_mixed.h"
+#include "mtrx_fixed.h"
+#include "mtrx_cond.h"
+#include "mtrx_gemm.h"
+#include "mtrx_qr.h"
 #include "memrealloc.h"
 
 /** debug - print all pointer values for mtrx_t->mtrx & mtrx_t->mtrx[i] */
@@ -98,6 +108,203 @@ mtrx_t *mtrx_create_fixed (const size_t m, const size_t n)
     return ms;          /* return matrix struct */
 }
 
+/** allocate block of nbytes aligned on MTRX_ALIGN, zeroed if 'zero' */
+static void *slab_alloc (size_t nbytes, const int zero)
+{
+    void *p = NULL;
+
+    nbytes = (nbytes + MTRX_ALIGN - 1) / MTRX_ALIGN * MTRX_ALIGN;
+    if (!nbytes)
+        nbytes = MTRX_ALIGN;
+#if defined (_WIN32)
+    p = _aligned_malloc (nbytes, MTRX_ALIGN);
+#else
+    p = aligned_alloc (MTRX_ALIGN, nbytes);
+#endif
+    if (p && zero)
+        memset (p, 0, nbytes);
+
+    return p;
+}
+
+static void slab_free (void *p)
+{
+#if defined (_WIN32)
+    _aligned_free (p);
+#else
+    free (p);
+#endif
+}
+
+/** resize block p from slab_alloc() (or NULL) to nbytes, keeping MTRX_ALIGN
+ *  alignment and the first obytes (new bytes are not zeroed). large blocks
+ *  grow in place or are remapped by the allocator, a block returned off
+ *  alignment is copied into an aligned one. returns the new block, NULL on
+ *  failure (p freed).
+ */
+static void *slab_realloc (void *p, size_t obytes, size_t nbytes)
+{
+    void *q;
+
+    nbytes = (nbytes + MTRX_ALIGN - 1) / MTRX_ALIGN * MTRX_ALIGN;
+    if (!nbytes)
+        nbytes = MTRX_ALIGN;
+    if (!p)
+        return slab_alloc (nbytes, 0);
+#if defined (_WIN32)
+    (void) obytes;
+    if (!(q = _aligned_realloc (p, nbytes, MTRX_ALIGN)))
+        _aligned_free (p);
+    return q;
+#else
+    if (!(q = realloc (p, nbytes))) {
+        free (p);
+        return NULL;
+    }
+    if ((uintptr_t) q % MTRX_ALIGN == 0)
+        return q;
+    if ((p = slab_alloc (nbytes, 0)))   /* moved off alignment, copy */
+        memcpy (p, q, obytes < nbytes ? obytes : nbytes);
+    free (q);
+
+    return p;
+#endif
+}
+
+/** padded row stride (elements) for n columns, a multiple of MTRX_ALIGN
+ *  bytes, bumped by one alignment unit when the row size is a multiple of
+ *  4096 so rows do not alias in cache sets and the TLB.
+ */
+static size_t slab_stride (const size_t n)
+{
+    const size_t per = MTRX_ALIGN / sizeof (T) ? MTRX_ALIGN / sizeof (T) : 1;
+    size_t stride = (n + per - 1) / per * per;
+
+    if (!stride)
+        stride = per;
+    if ((stride * sizeof (T)) % 4096 == 0)
+        stride += per;
+
+    return stride;
+}
+
+/** mtrx_create_slab - allocate/initialize struct T with (m x n) matrix
+ *  in a single zeroed MTRX_ALIGN aligned slab. row stride is padded to a
+ *  multiple of MTRX_ALIGN (and away from multiples of 4096 bytes), rows are
+ *  reachable through m->mtrx as for any mtrx_t. set rowmax/colmax.
+ */
+mtrx_t *mtrx_create_slab (const size_t m, const size_t n)
+{
+    register size_t i;
+    mtrx_t *ms = calloc (1, sizeof *ms);             /* calloc struct */
+    if (!ms) {
+        fprintf (stderr, "%s() error: calloc-m.\n", __func__);
+        return NULL;
+    }
+
+    ms->stride = slab_stride (n);
+
+    if (!(ms->mtrx = calloc (m ? m : 1, sizeof *ms->mtrx))) {
+        fprintf (stderr, "%s() error: calloc m->mtrx failed.\n", __func__);
+        free (ms);
+        return NULL;
+    }
+    if (!(ms->slab = slab_alloc (m * ms->stride * sizeof *ms->slab, 1))) {
+        fprintf (stderr, "%s() error: slab_alloc (%zu x %zu) failed.\n",
+                __func__, m, n);
+        free (ms->mtrx);
+        free (ms);
+        return NULL;
+    }
+
+    for (i = 0; i < m; i++)     /* point rows into slab */
+        ms->mtrx[i] = ms->slab + i * ms->stride;
+
+    ms->rowmax = m;     /* set rowmax/colmax to current allocation size */
+    ms->colmax = n;
+
+    return ms;          /* return matrix struct */
+}
+
+/** mtrx_create_packed - allocate/initialize struct T with (n x n) packed
+ *  lower triangle in a single zeroed MTRX_ALIGN aligned slab of
+ *  n*(n+1)/2 elements. m->mtrx[i][j] (j <= i) addresses element (i,j) as
+ *  for any mtrx_t, stride is 0. sets rows/cols, rowmax/colmax to n.
+ */
+mtrx_t *mtrx_create_packed (const size_t n)
+{
+    register size_t i;
+    mtrx_t *ms = calloc (1, sizeof *ms);             /* calloc struct */
+    if (!ms) {
+        fprintf (stderr, "%s() error: calloc-m.\n", __func__);
+        return NULL;
+    }
+
+    if (!(ms->mtrx = calloc (n ? n : 1, sizeof *ms->mtrx))) {
+        fprintf (stderr, "%s() error: calloc m->mtrx failed.\n", __func__);
+        free (ms);
+        return NULL;
+    }
+    if (!(ms->slab = slab_alloc (n * (n + 1) / 2 * sizeof *ms->slab, 1))) {
+        fprintf (stderr, "%s() error: slab_alloc (%zu packed) failed.\n",
+                __func__, n);
+        free (ms->mtrx);
+        free (ms);
+        return NULL;
+    }
+
+    for (i = 0; i < n; i++)     /* point rows into packed triangle */
+        ms->mtrx[i] = ms->slab + i * (i + 1) / 2;
+
+    ms->rowmax = ms->rows = n;
+    ms->colmax = ms->cols = n;
+
+    return ms;
+}
+
+/** mtrx_slab - move row allocated matrix into contiguous slab storage.
+ *  copies m->rows x m->cols into a new slab, frees the individual rows and
+ *  points m->mtrx into the slab. no-op if m already uses a slab. returns
+ *  0 on success, -1 on allocation failure (m unchanged).
+ */
+int mtrx_slab (mtrx_t *m)
+{
+    register size_t i;
+    size_t stride;
+    T *slab;
+
+    if (!m)
+        return -1;
+    if (m->slab)
+        return 0;
+
+    /* slab is not zeroed, pages are first touched by the copy as each row
+     * is freed, keeping peak memory close to a single copy of the matrix.
+     */
+    stride = slab_stride (m->cols);
+    if (!(slab = slab_alloc (m->rows * stride * sizeof *slab, 0))) {
+        fprintf (stderr, "%s() error: slab_alloc (%zu x %zu) failed.\n",
+                __func__, m->rows, m->cols);
+        return -1;
+    }
+
+    for (i = 0; i < m->rows; i++) {     /* copy and free each row */
+        memcpy (slab + i * stride, m->mtrx[i], m->cols * sizeof *slab);
+        memset (slab + i * stride + m->cols, 0,     /* zero padding */
+                (stride - m->cols) * sizeof *slab);
+        free (m->mtrx[i]);
+        m->mtrx[i] = slab + i * stride;
+    }
+    for (; i < m->rowmax; i++)          /* unused pointers (if any) */
+        m->mtrx[i] = NULL;
+
+    m->slab = slab;
+    m->stride = stride;
+    m->colmax = m->cols;
+
+    return 0;
+}
+
 /** realloc matrix pointers to twice current */
 T **mtrx_realloc_ptrs (mtrx_t *m)
 {
@@ -126,6 +333,11 @@ T **mtrx_realloc_fixed (mtrx_t *m, const int which)
                 __func__);
         return NULL;
     }
+    if (m->slab) {
+        fprintf (stderr, "%s() error: slab storage cannot be reallocated.\n",
+                __func__);
+        return NULL;
+    }
     if (which == ROWOP) {   /* reallocate pointers & new rows */
         void *tmp = realloc (m->mtrx, 2 * m->rowmax * sizeof *m->mtrx);
         if (!tmp) {
@@ -164,6 +376,23 @@ T **mtrx_realloc_fixed (mtrx_t *m, const int which)
     return m->mtrx;
 }
 
+/** parse_skip - skip to the start of the next number in p, (sign or '.'
+ *  followed by a digit or '.', or a digit), returns pointer to the
+ *  nul-character if none. used by the readers of every element type.
+ *
+ *  TODO: update to check digit after "-." (e.g. "-.4")
+ */
+char *parse_skip (char *p)
+{
+    while (*p && ((*p != '-'  && *p != '+' && *p != '.' &&
+                (*p < '0' || '9' < *p)) ||
+                ((*p == '-' || *p == '+' || *p == '.') &&
+                (p[1] != '.' && (p[1] < '0' || '9' < p[1])))))
+        p++;
+
+    return p;
+}
+
 /** parse_dbl_array from any buffer regardless of format.
  *  uses strtod to parse all values from buf regardless of intervening
  *  characters. array initially sized to *nelem, reallocates as needed,
@@ -189,17 +418,8 @@ T *parse_dbl_array (char *buf, size_t *nelem)
         errno = 0;          /* reset errno before each conversion */
         if (n == *nelem)    /* check if realloc required */
             array = xrealloc_x2 (array, sizeof *array, nelem);
-        /* skip any non-digit characters
-         *
-         * TODO: update to check digit after "-." (e.g. "-.4")
-         */
-        while (*nptr && ((*nptr != '-'  && *nptr != '+' && *nptr != '.' &&
-                    (*nptr < '0' || '9' < *nptr)) ||
-                    ((*nptr == '-' || *nptr == '+' || *nptr == '.') &&
-                    (*(nptr+1) != '.' && (*(nptr+1) < '0' || '9' < *(nptr+1))))))
-            nptr++;
 
-        if (!*nptr) /* check if at end of buf */
+        if (!*(nptr = parse_skip (nptr)))   /* check if at end of buf */
             break;
         array[n] = strtod (nptr, &endptr);  /* call strtod */
         /* validate strod conversion */
@@ -235,190 +455,320 @@ T *parse_dbl_array (char *buf, size_t *nelem)
     return array;
 }
 
-/** read (m x n) matrix from file stream into dynamically sized T *mtrx.
- *  pointers are reallocated x2 as needed, row storage is reallocated
- *  x2 as required to store all values in 1st row of data, then row storage
- *  is reallocate to shrink row allocation to exact number of columns and
- *  T->colmax is set. following read of all data, pointer storage is reduced
- *  to T->nrows and T->rowmax is set.
+/* convert the values in buf into row, storing at most n. returns the
+ * number of values in buf (values past n are counted, not stored).
  */
-mtrx_t *mtrx_read_alloc (FILE *fp)
+static size_t parse_row (char *buf, T *row, const size_t n)
 {
-    char buf[MAXC];                         /* buffer for line */
-    mtrx_t *m = mtrx_create_ptrs (ROWSZ);   /* allocate ROWSIZE pointers */
-    if (!m)                                 /* validate */
-        return NULL;
-
-    while (fgets (buf, MAXC, fp)) {         /* read each line */
-        size_t col = 0;
+    char *nptr = buf, *endptr;
+    size_t col = 0;
 
-        if (m->rows == m->rowmax)   /* check if realloc needed */
-            mtrx_realloc_ptrs (m);
+    while (*(nptr = parse_skip (nptr))) {
+        T v;
 
-        /* create array of doubles from buf */
-        m->mtrx[m->rows] = parse_dbl_array (buf, &m->colmax);
-        if (!m->mtrx[m->rows]) {    /* validate */
-            fprintf (stderr, "%s() error: no values for mtrx[%zu][%zu].\n",
-                    __func__, m->rows, m->cols);
-            exit (EXIT_FAILURE);
+        errno = 0;
+        v = strtod (nptr, &endptr);
+        if (nptr == endptr || errno) {  /* no digits or under/overflow */
+            fputs ("error: in conversion.\n", stderr);
+            break;
         }
-        col = m->colmax;
+        if (col < n)
+            row[col] = v;
+        col++;
+        nptr = endptr;
+    }
+
+    return col;
+}
+
+/* measure row m->rows of ncol values (last col constant) into m->kl/ku,
+ * scanning in from each end to the first and last non-zero coefficient.
+ */
+static void row_band (mtrx_t *m, const T *row, const size_t ncol)
+{
+    register size_t i = m->rows, j = 0;
+
+    while (j + 1 < ncol && row[j] == 0.0)
+        j++;
+    if (j + 1 >= ncol)      /* no non-zero coefficient */
+        return;
+    if (i > j && i - j > m->kl)
+        m->kl = i - j;
+
+    j = ncol - 1;
+    while (row[--j] == 0.0) {}
+    if (j > i && j - i > m->ku)
+        m->ku = j - i;
+}
+
+/* resize the slab of m to rowmax rows of m->stride, keeping the m->rows
+ * rows read. returns 0 on success, -1 on failure (slab freed).
+ */
+static int slab_grow (mtrx_t *m, const size_t rowmax)
+{
+    T *slab = slab_realloc (m->slab, m->rows * m->stride * sizeof *slab,
+                            rowmax * m->stride * sizeof *slab);
+    if (!slab) {
+        fprintf (stderr, "%s() error: slab_realloc (%zu x %zu) failed.\n",
+                __func__, rowmax, m->cols);
+        m->slab = NULL;
+        return -1;
+    }
+    m->slab = slab;
+    m->rowmax = rowmax;
+
+    return 0;
+}
 
-        if (!m->rows)               /* if first row */
-            m->cols = col;          /* set number of columns */
-        else if (col != m->cols)    /* check all rows have cols values */
-            fprintf (stderr, "%s() error: column mismatch row[%zu]\n",
-                    __func__, m->rows);
-        m->rows++;  /* increment row count */
+/* append the values in line buf as row m->rows of the slab. the first row
+ * sets m->cols and the stride and sizes the slab for 'hint' rows, the slab
+ * is doubled as needed after that. lines without values are skipped, short
+ * rows are zero-filled and extra values dropped. returns 0 on success, -1
+ * on allocation failure (slab freed).
+ */
+static int slab_row (mtrx_t *m, char *buf, const size_t hint)
+{
+    size_t col;
+    T *row;
+
+    if (!m->rows) {                 /* first row, count values only */
+        if (!(m->cols = parse_row (buf, NULL, 0)))
+            return 0;
+        m->stride = slab_stride (m->cols);
+        if (slab_grow (m, hint ? hint : ROWSZ))
+            return -1;
+    }
+    else if (m->rows == m->rowmax && slab_grow (m, 2 * m->rowmax))
+        return -1;
+
+    row = m->slab + m->rows * m->stride;
+    if (!(col = parse_row (buf, row, m->cols)))
+        return 0;
+    if (col != m->cols) {           /* check all rows have cols values */
+        fprintf (stderr, "%s() error: column mismatch row[%zu]\n",
+                __func__, m->rows);
+        if (col > m->cols)
+            col = m->cols;
     }
+    memset (row + col, 0,           /* zero-fill short row and padding */
+            (m->stride - col) * sizeof *row);
+
+    row_band (m, row, m->cols);     /* bandwidth so far */
+    m->rows++;
+
+    return 0;
+}
+
+/* finish a read into slab storage, shrink the slab to m->rows, point the
+ * rows into it once and set colmax and band. returns m, NULL (m freed) if
+ * no rows were read or on allocation failure.
+ */
+static mtrx_t *slab_done (mtrx_t *m)
+{
+    register size_t i;
 
+    if (m->rows && m->rows < m->rowmax && slab_grow (m, m->rows))
+        m->rows = 0;
+    if (m->rows && !(m->mtrx = malloc (m->rows * sizeof *m->mtrx))) {
+        fprintf (stderr, "%s() error: malloc m->mtrx failed.\n", __func__);
+        m->rows = 0;
+    }
     if (!m->rows) {
-        free (m->mtrx);
+        slab_free (m->slab);
         free (m);
-        return (m = NULL);
+        return NULL;
     }
 
-    if (m->rows < m->rowmax) {  /* realloc to fit nrows, set rowmax */
-        m->mtrx = xrealloc_fixed (m->mtrx, sizeof *m->mtrx, m->rowmax, m->rows);
-        m->rowmax = m->rows;    /* update rowmax */
+    for (i = 0; i < m->rows; i++)   /* point rows into slab */
+        m->mtrx[i] = m->slab + i * m->stride;
+
+    m->colmax = m->cols;
+    m->band = m->cols == m->rows + 1;   /* measured if single constant col */
+
+    return m;
+}
+
+/** read (m x n) matrix from file stream into slab storage. each line is
+ *  converted straight into its row of a single MTRX_ALIGN aligned slab,
+ *  the first row setting the number of columns and the slab doubling in
+ *  rows as needed. the slab is then shrunk to the rows read and the row
+ *  pointers set once, so T->rowmax and T->colmax are exact.
+ */
+mtrx_t *mtrx_read_alloc (FILE *fp)
+{
+    char buf[MAXC];                         /* buffer for line */
+    mtrx_t *m = calloc (1, sizeof *m);
+    if (!m) {
+        fprintf (stderr, "%s() error: calloc-m.\n", __func__);
+        return NULL;
     }
 
-    return m;   /* return filled and exactly sized matrix struct */
+    while (fgets (buf, MAXC, fp))           /* read each line */
+        if (slab_row (m, buf, ROWSZ)) {
+            m->rows = 0;                    /* slab_done() frees m */
+            break;
+        }
+
+    return slab_done (m);   /* return filled and exactly sized matrix */
 }
 
 mtrx_t *mtrx_read_alloc_buf (char *textviewbuf)
 {
     char buf[MAXC];                         /* buffer for line */
     char *p = textviewbuf;
-    size_t off = 0;
+    size_t off = 0, lines = 1;
     int used;
-    mtrx_t *m = mtrx_create_ptrs (ROWSZ);   /* allocate ROWSIZE pointers */
-    if (!m)                                 /* validate */
+    mtrx_t *m = calloc (1, sizeof *m);
+    if (!m) {
+        fprintf (stderr, "%s() error: calloc-m.\n", __func__);
         return NULL;
+    }
 
-    while (sscanf (p + off, "%[^\n]%n", buf, &used) == 1) {  /* parse each line */
-        size_t col = 0;
+    while ((p = strchr (p, '\n')))          /* size slab for all lines */
+        p++, lines++;
+    p = textviewbuf;
 
+    while (sscanf (p + off, "%[^\n]%n", buf, &used) == 1) {  /* parse each line */
         while (isspace (p[off + used]))
             used++;
         off += used;
 
-        if (m->rows == m->rowmax)   /* check if realloc needed */
-            mtrx_realloc_ptrs (m);
-
-        /* create array of doubles from buf */
-        m->mtrx[m->rows] = parse_dbl_array (buf, &m->colmax);
-        if (!m->mtrx[m->rows]) {    /* validate */
-            fprintf (stderr, "%s() error: no values for mtrx[%zu][%zu].\n",
-                    __func__, m->rows, m->cols);
-            exit (EXIT_FAILURE);
+        if (slab_row (m, buf, lines)) {
+            m->rows = 0;                    /* slab_done() frees m */
+            break;
         }
-        col = m->colmax;
-
-        if (!m->rows)               /* if first row */
-            m->cols = col;          /* set number of columns */
-        else if (col != m->cols)    /* check all rows have cols values */
-            fprintf (stderr, "%s() error: column mismatch row[%zu]\n",
-                    __func__, m->rows);
-        m->rows++;  /* increment row count */
     }
 
-    if (!m->rows) {
-        free (m->mtrx);
-        free (m);
-        return (m = NULL);
-    }
+    return slab_done (m);   /* return filled and exactly sized matrix */
+}
 
-    if (m->rows < m->rowmax) {  /* realloc to fit nrows, set rowmax */
-        m->mtrx = xrealloc_fixed (m->mtrx, sizeof *m->mtrx, m->rowmax, m->rows);
-        m->rowmax = m->rows;    /* update rowmax */
+/** matr_read_fixed, alloc/read (m x n) matrix from file stream into slab
+ *  storage sized for 'rows' rows, growing if more are read. the number of
+ *  columns is set by the first row ('cols' is not needed). matrix is
+ *  resized to exact number of rows and pointers before return.
+ */
+mtrx_t *mtrx_read_fixed (FILE *fp, const size_t rows, const size_t cols)
+{
+    char buf[MAXC];
+    mtrx_t *m = calloc (1, sizeof *m);
+    if (!m) {
+        fprintf (stderr, "%s() error: calloc-m.\n", __func__);
+        return NULL;
     }
+    (void) cols;
+
+    while (fgets (buf, MAXC, fp))           /* read each line */
+        if (slab_row (m, buf, rows)) {
+            m->rows = 0;                    /* slab_done() frees m */
+            break;
+        }
 
-    return m;   /* return filled and exactly sized matrix struct */
+    return slab_done (m);
 }
 
-/** matr_read_fixed, alloc/read (m x n) matrix from file stream.
- *  reallocate as required, but should not be required if correct initial
- *  size given. matrix is resized to exact number of rows and pointers
- *  before return.
+/** mtrx_read_coo - read Matrix Market coordinate file into coo_t,
+ *  measuring the bandwidth of the (rows x rows) block as entries are read.
+ *  returns pointer to coo_t on success, NULL otherwise.
  */
-mtrx_t *mtrx_read_fixed (FILE *fp, const size_t rows, const size_t cols)
+coo_t *mtrx_read_coo (FILE *fp)
 {
     char buf[MAXC];
-    mtrx_t *m = mtrx_create_fixed (rows, cols); /* create m/alloc m->mtrx */
-    if (!m)
-        return NULL;
+    coo_t *c = NULL;
+    size_t rows = 0, cols = 0, nnz = 0;
 
-    while (fgets (buf, MAXC, fp)) {         /* read each line */
-        char *nptr = buf, *endptr = buf;
-        size_t col = 0;
+    if (!fgets (buf, MAXC, fp) || strncmp (buf, "%%MatrixMarket", 14) ||
+        !strstr (buf, "coordinate") || !strstr (buf, "general")) {
+        fprintf (stderr, "%s() error: not a MatrixMarket coordinate general "
+                "file.\n", __func__);
+        return NULL;
+    }
 
-        if (m->rows == m->rowmax)           /* check ptr realloc req'd */
-            mtrx_realloc_fixed (m, ROWOP);  /* custom realloc ptrs & rows */
+    while (fgets (buf, MAXC, fp))   /* skip comments, read size line */
+        if (*buf != '%' && sscanf (buf, "%zu %zu %zu", &rows, &cols, &nnz) == 3)
+            break;
+    if (!rows || !cols || !nnz) {
+        fprintf (stderr, "%s() error: invalid size line.\n", __func__);
+        return NULL;
+    }
 
-        /* NOTE cannot use parse_dbl_array () due to mtrx_realloc_fixed ()
-         * (added skip of intervening characters) TODO - refactor.
-         */
-        for (;;) {          /* loop extracting all values in line */
-            T v;            /* value of type T */
-            errno = 0;      /* reset errno before conversion */
-            /* skip any non-digit characters */
-            while (*nptr && ((*nptr != '-'  && *nptr != '+' && *nptr != '.' &&
-                        (*nptr < '0' || '9' < *nptr)) ||
-                        ((*nptr == '-' || *nptr == '+' || *nptr == '.') &&
-                        (*(nptr+1) < '0' || '9' < *(nptr+1)))))
-                nptr++;
-
-            if (!*nptr) /* check if at end of buf */
-                break;
-            v = strtod (nptr, &endptr);     /* convert with strtod */
-            if (nptr == endptr) {   /* validate digits converted */
-                fprintf (stderr, "%s() error: no digits for mtrx[%zu][%zu].\n",
-                        __func__, m->rows, m->cols);
-                return m;
-            }
-            else if (errno) {   /* check over/underflow in conversion */
-                fprintf (stderr, "%s() error: failed conversion mtrx[%zu][%zu].\n",
-                        __func__, m->rows, m->cols);
-                return m;
-            }
-            if (col == m->colmax)           /* check row realloc req'd */
-                mtrx_realloc_fixed (m, COLOP);  /* custom row realloc */
-
-            m->mtrx[m->rows][col++] = v;    /* assing value to row/col */
-
-            /* skip delimiters/move pointer to next digit
-             * (avoids unnecessary realloc if no values remain)
-             */
-            while (*endptr && *endptr != '-' && *endptr != '+' && *endptr != '.'
-                    && (*endptr < '0' || *endptr > '9'))
-                endptr++;
-            if (!*endptr)       /* break if end of string */
-                break;
-            nptr = endptr;      /* update nptr from endptr */
+    if (!(c = calloc (1, sizeof *c)) ||
+        !(c->ri = malloc (nnz * sizeof *c->ri)) ||
+        !(c->ci = malloc (nnz * sizeof *c->ci)) ||
+        !(c->v = malloc (nnz * sizeof *c->v))) {
+        fprintf (stderr, "%s() error: memory exhausted.\n", __func__);
+        goto coofail;
+    }
+    c->rows = rows;
+    c->cols = cols;
+
+    while (c->nnz < nnz && fgets (buf, MAXC, fp)) {
+        char *p = buf, *endptr;
+        size_t i, j;
+        T v;
+
+        if (*buf == '%')
+            continue;
+        i = strtoul (p, &endptr, 10);
+        j = strtoul (p = endptr, &endptr, 10);
+        v = strtod (p = endptr, &endptr);
+        if (p == endptr || !i || i > rows || !j || j > cols) {
+            fprintf (stderr, "%s() error: invalid entry %zu.\n",
+                    __func__, c->nnz);
+            goto coofail;
         }
-        if (!m->rows) {             /* set m->cols from 1st row */
-            m->cols = col;
-            if (m->cols < m->colmax) {  /* realloc to fit, set colmax */
-                m->mtrx[m->rows] = xrealloc_fixed (m->mtrx[m->rows],
-                                    sizeof **m->mtrx, m->colmax, m->cols);
-                m->colmax = m->cols;    /* update colmax */
-            }
+        i--, j--;
+
+        if (j < rows && v != 0.0) {     /* bandwidth of coefficients */
+            if (i > j && i - j > c->kl)
+                c->kl = i - j;
+            else if (j > i && j - i > c->ku)
+                c->ku = j - i;
         }
-        else if (col != m->cols)    /* verify subsequent rows match */
-            fprintf (stderr, "%s() error: column mismatch row[%zu]\n",
-                    __func__, m->rows);
-        m->rows++;  /* increment row count */
-    }
-    if (m->rows < m->rowmax) {  /* realloc to fit nrows, set rowmax */
-        register size_t i;
-        for (i = m->rows; i < m->rowmax; i++)
-            free (m->mtrx[i]);
-        m->mtrx = xrealloc_fixed (m->mtrx, sizeof *m->mtrx, m->rowmax, m->rows);
-        m->rowmax = m->rows;    /* update rowmax */
+        c->ri[c->nnz] = i;
+        c->ci[c->nnz] = j;
+        c->v[c->nnz++] = v;
+    }
+    if (c->nnz < nnz) {
+        fprintf (stderr, "%s() error: %zu of %zu entries read.\n",
+                __func__, c->nnz, nnz);
+        goto coofail;
     }
 
-    return m;
+    return c;
+
+    coofail:;
+    if (c)
+        coo_free (c);
+
+    return NULL;
+}
+
+/** free coo_t and storage */
+void coo_free (coo_t *c)
+{
+    free (c->v);
+    free (c->ci);
+    free (c->ri);
+    free (c);
+}
+
+/** mtrx_bandwidth - set m->kl/m->ku to the lower and upper bandwidth of
+ *  the (rows x rows) coefficient block and mark them measured.
+ */
+void mtrx_bandwidth (mtrx_t *m)
+{
+    register size_t i, j;
+
+    m->kl = m->ku = 0;
+    for (i = 0; i < m->rows; i++) {
+        for (j = 0; j < i - m->kl && m->mtrx[i][j] == 0.0; j++) {}
+        if (i - j > m->kl)
+            m->kl = i - j;
+        for (j = m->rows - 1; j > i + m->ku && m->mtrx[i][j] == 0.0; j--) {}
+        if (j > i + m->ku)
+            m->ku = j - i;
+    }
+    m->band = 1;
 }
 
 /** print a (m x n) matrix */
@@ -469,22 +819,32 @@ void mtrx_prn_sq (const mtrx_t *m, int width)
     }
 }
 
-/** copy a struct matrix */
+/** copy a struct matrix (copy uses slab storage) */
 mtrx_t *mtrx_copy (const mtrx_t *ma)
 {
-    register size_t i, j;
+    register size_t i;
+    mtrx_t *result;
+
+    if (MTRX_PACKED (ma)) {     /* packed triangle, copy whole slab */
+        if ((result = mtrx_create_packed (ma->rows)))
+            memcpy (result->slab, ma->slab,
+                    ma->rows * (ma->rows + 1) / 2 * sizeof *ma->slab);
+        return result;
+    }
 
-    mtrx_t *result = mtrx_create_fixed (ma->rows, ma->cols);
+    result = mtrx_create_slab (ma->rows, ma->cols);
     if (!result)        /* allocate/validate stuct & (m x n) */
         return NULL;
 
     result->rowmax = result->rows = ma->rows;   /* set retuls rows/cols */
     result->colmax = result->cols = ma->cols;
+    result->kl = ma->kl;
+    result->ku = ma->ku;
+    result->band = ma->band;
 
     /* copy mtrx contents */
     for (i = 0; i < ma->rows; i++)
-        for (j = 0; j < ma->cols; j++)
-            result->mtrx[i][j] = ma->mtrx[i][j];
+        memcpy (result->mtrx[i], ma->mtrx[i], ma->cols * sizeof **ma->mtrx);
 
     return result;
 }
@@ -494,8 +854,11 @@ void mtrx_free (mtrx_t *m)
 {
     register size_t i;
 
-    for (i = 0; i < m->rows; i++)
-        free (m->mtrx[i]);
+    if (m->slab)        /* single slab, rows point into it */
+        slab_free (m->slab);
+    else
+        for (i = 0; i < m->rows; i++)
+            free (m->mtrx[i]);
     free (m->mtrx);
     free (m);
 }
@@ -590,42 +953,173 @@ T **m_mult (T * const *m_a, T * const *m_b,
             const size_t m, const size_t n, const size_t p)
 {
     T **result = mtrx_calloc (m, p);
-    register size_t i, j, k;
 
-    for (i = 0; i < m; i++)
-        for (j = 0; j < p; j++)
-            for (k = 0; k < n; k++)
-                result [i][j] += m_a [i][k] * m_b [k][j];
+    if (result)     /* packed, threaded product, see mtrx_gemm() */
+        mtrx_gemm (m, p, n, 1.0, m_a, 0, m_b, 0, 0.0, result, 0);
 
     return result;
 }
 
+typedef struct {        /* rows r0 -> r1 of a (n cols) transposed into b */
+    T * const *a, * const *b;
+    size_t r0, r1, n;
+} trans_arg_t;
+
+typedef struct {        /* block rows b0, b0 + step, ... of (n x n) a */
+    T **a;
+    size_t n, b0, step;
+} trans_sq_arg_t;
+
+/* b[j][i] = a[i][j] for rows r0 -> r1 of a, in (TRANS_NB x TRANS_NB)
+ * blocks of (TRANS_NR x TRANS_NR) register tiles, block edges by element.
+ */
+static void *trans_run (void *arg)
+{
+    const trans_arg_t *t = arg;
+    register size_t i, j;
+    size_t i0, i1, iend, j0, j1, jend;
+
+    for (i0 = t->r0; i0 < t->r1; i0 += TRANS_NB) {
+        i1 = i0 + TRANS_NB < t->r1 ? i0 + TRANS_NB : t->r1;
+        iend = i0 + (i1 - i0) / TRANS_NR * TRANS_NR;
+        for (j0 = 0; j0 < t->n; j0 += TRANS_NB) {
+            j1 = j0 + TRANS_NB < t->n ? j0 + TRANS_NB : t->n;
+            jend = j0 + (j1 - j0) / TRANS_NR * TRANS_NR;
+            for (i = i0; i < iend; i += TRANS_NR)
+                for (j = j0; j < jend; j += TRANS_NR)
+                    mtrx_kern.trans (t->a + i, j, t->b + j, i);
+            for (i = i0; i < i1; i++)
+                for (j = i < iend ? jend : j0; j < j1; j++)
+                    t->b[j][i] = t->a[i][j];
+        }
+    }
+
+    return NULL;
+}
+
+/* transpose the diagonal block and exchange each block to its right with
+ * its mirror below the diagonal, for block rows b0, b0 + step, ...
+ */
+static void *trans_sq_run (void *arg)
+{
+    const trans_sq_arg_t *t = arg;
+    T **a = t->a, tile[TRANS_NR][TRANS_NR], *tp[TRANS_NR], tmp;
+    register size_t i, j, r, c;
+    size_t i0, i1, iend, j0, j1, jend;
+
+    for (r = 0; r < TRANS_NR; r++)
+        tp[r] = tile[r];
+
+    for (i0 = t->b0 * TRANS_NB; i0 < t->n; i0 += t->step * TRANS_NB) {
+        i1 = i0 + TRANS_NB < t->n ? i0 + TRANS_NB : t->n;
+        iend = i0 + (i1 - i0) / TRANS_NR * TRANS_NR;
+
+        for (i = i0 + 1; i < i1; i++)           /* diagonal block */
+            for (j = i0; j < i; j++) {
+                tmp = a[i][j];
+                a[i][j] = a[j][i];
+                a[j][i] = tmp;
+            }
+
+        for (j0 = i1; j0 < t->n; j0 += TRANS_NB) {
+            j1 = j0 + TRANS_NB < t->n ? j0 + TRANS_NB : t->n;
+            jend = j0 + (j1 - j0) / TRANS_NR * TRANS_NR;
+            for (i = i0; i < iend; i += TRANS_NR)
+                for (j = j0; j < jend; j += TRANS_NR) {
+                    mtrx_kern.trans (a + i, j, tp, 0);
+                    mtrx_kern.trans (a + j, i, a + i, j);
+                    for (r = 0; r < TRANS_NR; r++)
+                        for (c = 0; c < TRANS_NR; c++)
+                            a[j + r][i + c] = tile[r][c];
+                }
+            for (i = i0; i < i1; i++)
+                for (j = i < iend ? jend : j0; j < j1; j++) {
+                    tmp = a[i][j];
+                    a[i][j] = a[j][i];
+                    a[j][i] = tmp;
+                }
+        }
+    }
+
+    return NULL;
+}
+
+/* number of threads for a transpose of nel elements */
+static int trans_nthrd (const size_t nel, const size_t nblk)
+{
+    int nt = nel < TRANS_MIN ? 1 : mtrx_nthrd_get();
+
+    if ((size_t)nt > nblk)
+        nt = nblk ? (int)nblk : 1;
+
+    return nt;
+}
+
+/** m_trans_blk - b = a^T, a (m x n), b (n x m). blocks of TRANS_NB rows of
+ *  a are split over mtrx_nthrd_get() threads (above TRANS_MIN elements).
+ */
+void m_trans_blk (T * const *a, T * const *b, const size_t m,
+                  const size_t n)
+{
+    trans_arg_t t[MTRX_THRD_MAX];
+    pthread_t tid[MTRX_THRD_MAX];
+    const size_t nblk = (m + TRANS_NB - 1) / TRANS_NB;
+    int nt = trans_nthrd (m * n, nblk), i, nrun;
+
+    for (i = 0; i < nt; i++) {
+        t[i].a = a;
+        t[i].b = b;
+        t[i].r0 = nblk * i / nt * TRANS_NB;
+        t[i].r1 = i + 1 < nt ? nblk * (i + 1) / nt * TRANS_NB : m;
+        t[i].n = n;
+    }
+
+    for (nrun = 1; nrun < nt; nrun++)
+        if (pthread_create (&tid[nrun], NULL, trans_run, &t[nrun]))
+            break;
+    trans_run (&t[0]);
+    for (i = nrun; i < nt; i++)         /* rows of threads not created */
+        trans_run (&t[i]);
+    for (i = 1; i < nrun; i++)
+        pthread_join (tid[i], NULL);
+}
+
 /* transpose matrix, dynamically allocate result */
 T **m_trans (T * const *m_a, size_t m, size_t n)
 {
     T **result = mtrx_calloc (n, m);
-    register size_t i, j;
 
-    for (i = 0; i < m; i++)
-        for (j = 0; j < n; j++)
-            result [j][i] = m_a [i][j];
+    if (result)
+        m_trans_blk (m_a, result, m, n);
 
     return result;
 }
 
-/*  Transpose square matrix in place  */
+/*  Transpose square matrix in place, blocks as m_trans_blk(), block rows
+ *  dealt round robin to the threads.
+ */
 void m_trans_sq (T **m_a, size_t n)
 {
-    register size_t i, j;
-    T tmp;
-
-    for (i = 1; i < n; i++) {
-        for (j = 0; j < i; j++) {
-            tmp = m_a [i][j];
-            m_a[i][j] = m_a[j][i];
-            m_a[j][i] = tmp;
-        }
+    trans_sq_arg_t t[MTRX_THRD_MAX];
+    pthread_t tid[MTRX_THRD_MAX];
+    const size_t nblk = (n + TRANS_NB - 1) / TRANS_NB;
+    int nt = trans_nthrd (n * n, nblk), i, nrun;
+
+    for (i = 0; i < nt; i++) {
+        t[i].a = m_a;
+        t[i].n = n;
+        t[i].b0 = i;
+        t[i].step = nt;
     }
+
+    for (nrun = 1; nrun < nt; nrun++)
+        if (pthread_create (&tid[nrun], NULL, trans_sq_run, &t[nrun]))
+            break;
+    trans_sq_run (&t[0]);
+    for (i = nrun; i < nt; i++)         /* blocks of threads not created */
+        trans_sq_run (&t[i]);
+    for (i = 1; i < nrun; i++)
+        pthread_join (tid[i], NULL);
 }
 
 /* cofactor matrix for (3 x 3) from matrix of minors */
@@ -768,22 +1262,46 @@ mtrx_t *mtrx_mult (const mtrx_t *ma, const mtrx_t *mb)
         return NULL;
     }
 
-    result->rowmax = result->rows = mb->rows;   /* set retuls rows/cols */
+    result->rowmax = result->rows = ma->rows;   /* set retuls rows/cols */
     result->colmax = result->cols = mb->cols;
 
-    /* add ma->mtrx and mb->mtrx assigning newly allocated result */
-    result->mtrx = m_mult (ma->mtrx, mb->mtrx, ma->rows, ma->cols, mb->cols);
+    /* multiply ma->mtrx and mb->mtrx assigning newly allocated result */
+    if (!(result->mtrx = m_mult (ma->mtrx, mb->mtrx, ma->rows, ma->cols,
+                                 mb->cols))) {
+        free (result);
+        return NULL;
+    }
 
     return result;
 }
 
-/** transpose matrix */
-mtrx_t *mtrx_trans (const mtrx_t *m)
+/** mtrx_mult_add - mc = alpha ma mb + beta mc in place, ma (m x n), mb
+ *  (n x p), mc (m x p). returns 0 on success, -1 on unequal dimensions.
+ */
+int mtrx_mult_add (const T alpha, const mtrx_t *ma, const mtrx_t *mb,
+                   const T beta, mtrx_t *mc)
 {
-    mtrx_t *result = NULL;
+    if (ma->cols != mb->rows || mc->rows != ma->rows ||
+        mc->cols != mb->cols) {
+        fprintf (stderr, "%s() error: unequal dimensions, (%zu x %zu) * "
+                "(%zu x %zu) != (%zu x %zu)\n", __func__, ma->rows,
+                ma->cols, mb->rows, mb->cols, mc->rows, mc->cols);
+        return -1;
+    }
 
-    /* alloccate/validate sturct */
-    if (!(result = calloc (1, sizeof *result))) {
+    mtrx_gemm (ma->rows, mb->cols, ma->cols, alpha, ma->mtrx, 0,
+               mb->mtrx, 0, beta, mc->mtrx, 0);
+
+    return 0;
+}
+
+/** transpose matrix (tiled, threaded, see m_trans_blk()) */
+mtrx_t *mtrx_trans (const mtrx_t *m)
+{
+    mtrx_t *result = NULL;
+
+    /* alloccate/validate sturct */
+    if (!(result = calloc (1, sizeof *result))) {
         fprintf (stderr, "%s() error: calloc-result.\n", __func__);
         return NULL;
     }
@@ -791,15 +1309,227 @@ mtrx_t *mtrx_trans (const mtrx_t *m)
     result->rowmax = result->rows = m->cols;    /* set retuls rows/cols */
     result->colmax = result->cols = m->rows;
 
-    /* add ma->mtrx and mb->mtrx assigning newly allocated result */
-    result->mtrx = m_trans (m->mtrx, m->rows, m->cols);
+    /* transpose m->mtrx assigning newly allocated result */
+    if (!(result->mtrx = m_trans (m->mtrx, m->rows, m->cols))) {
+        free (result);
+        return NULL;
+    }
 
     return result;
 }
 
-/** solve system of equations - FIXME cofactor for N not 3x3
- *  (just use src-c/tmp/gauss_jordan_chk_10x10_mod.c) and change
- *  to accept mtrx_t *m + solution vect.
+/** mtrx_trans_ip - transpose m in place. square matrices (any storage
+ *  other than packed) are transposed by m_trans_sq(). otherwise m must use
+ *  slab storage: rows are closed up to cols elements, the dense (rows x
+ *  cols) block is permuted to (cols x rows) following the cycles of the
+ *  index map i * cols + j -> j * rows + i (visited elements marked in a
+ *  bitmap of rows * cols bits), then rows are spread to the padded stride
+ *  if it fits in the slab (otherwise the stride is rows). returns 0 on
+ *  success, -1 on invalid storage or allocation failure (m unchanged).
+ */
+int mtrx_trans_ip (mtrx_t *m)
+{
+    unsigned char *seen = NULL;
+    size_t r, c, nel, stride, p, q, d;
+    register size_t i;
+    T **rows, v, tmp;
+
+    if (!m || MTRX_PACKED (m)) {
+        fprintf (stderr, "%s() error: invalid or packed matrix.\n",
+                __func__);
+        return -1;
+    }
+    r = m->rows;
+    c = m->cols;
+    nel = r * c;
+
+    if (r == c) {
+        m_trans_sq (m->mtrx, r);
+        goto transdone;
+    }
+    if (!m->slab) {
+        fprintf (stderr, "%s() error: (%zu x %zu) in place requires slab "
+                "storage.\n", __func__, r, c);
+        return -1;
+    }
+
+    if (m->rowmax < c) {        /* row pointers for c rows */
+        if (!(rows = realloc (m->mtrx, c * sizeof *rows))) {
+            fprintf (stderr, "%s() error: realloc-m->mtrx.\n", __func__);
+            return -1;
+        }
+        m->mtrx = rows;
+        m->rowmax = c;
+    }
+    if (!(seen = calloc (nel / CHAR_BIT + 1, 1))) {
+        fprintf (stderr, "%s() error: calloc-seen.\n", __func__);
+        return -1;
+    }
+
+    for (i = 1; i < r; i++)     /* close up rows to c elements */
+        memmove (m->slab + i * c, m->slab + i * m->stride, c * sizeof (T));
+
+    for (p = 1; p + 1 < nel; p++) {     /* first and last do not move */
+        if (seen[p / CHAR_BIT] & (1u << p % CHAR_BIT))
+            continue;
+        v = m->slab[p];
+        q = p;
+        do {                    /* carry v to its destination in turn */
+            d = q % c * r + q / c;
+            tmp = m->slab[d];
+            m->slab[d] = v;
+            v = tmp;
+            seen[d / CHAR_BIT] |= 1u << d % CHAR_BIT;
+            q = d;
+        } while (q != p);
+    }
+    free (seen);
+
+    stride = slab_stride (r);
+    if (c * stride <= r * m->stride)    /* spread from last row back */
+        for (i = c; i-- > 0;) {
+            memmove (m->slab + i * stride, m->slab + i * r, r * sizeof (T));
+            memset (m->slab + i * stride + r, 0, (stride - r) * sizeof (T));
+        }
+    else
+        stride = r;
+
+    for (i = 0; i < c; i++)
+        m->mtrx[i] = m->slab + i * stride;
+    for (; i < m->rowmax; i++)
+        m->mtrx[i] = NULL;
+
+    m->stride = stride;
+    m->rows = c;
+    m->colmax = m->cols = r;
+
+    m->band = 0;                /* (rows x rows) block changed */
+
+    transdone:;
+    d = m->kl;                  /* bandwidths exchange */
+    m->kl = m->ku;
+    m->ku = d;
+
+    return 0;
+}
+
+/* copy the (n x n) block of m to a new slab and factor it by blocked LU
+ * into piv. returns the factors on success, NULL on allocation failure,
+ * *info set as mtrx_lu_fact().
+ */
+static mtrx_t *lu_copy_fact (const mtrx_t *m, size_t *piv, int *info)
+{
+    const size_t n = m->rows;
+    register size_t i;
+    mtrx_t *lu;
+
+    if (!(lu = mtrx_create_slab (n, n)))
+        return NULL;
+    lu->rows = lu->cols = n;
+    for (i = 0; i < n; i++)
+        memcpy (lu->mtrx[i], m->mtrx[i], n * sizeof (T));
+
+    *info = mtrx_lu_fact (lu->mtrx, piv, n);
+
+    return lu;
+}
+
+/** mtrx_det - determinant of the (n x n) leading block of m (n = m->rows,
+ *  m->cols >= n) from the blocked LU of a copy, as the sign in *sign and
+ *  log |det| in *logdet, so it cannot overflow. the pivots are multiplied
+ *  as binary mantissa and exponent (frexp) rather than summing n logs.
+ *  a singular block gives sign 0 and logdet -INFINITY. returns 0 on
+ *  success, -1 on invalid matrix or allocation failure.
+ */
+int mtrx_det (const mtrx_t *m, int *sign, T *logdet)
+{
+    mtrx_t *lu = NULL;
+    size_t *piv = NULL;
+    register size_t i;
+    long ex = 0;
+    int info, e;
+    T mant = 1.0;
+
+    if (!m || m->cols < m->rows || MTRX_PACKED (m)) {
+        fprintf (stderr, "%s() error: invalid mtrx_t (cols < rows or "
+                "packed)\n", __func__);
+        return -1;
+    }
+
+    if (!(piv = malloc ((m->rows ? m->rows : 1) * sizeof *piv)) ||
+        !(lu = lu_copy_fact (m, piv, &info))) {
+        fprintf (stderr, "%s() error: allocation failed.\n", __func__);
+        free (piv);
+        return -1;
+    }
+
+    *sign = info ? 0 : 1;
+    *logdet = -INFINITY;
+    for (i = 0; *sign && i < m->rows; i++) {
+        const T u = lu->mtrx[i][i];
+
+        if ((piv[i] != i) ^ (u < 0.0))  /* interchange or negative pivot */
+            *sign = -*sign;
+        mant *= frexp (fabs (u), &e);   /* [0.25, 1), renormalized */
+        ex += e;
+        mant = frexp (mant, &e);
+        ex += e;
+    }
+    if (*sign)
+        *logdet = log (mant) + ex * log (2.0);
+
+    mtrx_free (lu);
+    free (piv);
+
+    return 0;
+}
+
+/* solve the (n x n) system m x = v (n != 3) by blocked LU of a copy */
+static T *lu_solv_v (const mtrx_t *m, const T *v)
+{
+    mtrx_t *lu = NULL;
+    size_t *piv = NULL;
+    int info = 0;
+    T *sol = NULL;
+
+    if (!(piv = malloc ((m->rows ? m->rows : 1) * sizeof *piv)) ||
+        !(sol = malloc ((m->rows ? m->rows : 1) * sizeof *sol)) ||
+        !(lu = lu_copy_fact (m, piv, &info))) {
+        fprintf (stderr, "%s() error: memory exhausted.\n", __func__);
+        goto solvfail;
+    }
+    if (info) {
+        fprintf (stderr, "%s() error: singular matrix, no unique "
+                "solution.\n", __func__);
+        goto solvfail;
+    }
+
+    memcpy (sol, v, m->rows * sizeof *sol);
+    mtrx_lu_solv (lu->mtrx, piv, sol, m->rows);
+    mtrx_free (lu);
+    free (piv);
+
+    /* check if solution vector is zero - trivial solution */
+    if (v_is_zero_fp (sol, m->rows)) {
+        printf ("The system has a trivial solution.\n");
+        free (sol);
+        return NULL;
+    }
+
+    return sol;
+
+    solvfail:;
+    if (lu)
+        mtrx_free (lu);
+    free (piv);
+    free (sol);
+
+    return NULL;
+}
+
+/** solve system of equations. (3 x 3) by the cofactor method, which also
+ *  classifies singular systems (infinite or no solution), other orders by
+ *  blocked LU (see mtrx_det() for the determinant of any order).
  */
 T *mtrx_solv (const mtrx_t *m, const T *v)
 {
@@ -816,6 +1546,9 @@ T *mtrx_solv (const mtrx_t *m, const T *v)
         return NULL;
     }
 
+    if (m->rows != 3)           /* cofactor method is (3 x 3) only */
+        return lu_solv_v (m, v);
+
     /* allocate/validate solution vector */
     if (!(sol = calloc (m->rows, sizeof *sol))) {
         fprintf (stderr, "%s() error: memory exhausted 'sol'.\n", __func__);
@@ -895,12 +1628,49 @@ T *mtrx_solv (const mtrx_t *m, const T *v)
     return sol; /* return unique solution vector */
 }
 
+/* solve (n x n+1) m, n <= FIX_NMAX, by the unrolled solver. returns the
+ * solution vector, NULL with *info j + 1 if singular (-1 on allocation
+ * failure) or a trivial (zero) solution.
+ */
+static T *fix_solv_cmb (const mtrx_t *m, int *info)
+{
+    T a[FIX_NMAX * FIX_NMAX] = { 0 }, b[FIX_NMAX] = { 0 }, *sol;
+    const size_t n = m->rows;
+    register size_t i, j;
+
+    if (!(sol = calloc (n, sizeof *sol))) {
+        fprintf (stderr, "%s() error: memory exhausted 'sol'.\n", __func__);
+        *info = -1;
+        return NULL;
+    }
+
+    for (i = 0; i < n; i++) {
+        for (j = 0; j < n; j++)
+            a[i * n + j] = m->mtrx[i][j];
+        b[i] = m->mtrx[i][n];
+    }
+
+    if ((*info = mtrx_fix_solv (a, b, sol, n))) {
+        free (sol);
+        return NULL;
+    }
+
+    if (v_is_zero_fp (sol, n)) {    /* as mtrx_solv() */
+        printf ("The system has a trivial solution.\n");
+        free (sol);
+        return NULL;
+    }
+
+    return sol;
+}
+
 /** mtrx_solv_cmb - solves system of eq where m contains solution vect.
  *  solves system where m contains the solution vector as the last column
  *  in the form {m} = {m'}[v] where {m'} is the coefficient matrix and [v]
- *  the solution vector. it is a wrapper for mtrx_solv() above. returns
- *  a vector containing the unique solution or NULL if {m'} is singular
- *  or the solutions are infinite or trivial.
+ *  the solution vector. systems of order FIX_NMIN -> FIX_NMAX are solved
+ *  by the unrolled fixed order solvers, others (and singular (3 x 3)) by
+ *  mtrx_solv() above. returns a vector containing the unique solution or
+ *  NULL if {m'} is singular or the solutions are infinite or trivial.
  */
 T *mtrx_solv_cmb (mtrx_t *m)
 {
@@ -909,6 +1679,19 @@ T *mtrx_solv_cmb (mtrx_t *m)
         *sol = NULL;    /* unique solution vector */
     register size_t i;
 
+    if (m->cols == m->rows + 1 && m->rows >= FIX_NMIN &&
+        m->rows <= FIX_NMAX) {      /* unrolled solver, no copies */
+        int info = 0;
+
+        if ((sol = fix_solv_cmb (m, &info)) || info <= 0)
+            return sol;
+        if (m->rows != 3) {
+            fprintf (stderr, "%s() error: singular matrix, no unique "
+                    "solution.\n", __func__);
+            return NULL;
+        }
+    }   /* singular (3 x 3), cofactor method classifies the system */
+
     /* create matrix struct for mc */
     if (!(mc = calloc (1, sizeof *mc)))
         return NULL;
@@ -943,37 +1726,237 @@ static void SWAP (T *a, T *b)
     *b = tmp;
 }
 
+/* exchange row pointers i and j */
+static void SWAPROW (T **a, const size_t i, const size_t j)
+{
+    T *tmp = a[i];
+    a[i] = a[j];
+    a[j] = tmp;
+}
+
+/** mtrx_piv_row - fold row i (cols c0 -> n-1 with msk[j] != 0, msk NULL
+ *  all) into a running full pivot search, keeping the last maximum (>=)
+ *  in row-major order.
+ */
+void mtrx_piv_row (const T *row, const size_t i, const size_t c0,
+                   const size_t n, const T *msk,
+                   T *big, size_t *irow, size_t *icol)
+{
+    size_t j = c0 + mtrx_kern.iamax (n - c0, row + c0, msk ? msk + c0 : NULL);
+
+    if (j < n && fabs (row[j]) >= *big) {
+        *big = fabs (row[j]);
+        *irow = i;
+        *icol = j;
+    }
+}
+
+static int piv_cfg = PIV_FULL;  /* pivoting used by mtrx_solv_gauss */
+
+/** mtrx_piv_set - set pivoting used by the solve only Gaussian solvers,
+ *  PIV_FULL or PIV_ROOK. returns the mode set (unknown modes are ignored).
+ */
+int mtrx_piv_set (const int mode)
+{
+    if (mode == PIV_FULL || mode == PIV_ROOK)
+        piv_cfg = mode;
+
+    return piv_cfg;
+}
+
+/** mtrx_piv_get - get pivoting used by the solve only Gaussian solvers */
+int mtrx_piv_get (void)
+{
+    return piv_cfg;
+}
+
+/** mtrx_piv_cmax - exact column maxima of a[k..n-1][k..n-1] in cmax[k..],
+ *  a single row-wise pass to seed the bounds used by mtrx_piv_rook().
+ */
+void mtrx_piv_cmax (T * const *a, const size_t n, const size_t k, T *cmax)
+{
+    register size_t i, j;
+
+    for (j = k; j < n; j++)
+        cmax[j] = 0.0;
+
+    for (i = k; i < n; i++)
+        for (j = k; j < n; j++)
+            if (fabs (a[i][j]) > cmax[j])
+                cmax[j] = fabs (a[i][j]);
+}
+
+/* row of largest element in column c of a[k..n-1], *big set to its fabs */
+static size_t colmax (T * const *a, const size_t n, const size_t k,
+                      const size_t c, T *big)
+{
+    register size_t i, r = k;
+
+    *big = 0.0;
+    for (i = k; i < n; i++)
+        if (fabs (a[i][c]) > *big) {
+            *big = fabs (a[i][c]);
+            r = i;
+        }
+
+    return r;
+}
+
+/** mtrx_piv_rook - rook pivot search of the active block a[k..n-1][k..n-1].
+ *  starting at the column with the largest bound in cmax[], alternates
+ *  column and row searches until a[irow][icol] is the largest element in
+ *  both its row and its column. cmax[j] is an upper bound on fabs of
+ *  column j of the active block, made exact for each column searched.
+ *  each search is O(n), so a pivot costs O(n) rather than the O(n^2)
+ *  full search. returns fabs of the pivot, 0.0 if the block is singular.
+ */
+T mtrx_piv_rook (T * const *a, const size_t n, const size_t k, T *cmax,
+                 size_t *irow, size_t *icol)
+{
+    T big = -1.0, cbig;
+    size_t c = k, j, r;
+
+    for (j = k; j < n; j++)     /* start at largest column bound */
+        if (cmax[j] > big) {
+            big = cmax[j];
+            c = j;
+        }
+
+    r = colmax (a, n, k, c, &big);
+    cmax[c] = big;
+
+    for (;;) {
+        j = k + mtrx_kern.iamax (n - k, a[r] + k, NULL);
+        if (fabs (a[r][j]) <= big)  /* max of row, and of column */
+            break;
+        c = j;
+        big = fabs (a[r][c]);
+
+        j = colmax (a, n, k, c, &cbig);
+        cmax[c] = cbig;
+        if (cbig <= big)            /* max of column, and of row */
+            break;
+        r = j;
+        big = cbig;
+    }
+
+    *irow = r;
+    *icol = c;
+
+    return big;
+}
+
+/** mtrx_gauss_xchg - exchange row irow (by pointer) and col icol with k
+ *  for pivot step k, recording the exchanges in perm (cols) and rp (rows,
+ *  if not NULL). with rook bounds cmax (if not NULL) the bounds follow the
+ *  col exchange and are raised by row k.
+ */
+void mtrx_gauss_xchg (T **a, const size_t n, const size_t k,
+                      const size_t irow, const size_t icol,
+                      size_t *perm, size_t *rp, T *cmax)
+{
+    register size_t i, j;
+
+    if (irow != k) {    /* exchange rows by pointer */
+        SWAPROW (a, irow, k);
+        if (rp) {
+            j = rp[k];
+            rp[k] = rp[irow];
+            rp[irow] = j;
+        }
+    }
+    if (icol != k) {    /* exchange columns, record exchange */
+        for (i = 0; i < n; i++)
+            SWAP (&a[i][k], &a[i][icol]);
+        j = perm[k];
+        perm[k] = perm[icol];
+        perm[icol] = j;
+        if (cmax)
+            SWAP (&cmax[k], &cmax[icol]);
+    }
+    if (cmax)   /* multipliers <= 1, |a - l u| <= |a| + |u| */
+        for (j = k + 1; j < n; j++)
+            cmax[j] += fabs (a[k][j]);
+}
+
+/** mtrx_gauss_elim - eliminate col k below the pivot a[k][k] from rows
+ *  lo -> hi-1 (multipliers kept in L), only the cols right of the pivot
+ *  updated. with big not NULL each row is then folded into the search
+ *  for the next pivot (cols k+1 -> n-1) while it is in cache.
+ */
+void mtrx_gauss_elim (T **a, const size_t n, const size_t k,
+                      const size_t lo, const size_t hi,
+                      T *big, size_t *irow, size_t *icol)
+{
+    const T pivinv = 1.0 / a[k][k];
+    register size_t i;
+
+    for (i = lo; i < hi; i++) {
+        T dum = a[i][k] *= pivinv;
+        mtrx_kern.axpy (n - k, -dum, a[k] + k + 1, a[i] + k + 1);
+        if (big)
+            mtrx_piv_row (a[i], i, k + 1, n, NULL, big, irow, icol);
+    }
+}
+
+/** mtrx_gauss_back - back substitution of the reduced (n x n+1) system
+ *  using y (n) for the permuted solution, unscrambled by perm into the
+ *  last col.
+ */
+void mtrx_gauss_back (T **a, const size_t n, const size_t *perm, T *y)
+{
+    register size_t j;
+    size_t k = n;
+
+    while (k--) {
+        T sum = a[k][n];
+        for (j = k + 1; j < n; j++)
+            sum -= a[k][j] * y[j];
+        y[k] = sum / a[k][k];
+    }
+
+    for (k = 0; k < n; k++)
+        a[perm[k]][n] = y[k];
+}
+
 /** Guass-Jordan elimination with full pivoting.
  *  'a' is coefficient matrix with constant vector as last col.
  *  on return 'a' contains matrix inverse, last col contains
  *  solution vector.
  */
-void mtrx_solv_gaussj (T **a, const size_t n)
-{   /* bookkeeping arrays for pivot */
+int mtrx_solv_gaussj (T **a, const size_t n)
+{
+    return mtrx_solv_gaussj_st (a, n, NULL);
+}
+
+/** mtrx_solv_gaussj_st - mtrx_solv_gaussj() recording log|det|, sign and
+ *  growth from the pivots and the exact condition number from the inverse
+ *  in st (if not NULL), O(n^2) in addition to the solve.
+ */
+int mtrx_solv_gaussj_st (T **a, const size_t n, mtrx_stat_t *st)
+{   /* bookkeeping arrays for pivot, msk[k] 1.0 while col k unpivoted */
     int *indxc = calloc (n, sizeof *indxc),
         *indxr = calloc (n, sizeof *indxr),
         *ipiv  = calloc (n, sizeof *ipiv);
+    T *msk = calloc (n, sizeof *msk);
     T big, dum, pivinv;
-    size_t i, icol = 0, irow = 0, j, k, l, ll;
+    size_t i, icol = 0, irow = 0, j, k, l, ll, pcol = 0, prow = 0;
+    int info = 0;
+
+    if (st)
+        mtrx_stat_init (st, a, n);
+
+    for (j = 0; j < n; j++) ipiv[j] = 0, msk[j] = 1.0;
+    big = 0.0;
+    for (j = 0; j < n; j++)     /* last max of unpivoted cols and rows */
+        mtrx_piv_row (a[j], j, 0, n, msk, &big, &irow, &icol);
 
-    for (j = 0; j < n; j++) ipiv[j] = 0;
     for (i = 0; i < n; i++) {
-        big = 0.0;
-        for (j = 0; j < n; j++)
-            if (ipiv[j] != 1)
-                for (k = 0; k < n; k++) {
-                    if (ipiv[k] == 0) {
-                        if (fabs (a[j][k]) >= big) {
-                            big = fabs (a[j][k]);
-                            irow = j;
-                            icol = k;
-                        }
-                    }
-                }
         ipiv[icol]++;
+        msk[icol] = 0.0;
 
         if (irow != icol)   /* transpose row/col */
-            for (l = 0; l < n + 1; l++) SWAP(&a[irow][l], &a[icol][l]);
+            mtrx_kern.swap (n + 1, a[irow], a[icol]);
 
         indxr[i] = irow;
         indxc[i] = icol;
@@ -981,20 +1964,28 @@ void mtrx_solv_gaussj (T **a, const size_t n)
         if (a[icol][icol] == 0.0) {
             /* nrerror ("gaussj: Singular Matrix"); */
             fprintf (stderr, "guassj() error: singular matrix.\n");
+            info = 1;
             goto gaussjdone;
         }
 
+        if (st)
+            mtrx_stat_piv (st, a[icol][icol], irow != icol);
         pivinv = 1.0 / a[icol][icol];
         a[icol][icol] = 1.0;
 
-        for (l = 0; l < n + 1; l++) a[icol][l] *= pivinv;
+        mtrx_kern.scal (n + 1, pivinv, a[icol]);
 
+        big = 0.0;  /* eliminate, searching rows for next pivot in cache */
         for (ll = 0; ll < n; ll++)
             if (ll != icol) {
                 dum = a[ll][icol];
                 a[ll][icol] = 0.0;
-                for (l = 0; l < n + 1; l++) a[ll][l] -= a[icol][l] * dum;
+                mtrx_kern.axpy (n + 1, -dum, a[icol], a[ll]);
+                if (ipiv[ll] != 1)
+                    mtrx_piv_row (a[ll], ll, 0, n, msk, &big, &prow, &pcol);
             }
+        irow = prow;
+        icol = pcol;
     }
 
     l = n;
@@ -1003,43 +1994,43 @@ void mtrx_solv_gaussj (T **a, const size_t n)
             for (k = 0; k < n; k++)
                 SWAP(&a[k][indxr[l]],&a[k][indxc[l]]);
     }
+    if (st)
+        mtrx_stat_inv (st, a, n);
     gaussjdone:;
 
+    free (msk);
     free (ipiv);
     free (indxr);
     free (indxc);
+
+    return info;
 }
 
 /** same taking a (n x n) and v. TODO preserve T * const * a by making a copy
  *  allocating for the inverse and returing the inverse while letting the
  *  solution vector be available to the caller through the updated v.
  */
-void mtrx_solv_gaussj_v (T **a, T *v, const size_t n)
-{   /* bookkeeping arrays for pivot */
+int mtrx_solv_gaussj_v (T **a, T *v, const size_t n)
+{   /* bookkeeping arrays for pivot, msk[k] 1.0 while col k unpivoted */
     int *indxc = calloc (n, sizeof *indxc),
         *indxr = calloc (n, sizeof *indxr),
         *ipiv  = calloc (n, sizeof *ipiv);
+    T *msk = calloc (n, sizeof *msk);
     T big, dum, pivinv;
-    size_t i, icol = 0, irow = 0, j, k, l, ll;
+    size_t i, icol = 0, irow = 0, j, k, l, ll, pcol = 0, prow = 0;
+    int info = 0;
+
+    for (j = 0; j < n; j++) ipiv[j] = 0, msk[j] = 1.0;
+    big = 0.0;
+    for (j = 0; j < n; j++)     /* last max of unpivoted cols and rows */
+        mtrx_piv_row (a[j], j, 0, n, msk, &big, &irow, &icol);
 
-    for (j = 0; j < n; j++) ipiv[j] = 0;
     for (i = 0; i < n; i++) {
-        big = 0.0;
-        for (j = 0; j < n; j++)
-            if (ipiv[j] != 1)
-                for (k = 0; k < n; k++) {
-                    if (ipiv[k] == 0) {
-                        if (fabs (a[j][k]) >= big) {
-                            big = fabs (a[j][k]);
-                            irow = j;
-                            icol = k;
-                        }
-                    }
-                }
         ipiv[icol]++;
+        msk[icol] = 0.0;
 
         if (irow != icol) {  /* transpose row/col */
-            for (l = 0; l < n; l++) SWAP(&a[irow][l], &a[icol][l]);
+            mtrx_kern.swap (n, a[irow], a[icol]);
             SWAP (&v[irow], &v[icol]);
         }
         indxr[i] = irow;
@@ -1048,22 +2039,28 @@ void mtrx_solv_gaussj_v (T **a, T *v, const size_t n)
         if (a[icol][icol] == 0.0) {
             /* nrerror ("gaussj: Singular Matrix"); */
             fprintf (stderr, "guassj() error: singular matrix.\n");
+            info = 1;
             goto gaussjdone;
         }
 
         pivinv = 1.0 / a[icol][icol];
         a[icol][icol] = 1.0;
 
-        for (l = 0; l < n; l++) a[icol][l] *= pivinv;
+        mtrx_kern.scal (n, pivinv, a[icol]);
         v[icol] *= pivinv;
 
+        big = 0.0;  /* eliminate, searching rows for next pivot in cache */
         for (ll = 0; ll < n; ll++)
             if (ll != icol) {
                 dum = a[ll][icol];
                 a[ll][icol] = 0.0;
-                for (l = 0; l < n; l++) a[ll][l] -= a[icol][l] * dum;
+                mtrx_kern.axpy (n, -dum, a[icol], a[ll]);
                 v[ll] -= v[icol] * dum;
+                if (ipiv[ll] != 1)
+                    mtrx_piv_row (a[ll], ll, 0, n, msk, &big, &prow, &pcol);
             }
+        irow = prow;
+        icol = pcol;
     }
 
     l = n;
@@ -1074,9 +2071,104 @@ void mtrx_solv_gaussj_v (T **a, T *v, const size_t n)
     }
     gaussjdone:;
 
+    free (msk);
     free (ipiv);
     free (indxr);
     free (indxc);
+
+    return info;
+}
+
+/** mtrx_solv_gauss - solve only, Gaussian elimination with full pivoting.
+ *  'a' is coefficient matrix with constant vector as last col. reduces the
+ *  system to upper triangular form (rows exchanged by pointer, columns in
+ *  place with the exchange recorded) followed by back substitution. no
+ *  inverse is formed and only the solution vector is unscrambled. the
+ *  search for the next pivot is folded into the elimination of each row
+ *  while it is in cache, or with mtrx_piv_set (PIV_ROOK) rook pivoting on
+ *  incrementally bounded column maxima is used. on return the last col
+ *  contains the solution vector. returns 0 on success, 1 if 'a' is
+ *  singular.
+ */
+int mtrx_solv_gauss (T **a, const size_t n)
+{
+    return mtrx_solv_gauss_st (a, n, NULL);
+}
+
+/** mtrx_solv_gauss_st - mtrx_solv_gauss() recording log|det|, sign,
+ *  growth and the estimated condition number of the factors P A Q = L U
+ *  (multipliers kept below the diagonal) in st (if not NULL), O(n^2) in
+ *  addition to the solve.
+ */
+int mtrx_solv_gauss_st (T **a, const size_t n, mtrx_stat_t *st)
+{
+    size_t *perm = calloc (n, sizeof *perm);    /* column exchanges */
+    T *y = calloc (n, sizeof *y);               /* permuted solution */
+    T *cmax = NULL;                             /* rook column bounds */
+    size_t *rp = NULL;                          /* row exchanges (st) */
+    T big = 0.0;
+    size_t i, icol = 0, irow = 0, j, k;
+    int info = 0, rook = mtrx_piv_get() == PIV_ROOK;
+
+    if (!perm || !y) {
+        fprintf (stderr, "%s() error: calloc-perm/y.\n", __func__);
+        info = -1;
+        goto gaussdone;
+    }
+
+    if (st) {
+        if (!(rp = malloc (n * sizeof *rp))) {
+            fprintf (stderr, "%s() error: malloc-rp.\n", __func__);
+            info = -1;
+            goto gaussdone;
+        }
+        for (i = 0; i < n; i++)
+            rp[i] = i;
+        mtrx_stat_init (st, a, n);
+    }
+
+    if (rook) {
+        if (!(cmax = malloc (n * sizeof *cmax))) {
+            fprintf (stderr, "%s() error: malloc-cmax.\n", __func__);
+            info = -1;
+            goto gaussdone;
+        }
+        mtrx_piv_cmax (a, n, 0, cmax);
+    }
+    else
+        for (i = 0; i < n; i++)     /* max of (n x n) */
+            mtrx_piv_row (a[i], i, 0, n, NULL, &big, &irow, &icol);
+
+    for (j = 0; j < n; j++)
+        perm[j] = j;
+
+    for (k = 0; k < n; k++) {
+        if (rook)
+            big = mtrx_piv_rook (a, n, k, cmax, &irow, &icol);
+
+        if (big == 0.0) {
+            fprintf (stderr, "%s() error: singular matrix.\n", __func__);
+            info = 1;
+            goto gaussdone;
+        }
+
+        mtrx_gauss_xchg (a, n, k, irow, icol, perm, rp, cmax);
+
+        big = 0.0;  /* eliminate below pivot, search (n-k-1 x n-k-1) */
+        mtrx_gauss_elim (a, n, k, k + 1, n, rook ? NULL : &big, &irow, &icol);
+    }
+
+    mtrx_gauss_back (a, n, perm, y);
+    if (st)
+        mtrx_stat_lu (st, a, rp, perm, n);
+    gaussdone:;
+
+    free (rp);
+    free (cmax);
+    free (y);
+    free (perm);
+
+    return info;
 }
 
 /** mtrx_solv_gaussj_inv returns mtrx_t containing inverse + solution.
@@ -1102,29 +2194,681 @@ mtrx_t *mtrx_solv_gaussj_inv (const mtrx_t *m)
     return invsol;
 }
 
+/** lu_panel - unblocked LU of the (n - k x kb) panel starting at a[k][k].
+ *  partial pivoting searches the full column below the diagonal, rows are
+ *  exchanged by pointer so the exchange applies to every column (including
+ *  any carried constant columns). updates are confined to the panel.
+ *  returns 0 or the 1-based index of the first exactly zero pivot.
+ */
+static int lu_panel (T **a, size_t *piv, const size_t k, const size_t kb,
+                    const size_t n)
+{
+    int info = 0;
+    register size_t i, j;
+    const size_t kend = k + kb;
+
+    for (j = k; j < kend; j++) {
+        size_t p = j;
+        T big = fabs (a[j][j]), pivinv;
+
+        for (i = j + 1; i < n; i++)     /* find pivot row */
+            if (fabs (a[i][j]) > big) {
+                big = fabs (a[i][j]);
+                p = i;
+            }
+        piv[j] = p;
+
+        if (p != j)
+            SWAPROW (a, p, j);
+
+        if (a[j][j] == 0.0) {           /* singular, record 1st zero pivot */
+            if (!info)
+                info = j + 1;
+            continue;
+        }
+
+        pivinv = 1.0 / a[j][j];
+        for (i = j + 1; i < n; i++) {   /* compute multipliers, update panel */
+            T lij = a[i][j] *= pivinv;
+            mtrx_kern.axpy (kend - j - 1, -lij, a[j] + j + 1, a[i] + j + 1);
+        }
+    }
+
+    return info;
+}
+
+/** lu_update - U12 solve and trailing update following panel k of width kb.
+ *  U12 is solved in LU_NC wide tiles of columns kend -> ncol, then the
+ *  trailing block is updated by the packed product mtrx_gemm(), rounding
+ *  as the row axpy update it replaces.
+ */
+static void lu_update (T **a, const size_t k, const size_t kb,
+                        const size_t n, const size_t ncol)
+{
+    register size_t i, p;
+    size_t j0, j1;
+    const size_t kend = k + kb;
+
+    for (j0 = kend; j0 < ncol; j0 += LU_NC) {
+        j1 = j0 + LU_NC < ncol ? j0 + LU_NC : ncol;
+
+        /* U12 = L11^-1 A12 (unit lower forward substitution) */
+        for (i = k + 1; i < kend; i++)
+            for (p = k; p < i; p++)
+                mtrx_kern.axpy (j1 - j0, -a[i][p], a[p] + j0, a[i] + j0);
+    }
+
+    /* A22 -= L21 U12 */
+    if (kend < n && kend < ncol)
+        mtrx_gemm (n - kend, ncol - kend, kb, -1.0, a + kend, k,
+                   a + k, kend, 1.0, a + kend, kend);
+}
+
+/** lu_fact - blocked LU of the first n cols of the (m x ncol) block,
+ *  m >= n. any columns beyond n receive the same row exchanges and
+ *  updates, so on return they hold L^-1 P b for each carried constant
+ *  column.
+ */
+static int lu_fact (T **a, size_t *piv, const size_t m, const size_t n,
+                    const size_t ncol)
+{
+    int info = 0, rtn;
+    size_t k, kb;
+
+    for (k = 0; k < n; k += LU_NB) {
+        kb = n - k < LU_NB ? n - k : LU_NB;
+
+        if ((rtn = lu_panel (a, piv, k, kb, m)) && !info)
+            info = rtn;
+
+        lu_update (a, k, kb, m, ncol);
+    }
+
+    return info;
+}
+
+/** mtrx_lu_fact - right-looking blocked LU with partial pivoting.
+ *  factors the (n x n) leading block of 'a' in place as P a = L U with
+ *  L unit lower (below diagonal) and U upper. rows are interchanged by
+ *  exchanging row pointers, piv[k] holds the row exchanged with row k at
+ *  step k. returns 0 on success, k + 1 if U[k][k] is exactly zero.
+ */
+int mtrx_lu_fact (T **a, size_t *piv, const size_t n)
+{
+    return lu_fact (a, piv, n, n, n);
+}
+
+/** mtrx_lu_fact_rect - mtrx_lu_fact() of the first n cols of the (m x ncol)
+ *  block of 'a', m >= n (a panel of a larger matrix). pivots are searched
+ *  over all m rows and the exchanges and updates are carried through cols
+ *  n -> ncol. returns 0 on success, k + 1 if U[k][k] is exactly zero.
+ */
+int mtrx_lu_fact_rect (T **a, size_t *piv, const size_t m, const size_t n,
+                       const size_t ncol)
+{
+    return lu_fact (a, piv, m, n, ncol);
+}
+
+/** mtrx_lu_solv - solve a x = b from mtrx_lu_fact factors and pivots.
+ *  applies piv to b, then forward and back substitution, b is overwritten
+ *  with the solution vector.
+ */
+void mtrx_lu_solv (T * const *lu, const size_t *piv, T *b, const size_t n)
+{
+    register size_t i, j;
+
+    for (i = 0; i < n; i++)     /* apply row interchanges */
+        if (piv[i] != i)
+            SWAP (&b[i], &b[piv[i]]);
+
+    for (i = 1; i < n; i++) {   /* forward substitution, unit L */
+        T sum = b[i];
+        for (j = 0; j < i; j++)
+            sum -= lu[i][j] * b[j];
+        b[i] = sum;
+    }
+
+    i = n;
+    while (i--) {               /* back substitution, U */
+        T sum = b[i];
+        for (j = i + 1; j < n; j++)
+            sum -= lu[i][j] * b[j];
+        b[i] = sum / lu[i][i];
+    }
+}
+
+/** lu_fsolv - blocked forward substitution L Y = B (L unit lower in rows
+ *  lu) for the nrhs columns jx -> jx+nrhs-1 of rows x, as lu_bsolv() top
+ *  down.
+ */
+static void lu_fsolv (T * const *lu, T * const *x, const size_t jx,
+                      const size_t n, const size_t nrhs)
+{
+    register size_t i, p;
+    size_t j0, j1, k, kend;
+    const size_t ncol = jx + nrhs;
+
+    for (k = 0; k < n; k = kend) {
+        kend = k + LU_NB < n ? k + LU_NB : n;
+
+        for (j0 = jx; j0 < ncol; j0 += LU_NC) {
+            j1 = j0 + LU_NC < ncol ? j0 + LU_NC : ncol;
+
+            /* Y1 -= L10 Y0 */
+            for (i = k; i < kend; i++)
+                for (p = 0; p < k; p++)
+                    mtrx_kern.axpy (j1 - j0, -lu[i][p], x[p] + j0, x[i] + j0);
+
+            /* Y1 = L11^-1 Y1 */
+            for (i = k + 1; i < kend; i++)
+                for (p = k; p < i; p++)
+                    mtrx_kern.axpy (j1 - j0, -lu[i][p], x[p] + j0, x[i] + j0);
+        }
+    }
+}
+
+/** lu_bsolv - blocked back substitution U X = Y (U in rows lu) for the
+ *  nrhs columns jx -> jx+nrhs-1 of rows x (x may be lu, jx = n, Y from
+ *  lu_fact carrying the columns). LU_NB row blocks are solved bottom-up in
+ *  LU_NC wide column tiles, the update of each block by the rows already
+ *  solved is a (kb x n-kend) by (n-kend x LU_NC) product so each solved
+ *  row is reused kb times.
+ */
+static void lu_bsolv (T * const *lu, T * const *x, const size_t jx,
+                      const size_t n, const size_t nrhs)
+{
+    register size_t i, p;
+    size_t j0, j1, k = n, kb, kend;
+    const size_t ncol = jx + nrhs;
+
+    while (k) {
+        kb = k < LU_NB ? k : LU_NB;
+        kend = k;
+        k -= kb;
+
+        for (j0 = jx; j0 < ncol; j0 += LU_NC) {
+            j1 = j0 + LU_NC < ncol ? j0 + LU_NC : ncol;
+
+            /* X1 -= U12 X2 */
+            for (i = k; i < kend; i++)
+                for (p = kend; p < n; p++)
+                    mtrx_kern.axpy (j1 - j0, -lu[i][p], x[p] + j0, x[i] + j0);
+
+            /* X1 = U11^-1 X1 */
+            i = kend;
+            while (i-- > k) {
+                for (p = i + 1; p < kend; p++)
+                    mtrx_kern.axpy (j1 - j0, -lu[i][p], x[p] + j0, x[i] + j0);
+                mtrx_kern.scal (j1 - j0, 1.0 / lu[i][i], x[i] + j0);
+            }
+        }
+    }
+}
+
+/** mtrx_lu_solv_m - solve a X = B from mtrx_lu_fact factors and pivots
+ *  for the nrhs cols jb -> jb+nrhs-1 of rows b, B overwritten with X.
+ *  row interchanges, then blocked forward and back substitution (level-3
+ *  for nrhs > 1 as mtrx_solv_lu_m()).
+ */
+void mtrx_lu_solv_m (T * const *lu, const size_t *piv, T * const *b,
+                     const size_t jb, const size_t n, const size_t nrhs)
+{
+    register size_t i;
+
+    for (i = 0; i < n; i++)     /* apply row interchanges */
+        if (piv[i] != i)
+            mtrx_kern.swap (nrhs, b[i] + jb, b[piv[i]] + jb);
+
+    lu_fsolv (lu, b, jb, n, nrhs);
+    lu_bsolv (lu, b, jb, n, nrhs);
+}
+
+/** mtrx_solv_lu_m - solve (n x n+nrhs) system by blocked LU.
+ *  'a' is coefficient matrix with nrhs constant vectors as the last cols.
+ *  the matrix is factored once with all constant columns carried through
+ *  the blocked trailing updates, followed by blocked back substitution
+ *  (level-3 for nrhs > 1). on return 'a' contains the LU factors (rows
+ *  permuted) and the last nrhs cols contain the (n x nrhs) solution.
+ *  returns 0 on success, non-zero if the matrix is singular.
+ */
+int mtrx_solv_lu_m (T **a, const size_t n, const size_t nrhs)
+{
+    return mtrx_solv_lu_st (a, n, nrhs, NULL);
+}
+
+/** mtrx_solv_lu_st - mtrx_solv_lu_m() recording log|det|, sign, growth
+ *  and the estimated condition number of the factors in st (if not NULL),
+ *  O(n^2) in addition to the solve.
+ */
+int mtrx_solv_lu_st (T **a, const size_t n, const size_t nrhs,
+                     mtrx_stat_t *st)
+{
+    size_t *piv = calloc (n, sizeof *piv);
+    register size_t i, j;
+    int info;
+
+    if (!piv) {
+        fprintf (stderr, "%s() error: calloc-piv.\n", __func__);
+        return -1;
+    }
+
+    if (st)
+        mtrx_stat_init (st, a, n);
+
+    if ((info = lu_fact (a, piv, n, n, n + nrhs))) {
+        fprintf (stderr, "%s() error: singular matrix.\n", __func__);
+        free (piv);
+        return info;
+    }
+
+    if (st) {   /* row order from the interchanges */
+        size_t *rp = malloc (n * sizeof *rp);
+        if (rp) {
+            mtrx_piv_perm (piv, rp, n);
+            mtrx_stat_lu (st, a, rp, NULL, n);
+        }
+        else
+            mtrx_stat_na (st);
+        free (rp);
+    }
+
+    if (nrhs == 1) {
+        i = n;
+        while (i--) {           /* back substitution on constant column */
+            T sum = a[i][n];
+            for (j = i + 1; j < n; j++)
+                sum -= a[i][j] * a[j][n];
+            a[i][n] = sum / a[i][i];
+        }
+    }
+    else
+        lu_bsolv (a, a, n, n, nrhs);
+
+    free (piv);
+
+    return 0;
+}
+
+/* a[i0:i0+m][j0:j0+n] -= a[i0:i0+m][p0:p0+k] a[p0:p0+k][j0:j0+n], the
+ * largest dimension halved until all are within RLU_NB.
+ */
+static void rlu_gemm (T **a, const size_t i0, const size_t m,
+                      const size_t j0, const size_t n,
+                      const size_t p0, const size_t k)
+{
+    register size_t i, p;
+
+    if (m >= k && m > RLU_NB) {
+        rlu_gemm (a, i0, m / 2, j0, n, p0, k);
+        rlu_gemm (a, i0 + m / 2, m - m / 2, j0, n, p0, k);
+    }
+    else if (n > RLU_NW) {
+        rlu_gemm (a, i0, m, j0, n / 2, p0, k);
+        rlu_gemm (a, i0, m, j0 + n / 2, n - n / 2, p0, k);
+    }
+    else if (k > RLU_NB) {
+        rlu_gemm (a, i0, m, j0, n, p0, k / 2);
+        rlu_gemm (a, i0, m, j0, n, p0 + k / 2, k - k / 2);
+    }
+    else
+        for (i = i0; i < i0 + m; i++) {
+            for (p = p0; p + 4 <= p0 + k; p += 4) {  /* row i held 4 rows */
+                const T alpha[4] = { -a[i][p], -a[i][p + 1], -a[i][p + 2],
+                                     -a[i][p + 3] },
+                        *x[4] = { a[p] + j0, a[p + 1] + j0, a[p + 2] + j0,
+                                  a[p + 3] + j0 };
+                mtrx_kern.axpy4 (n, alpha, x, a[i] + j0);
+            }
+            for (; p < p0 + k; p++)
+                mtrx_kern.axpy (n, -a[i][p], a[p] + j0, a[i] + j0);
+        }
+}
+
+/* a[p0:p0+k][j0:j0+n] = L^-1 a[p0:p0+k][j0:j0+n], L the unit lower
+ * triangle of a[p0:p0+k][p0:p0+k], recursively halved.
+ */
+static void rlu_trsl (T **a, const size_t p0, const size_t k,
+                      const size_t j0, const size_t n)
+{
+    register size_t i, p;
+    const size_t h = k / 2;
+
+    if (n > RLU_NW) {          /* split wide right-hand sides */
+        rlu_trsl (a, p0, k, j0, n / 2);
+        rlu_trsl (a, p0, k, j0 + n / 2, n - n / 2);
+    }
+    else if (k > RLU_NB) {              /* L11 X1 = B1, B2 -= L21 X1 */
+        rlu_trsl (a, p0, h, j0, n);
+        rlu_gemm (a, p0 + h, k - h, j0, n, p0, h);
+        rlu_trsl (a, p0 + h, k - h, j0, n);
+    }
+    else
+        for (i = p0 + 1; i < p0 + k; i++)
+            for (p = p0; p < i; p++)
+                mtrx_kern.axpy (n, -a[i][p], a[p] + j0, a[i] + j0);
+}
+
+/* a[p0:p0+k][j0:j0+n] = U^-1 a[p0:p0+k][j0:j0+n], U the upper triangle
+ * of a[p0:p0+k][p0:p0+k], recursively halved.
+ */
+static void rlu_trsu (T **a, const size_t p0, const size_t k,
+                      const size_t j0, const size_t n)
+{
+    register size_t i, p;
+    const size_t h = k / 2;
+
+    if (n > RLU_NW) {
+        rlu_trsu (a, p0, k, j0, n / 2);
+        rlu_trsu (a, p0, k, j0 + n / 2, n - n / 2);
+    }
+    else if (k > RLU_NB) {              /* U22 X2 = B2, B1 -= U12 X2 */
+        rlu_trsu (a, p0 + h, k - h, j0, n);
+        rlu_gemm (a, p0, h, j0, n, p0 + h, k - h);
+        rlu_trsu (a, p0, h, j0, n);
+    }
+    else {
+        i = p0 + k;
+        while (i-- > p0) {
+            for (p = i + 1; p < p0 + k; p++)
+                mtrx_kern.axpy (n, -a[i][p], a[p] + j0, a[i] + j0);
+            mtrx_kern.scal (n, 1.0 / a[i][i], a[i] + j0);
+        }
+    }
+}
+
+/* recursive LU of cols c0 -> c0+nc, rows c0 -> m. rows are exchanged by
+ * pointer, so the exchanges of the left half reach the right half and
+ * any carried columns. returns 0 or the 1-based first zero pivot.
+ */
+static int rlu (T **a, size_t *piv, const size_t c0, const size_t nc,
+                const size_t m)
+{
+    const size_t h = nc / 2;
+    int info, rtn;
+
+    if (nc <= RLU_NB)
+        return lu_panel (a, piv, c0, nc, m);
+
+    info = rlu (a, piv, c0, h, m);                      /* [L11; L21] */
+    rlu_trsl (a, c0, h, c0 + h, nc - h);                /* U12 */
+    rlu_gemm (a, c0 + h, m - c0 - h, c0 + h, nc - h, c0, h);  /* A22 */
+    if ((rtn = rlu (a, piv, c0 + h, nc - h, m)) && !info)
+        info = rtn;
+
+    return info;
+}
+
+/** mtrx_rlu_fact - recursive (cache-oblivious) LU with partial pivoting.
+ *  the columns are split in half, the left half factored, the right half
+ *  updated, then factored, to a base case of RLU_NB cols. the triangular
+ *  solve and update are split the same way, so every level works on
+ *  blocks that halve until they fit whatever cache is present, without
+ *  a tuned block size. factors and pivots as mtrx_lu_fact(). returns 0
+ *  on success, k + 1 if U[k][k] is exactly zero.
+ */
+int mtrx_rlu_fact (T **a, size_t *piv, const size_t n)
+{
+    return rlu (a, piv, 0, n, n);
+}
+
+/** mtrx_solv_rlu_st - solve (n x n+nrhs) system by recursive LU. the
+ *  constant columns receive the row exchanges with the factorization and
+ *  are then solved by recursive forward and back substitution. on return
+ *  'a' contains the LU factors (rows permuted) and the last nrhs cols the
+ *  (n x nrhs) solution. statistics are recorded in st (if not NULL).
+ *  returns 0 on success, non-zero if the matrix is singular.
+ */
+int mtrx_solv_rlu_st (T **a, const size_t n, const size_t nrhs,
+                      mtrx_stat_t *st)
+{
+    size_t *piv = calloc (n ? n : 1, sizeof *piv);
+    int info;
+
+    if (!piv) {
+        fprintf (stderr, "%s() error: calloc-piv.\n", __func__);
+        return -1;
+    }
+
+    if (st)
+        mtrx_stat_init (st, a, n);
+
+    if ((info = rlu (a, piv, 0, n, n))) {
+        fprintf (stderr, "%s() error: singular matrix.\n", __func__);
+        free (piv);
+        return info;
+    }
+
+    if (st) {   /* row order from the interchanges */
+        size_t *rp = malloc (n * sizeof *rp);
+        if (rp) {
+            mtrx_piv_perm (piv, rp, n);
+            mtrx_stat_lu (st, a, rp, NULL, n);
+        }
+        else
+            mtrx_stat_na (st);
+        free (rp);
+    }
+
+    rlu_trsl (a, 0, n, n, nrhs);        /* Y = L^-1 P B */
+    rlu_trsu (a, 0, n, n, nrhs);        /* X = U^-1 Y */
+
+    free (piv);
+
+    return 0;
+}
+
+/** mtrx_solv_lu - solve (n x n+1) system by blocked LU.
+ *  'a' is coefficient matrix with constant vector as last col. the
+ *  constant column is carried through the factorization so only back
+ *  substitution remains. on return 'a' contains the LU factors (rows
+ *  permuted) and the last col contains the solution vector. returns 0
+ *  on success, non-zero if the matrix is singular.
+ */
+int mtrx_solv_lu (T **a, const size_t n)
+{
+    return mtrx_solv_lu_m (a, n, 1);
+}
+
+/* solve (n x n+1) m, n <= FIX_NMAX, by the unrolled solver, (and form
+ * the inverse in place for SOLV_GAUSSJ). if st is not NULL, log|det| and
+ * sign are taken from the unrolled LU and cond exactly from the inverse,
+ * growth is not available. m and st are unchanged if singular.
+ * returns 0 on success, j + 1 for a zero pivot at step j.
+ */
+static int fix_solv_sys (mtrx_t *m, const int method, mtrx_stat_t *st)
+{
+    T a[FIX_NMAX * FIX_NMAX], b[FIX_NMAX], x[FIX_NMAX],
+      inv[FIX_NMAX * FIX_NMAX];
+    const size_t n = m->rows;
+    register size_t i, j;
+    int info;
+
+    for (i = 0; i < n; i++) {
+        for (j = 0; j < n; j++)
+            a[i * n + j] = m->mtrx[i][j];
+        b[i] = m->mtrx[i][n];
+    }
+
+    if ((info = mtrx_fix_solv (a, b, x, n)))
+        return info;
+    if ((method == SOLV_GAUSSJ || st) && (info = mtrx_fix_inv (a, inv, n)))
+        return info;
+
+    if (st) {
+        T det = mtrx_fix_det (a, n), inrm = 0.0;
+
+        mtrx_stat_init (st, m->mtrx, n);
+        for (j = 0; j < n; j++) {       /* ||inv||_1, max col sum */
+            T sum = 0.0;
+            for (i = 0; i < n; i++)
+                sum += fabs (inv[i * n + j]);
+            if (sum > inrm)
+                inrm = sum;
+        }
+        st->cond = st->anrm * inrm;
+        st->logdet = log (fabs (det));
+        st->sign = det < 0.0 ? -1 : 1;
+        st->growth = NAN;
+    }
+
+    for (i = 0; i < n; i++) {
+        if (method == SOLV_GAUSSJ)
+            for (j = 0; j < n; j++)
+                m->mtrx[i][j] = inv[i * n + j];
+        m->mtrx[i][n] = x[i];
+    }
+
+    return 0;
+}
+
+/** mtrx_solv_sys - solve (n x n+k) system in m with solver 'method'. method
+ *  is one of SOLV_GAUSS (solution only), SOLV_GAUSSJ (inverse + solution),
+ *  SOLV_LU, SOLV_RLU (recursive LU) or SOLV_MIXED (float LU refined in
+ *  double, see mtrx_solv_mixed()). SOLV_GAUSS and SOLV_GAUSSJ use the
+ *  threaded row updates when mtrx_nthrd_set() is greater than 1. other than
+ *  for SOLV_GAUSSJ, narrow band systems (see mtrx_is_band()) are solved in
+ *  band storage, and with the default SOLV_GAUSS symmetric systems by
+ *  packed Cholesky or LDL^T (an explicit method is not overridden). other
+ *  than for SOLV_MIXED, systems with more than one constant column (k > 1)
+ *  are factored once by blocked LU. other than for SOLV_MIXED, non-singular
+ *  systems of order FIX_NMIN -> FIX_NMAX with one constant column are
+ *  solved by the unrolled fixed order solvers (mtrx_fixed.h). on return the
+ *  last k cols of m contain the (n x k) solution. a tall (m x n+1) system,
+ *  m >= n+1, is solved in the least-squares sense by blocked Householder QR
+ *  whatever the method (mtrx_solv_ls()), the n unknowns returned in rows
+ *  0 -> n-1 of the last col. returns 0 on success, non-zero otherwise.
+ */
+int mtrx_solv_sys (mtrx_t *m, const int method)
+{
+    return mtrx_solv_sys_st (m, method, NULL);
+}
+
+/** mtrx_solv_sys_st - mtrx_solv_sys() returning the statistics of the
+ *  factorization in st (if not NULL), see mtrx_stat_t. the unrolled small
+ *  solvers report growth NAN, band and SOLV_MIXED solves anrm and amax
+ *  only (other fields NAN/0), least-squares solves none.
+ */
+int mtrx_solv_sys_st (mtrx_t *m, const int method, mtrx_stat_t *st)
+{
+    if (m && m->rows >= m->cols && m->cols > 1) {   /* least squares */
+        if (st) {
+            mtrx_stat_na (st);
+            st->anrm = st->amax = NAN;
+        }
+        return mtrx_solv_ls (m->mtrx, m->rows, m->cols - 1, 1);
+    }
+
+    if (!m || m->cols <= m->rows) {
+        fprintf (stderr, "%s() error: invalid mtrx_t size (cols <= rows)\n",
+                __func__);
+        return -1;
+    }
+
+    if (m->cols == m->rows + 1 && m->rows >= FIX_NMIN &&
+        m->rows <= FIX_NMAX && method != SOLV_MIXED &&
+        fix_solv_sys (m, method, st) == 0)  /* singular falls through */
+        return 0;
+
+    if (method != SOLV_GAUSSJ) {
+        if (mtrx_is_band (m)) {     /* band LU/Thomas */
+            if (st) {
+                mtrx_stat_init (st, m->mtrx, m->rows);
+                mtrx_stat_na (st);
+            }
+            return mtrx_solv_band (m);
+        }
+        if (method == SOLV_GAUSS && mtrx_is_sym (m))   /* Cholesky/LDL^T */
+            return mtrx_solv_sym_st (m, st);
+    }
+
+    if (method == SOLV_MIXED) { /* float LU, double refinement */
+        if (st) {
+            mtrx_stat_init (st, m->mtrx, m->rows);
+            mtrx_stat_na (st);
+        }
+        return mtrx_solv_mixed (m, NULL);
+    }
+
+    if (method == SOLV_RLU)     /* recursive LU, any right-hand sides */
+        return mtrx_solv_rlu_st (m->mtrx, m->rows, m->cols - m->rows, st);
+
+    if (m->cols - m->rows > 1)  /* multiple right-hand sides */
+        return mtrx_solv_lu_st (m->mtrx, m->rows, m->cols - m->rows, st);
+
+    switch (method) {
+        case SOLV_GAUSSJ:
+            if (mtrx_nthrd_get() > 1)
+                return mtrx_solv_gaussj_thrd_st (m->mtrx, m->rows,
+                                                mtrx_nthrd_get(), st);
+            return mtrx_solv_gaussj_st (m->mtrx, m->rows, st);
+        case SOLV_GAUSS:
+            if (mtrx_nthrd_get() > 1)
+                return mtrx_solv_gauss_thrd_st (m->mtrx, m->rows,
+                                                mtrx_nthrd_get(), st);
+            return mtrx_solv_gauss_st (m->mtrx, m->rows, st);
+        case SOLV_LU:
+            return mtrx_solv_lu_st (m->mtrx, m->rows, 1, st);
+    }
+
+    fprintf (stderr, "%s() error: invalid solver method '%d'.\n",
+            __func__, method);
+
+    return -1;
+}
+
 /** mtrx_get_sol_v return solution vector from inverse+solution mtrx_t.
- *  m must be a square matrix + constant vector as final column. returns
+ *  m must be a square matrix + constant vector as final column, or a
+ *  solved least-squares system (rows >= cols, cols-1 unknowns). returns
  *  allocated solution vector on success, NULL otherwise.
  */
 T *mtrx_get_sol_v (const mtrx_t *m)
 {
     T *sol = NULL;
     register size_t i;
+    size_t n;
 
-    if (m->cols <= m->rows) {
-        fprintf (stderr, "%s() error: invalid mtrx_t size (cols <= rows)\n",
+    if (m->cols < 2) {
+        fprintf (stderr, "%s() error: invalid mtrx_t size (cols < 2)\n",
                 __func__);
         return NULL;
     }
+    n = m->cols <= m->rows ? m->cols - 1 : m->rows;    /* least squares */
 
-    if (!(sol = calloc (m->rows, sizeof *sol))) {
+    if (!(sol = calloc (n, sizeof *sol))) {
         fprintf (stderr, "%s() error: memory exhausted calloc-sol.\n",
                 __func__);
         return NULL;
     }
 
+    for (i = 0; i < n; i++)
+        sol[i] = m->mtrx[i][n];
+
+    return sol;
+}
+
+/** mtrx_get_sol_m return (n x k) solution block from solved mtrx_t.
+ *  m must be a square matrix + k constant vectors as final columns.
+ *  returns allocated (slab) mtrx_t on success, NULL otherwise.
+ */
+mtrx_t *mtrx_get_sol_m (const mtrx_t *m)
+{
+    mtrx_t *sol = NULL;
+    register size_t i;
+
+    if (m->cols <= m->rows) {
+        fprintf (stderr, "%s() error: invalid mtrx_t size (cols <= rows)\n",
+                __func__);
+        return NULL;
+    }
+
+    if (!(sol = mtrx_create_slab (m->rows, m->cols - m->rows)))
+        return NULL;
+    sol->rows = sol->rowmax;
+    sol->cols = sol->colmax;
+
     for (i = 0; i < m->rows; i++)
-        sol[i] = m->mtrx[i][m->rows];
+        memcpy (sol->mtrx[i], m->mtrx[i] + m->rows,
+                sol->cols * sizeof **sol->mtrx);
 
     return sol;
 }
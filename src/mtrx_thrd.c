@@ -0,0 +1,484 @@
+#define _POSIX_C_SOURCE 200809L     /* sysconf (_SC_NPROCESSORS_ONLN) */
+
+#include <unistd.h>
+
+#include "mtrx_thrd.h"
+#include "mtrx_simd.h"
+#include "mtrx_cond.h"
+
+static int nthrd_cfg = 1;   /* threads used by threaded solvers */
+
+/** mtrx_nthrd_set - set number of threads used by the threaded solvers.
+ *  n = 0 uses the number of online processors, n is clamped to
+ *  [1, MTRX_THRD_MAX]. returns the number of threads set.
+ */
+int mtrx_nthrd_set (int n)
+{
+    if (n == 0) {
+#ifdef _SC_NPROCESSORS_ONLN
+        long ncpu = sysconf (_SC_NPROCESSORS_ONLN);
+        n = ncpu > 0 ? (int)ncpu : 1;
+#else
+        n = 1;
+#endif
+    }
+    if (n < 1)
+        n = 1;
+    else if (n > MTRX_THRD_MAX)
+        n = MTRX_THRD_MAX;
+
+    return (nthrd_cfg = n);
+}
+
+/** mtrx_nthrd_get - get number of threads used by the threaded solvers */
+int mtrx_nthrd_get (void)
+{
+    return nthrd_cfg;
+}
+
+/** bar_init - initialize barrier for count threads, returns 0 on success */
+int bar_init (bar_t *b, const int count)
+{
+    b->count = count;
+    b->waiting = 0;
+    b->phase = 0;
+
+    if (pthread_mutex_init (&b->mtx, NULL))
+        return -1;
+    if (pthread_cond_init (&b->cv, NULL)) {
+        pthread_mutex_destroy (&b->mtx);
+        return -1;
+    }
+
+    return 0;
+}
+
+/** bar_destroy - release barrier resources */
+void bar_destroy (bar_t *b)
+{
+    pthread_cond_destroy (&b->cv);
+    pthread_mutex_destroy (&b->mtx);
+}
+
+/** bar_setcount - set count before the controlling thread first waits */
+void bar_setcount (bar_t *b, const int count)
+{
+    pthread_mutex_lock (&b->mtx);
+    b->count = count;
+    pthread_mutex_unlock (&b->mtx);
+}
+
+/** bar_wait - wait until count threads have arrived */
+void bar_wait (bar_t *b)
+{
+    unsigned phase;
+
+    pthread_mutex_lock (&b->mtx);
+    phase = b->phase;
+    if (++b->waiting == b->count) {     /* last to arrive releases all */
+        b->waiting = 0;
+        b->phase++;
+        pthread_cond_broadcast (&b->cv);
+    }
+    else
+        while (phase == b->phase)
+            pthread_cond_wait (&b->cv, &b->mtx);
+    pthread_mutex_unlock (&b->mtx);
+}
+
+static void SWAP (T *a, T *b)
+{
+    T tmp = *a;
+    *a = *b;
+    *b = tmp;
+}
+
+typedef struct {            /* per-thread pivot search result */
+    T big;                  /* fabs of max, -1.0 if no row searched */
+    size_t irow, icol;
+    char pad[64 - sizeof (T) - 2 * sizeof (size_t)];    /* own cache line */
+} gj_max_t;
+
+typedef struct gj_t {       /* shared elimination state */
+    T **a, *v;              /* matrix and optional separate constant vect */
+    size_t n, ncol, icol;   /* size, cols updated, current pivot row/col */
+    size_t r0;              /* first row eliminated, first col searched */
+    T *msk;                 /* unpivoted cols (Gauss-Jordan), or NULL */
+    int *ipiv;              /* pivoted rows excluded from search, or NULL */
+    int nthrd, done, srch;  /* threads running, complete, search rows */
+    void (*rows) (struct gj_t *gj, const size_t lo, const size_t hi);
+    bar_t bar;              /* pivot step barrier */
+    gj_max_t mx[MTRX_THRD_MAX]; /* partition maxima, combined in order */
+} gj_t;
+
+typedef struct {            /* per-thread argument */
+    gj_t *gj;
+    int id;
+} gj_arg_t;
+
+/** eliminate column icol from rows [lo, hi) (all but the pivot row) */
+static void gj_rows (gj_t *gj, const size_t lo, const size_t hi)
+{
+    T **a = gj->a, *v = gj->v;
+    const size_t icol = gj->icol, ncol = gj->ncol;
+    register size_t ll;
+
+    for (ll = lo; ll < hi; ll++)
+        if (ll != icol) {
+            T dum = a[ll][icol];
+            a[ll][icol] = 0.0;
+            mtrx_kern.axpy (ncol, -dum, a[icol], a[ll]);
+            if (v)
+                v[ll] -= v[icol] * dum;
+        }
+}
+
+/** eliminate column icol below the pivot in rows [lo, hi) (solve only),
+ *  as the serial solver, see mtrx_gauss_elim().
+ */
+static void gauss_rows (gj_t *gj, const size_t lo, const size_t hi)
+{
+    mtrx_gauss_elim (gj->a, gj->n, gj->icol, lo, hi, NULL, NULL, NULL);
+}
+
+/** eliminate rows in partition 'id' of 'nthrd' of [r0, n), (rows NULL,
+ *  search only) then, with srch set, search the same rows for the next
+ *  pivot while they are in cache.
+ */
+static void gj_part (gj_t *gj, const int id)
+{
+    size_t nr = gj->n - gj->r0,
+           lo = gj->r0 + nr * id / gj->nthrd,
+           hi = gj->r0 + nr * (id + 1) / gj->nthrd,
+           i;
+    gj_max_t *mx = &gj->mx[id];
+
+    if (gj->rows)
+        gj->rows (gj, lo, hi);
+
+    if (!gj->srch)
+        return;
+
+    mx->big = -1.0;
+    for (i = lo; i < hi; i++)
+        if (!gj->ipiv || gj->ipiv[i] != 1)
+            mtrx_piv_row (gj->a[i], i, gj->r0, gj->n, gj->msk,
+                    &mx->big, &mx->irow, &mx->icol);
+}
+
+/** combine partition maxima in partition (row) order, keeping the last
+ *  maximum so the pivot is the one the serial search selects. returns
+ *  fabs of the pivot, -1.0 if no row was searched.
+ */
+static T gj_max (const gj_t *gj, size_t *irow, size_t *icol)
+{
+    T big = -1.0;
+    int t;
+
+    for (t = 0; t < gj->nthrd; t++)
+        if (gj->mx[t].big >= 0.0 && gj->mx[t].big >= big) {
+            big = gj->mx[t].big;
+            *irow = gj->mx[t].irow;
+            *icol = gj->mx[t].icol;
+        }
+
+    return big;
+}
+
+static void *gj_worker (void *arg)
+{
+    gj_arg_t *ga = arg;
+    gj_t *gj = ga->gj;
+
+    for (;;) {
+        bar_wait (&gj->bar);        /* wait for scaled pivot row */
+        if (gj->done)
+            break;
+        gj_part (gj, ga->id);
+        bar_wait (&gj->bar);        /* pivot step complete */
+    }
+
+    return NULL;
+}
+
+/** start workers 1 -> nthrd-1 on gj, the calling thread is partition 0.
+ *  returns number of threads running (including the caller), 0 on error.
+ */
+static int gj_start (gj_t *gj, pthread_t *tid, gj_arg_t *arg, int nthrd)
+{
+    int t;
+
+    if (nthrd > MTRX_THRD_MAX)
+        nthrd = MTRX_THRD_MAX;
+    if ((size_t)nthrd > gj->n)
+        nthrd = gj->n ? (int)gj->n : 1;
+    if (nthrd < 1)
+        nthrd = 1;
+
+    if (bar_init (&gj->bar, nthrd)) {
+        fprintf (stderr, "%s() error: barrier init.\n", __func__);
+        return 0;
+    }
+
+    for (t = 1; t < nthrd; t++) {
+        arg[t].gj = gj;
+        arg[t].id = t;
+        if (pthread_create (&tid[t], NULL, gj_worker, &arg[t])) {
+            fprintf (stderr, "%s() warning: %d of %d threads started.\n",
+                    __func__, t, nthrd);
+            break;
+        }
+    }
+    gj->nthrd = t;
+    bar_setcount (&gj->bar, t);
+
+    return t;
+}
+
+/** run one elimination step on all threads */
+static void gj_step (gj_t *gj)
+{
+    bar_wait (&gj->bar);            /* release workers on pivot row */
+    gj_part (gj, 0);
+    bar_wait (&gj->bar);            /* wait for all rows eliminated */
+}
+
+/** release and join workers */
+static void gj_stop (gj_t *gj, pthread_t *tid)
+{
+    int t;
+
+    gj->done = 1;
+    bar_wait (&gj->bar);
+    for (t = 1; t < gj->nthrd; t++)
+        pthread_join (tid[t], NULL);
+    bar_destroy (&gj->bar);
+}
+
+/** gaussj_thrd - Guass-Jordan with full pivoting, threaded row updates.
+ *  row interchange and pivot row scaling are done by the calling thread,
+ *  then all threads eliminate the pivot column from their partition of
+ *  rows and search it for the next pivot, the partition maxima are then
+ *  reduced in row order. v == NULL, the constant vector is column n of 'a'.
+ *  statistics are recorded in st if not NULL, see mtrx_solv_gaussj_st().
+ */
+static int gaussj_thrd (T **a, T *v, const size_t n, int nthrd,
+                        mtrx_stat_t *st)
+{   /* bookkeeping arrays for pivot, msk[k] 1.0 while col k unpivoted */
+    int *indxc = calloc (n, sizeof *indxc),
+        *indxr = calloc (n, sizeof *indxr),
+        *ipiv  = calloc (n, sizeof *ipiv);
+    T *msk = calloc (n, sizeof *msk);
+    pthread_t tid[MTRX_THRD_MAX];
+    gj_arg_t arg[MTRX_THRD_MAX];
+    gj_t gj = { .a = a, .v = v, .n = n, .ncol = v ? n : n + 1,
+                .msk = msk, .ipiv = ipiv, .srch = 1 };
+    T pivinv;
+    size_t i, icol = 0, irow = 0, j, k, l;
+    int info = 0;
+
+    if (!indxc || !indxr || !ipiv || !msk) {
+        fprintf (stderr, "%s() error: calloc-bookkeeping.\n", __func__);
+        info = -1;
+        goto gaussjdone;
+    }
+
+    if (!gj_start (&gj, tid, arg, nthrd)) {
+        info = -1;
+        goto gaussjdone;
+    }
+
+    if (st)
+        mtrx_stat_init (st, a, n);
+
+    for (j = 0; j < n; j++)
+        msk[j] = 1.0;
+
+    gj_step (&gj);          /* rows NULL, search only for first pivot */
+    gj.rows = gj_rows;
+
+    for (i = 0; i < n; i++) {
+        gj_max (&gj, &irow, &icol);
+        ipiv[icol]++;
+        msk[icol] = 0.0;
+
+        if (irow != icol) {  /* transpose row/col */
+            mtrx_kern.swap (gj.ncol, a[irow], a[icol]);
+            if (v)
+                SWAP (&v[irow], &v[icol]);
+        }
+        indxr[i] = irow;
+        indxc[i] = icol;
+
+        if (a[icol][icol] == 0.0) {
+            fprintf (stderr, "guassj() error: singular matrix.\n");
+            info = 1;
+            break;
+        }
+
+        if (st)
+            mtrx_stat_piv (st, a[icol][icol], irow != icol);
+        pivinv = 1.0 / a[icol][icol];
+        a[icol][icol] = 1.0;
+
+        mtrx_kern.scal (gj.ncol, pivinv, a[icol]);
+        if (v)
+            v[icol] *= pivinv;
+
+        gj.icol = icol;
+        gj_step (&gj);
+    }
+
+    gj_stop (&gj, tid);
+
+    if (info)
+        goto gaussjdone;
+
+    l = n;
+    while (l--) {
+        if (indxr[l] != indxc[l])
+            for (k = 0; k < n; k++)
+                SWAP(&a[k][indxr[l]],&a[k][indxc[l]]);
+    }
+    if (st)
+        mtrx_stat_inv (st, a, n);
+    gaussjdone:;
+
+    free (msk);
+    free (ipiv);
+    free (indxr);
+    free (indxc);
+
+    return info;
+}
+
+/** mtrx_solv_gaussj_thrd - threaded Guass-Jordan with full pivoting.
+ *  identical to mtrx_solv_gaussj() except the row updates for each pivot
+ *  step are split across nthrd threads with a barrier per pivot step. the
+ *  operations on each element are unchanged, so results are bit-identical
+ *  to the serial path. returns 0 on success, 1 if 'a' is singular.
+ */
+int mtrx_solv_gaussj_thrd (T **a, const size_t n, const int nthrd)
+{
+    return gaussj_thrd (a, NULL, n, nthrd, NULL);
+}
+
+/** mtrx_solv_gaussj_thrd_st - mtrx_solv_gaussj_thrd() recording the
+ *  statistics in st (if not NULL), see mtrx_solv_gaussj_st().
+ */
+int mtrx_solv_gaussj_thrd_st (T **a, const size_t n, const int nthrd,
+                              mtrx_stat_t *st)
+{
+    return gaussj_thrd (a, NULL, n, nthrd, st);
+}
+
+/** same taking a (n x n) and v, see mtrx_solv_gaussj_v() */
+int mtrx_solv_gaussj_v_thrd (T **a, T *v, const size_t n, const int nthrd)
+{
+    return gaussj_thrd (a, v, n, nthrd, NULL);
+}
+
+/** mtrx_solv_gauss_thrd - threaded solve only Gaussian elimination.
+ *  identical to mtrx_solv_gauss() except the rows below each pivot are
+ *  eliminated (and with PIV_FULL searched for the next pivot) across
+ *  nthrd threads with a barrier per pivot step, the partition maxima are
+ *  reduced in row order so results are bit-identical to the serial path.
+ *  returns 0 on success, 1 if 'a' is singular.
+ */
+int mtrx_solv_gauss_thrd (T **a, const size_t n, const int nthrd)
+{
+    return mtrx_solv_gauss_thrd_st (a, n, nthrd, NULL);
+}
+
+/** mtrx_solv_gauss_thrd_st - mtrx_solv_gauss_thrd() recording the
+ *  statistics in st (if not NULL), see mtrx_solv_gauss_st().
+ */
+int mtrx_solv_gauss_thrd_st (T **a, const size_t n, const int nthrd,
+                             mtrx_stat_t *st)
+{
+    size_t *perm = calloc (n, sizeof *perm);    /* column exchanges */
+    T *y = calloc (n, sizeof *y);               /* permuted solution */
+    T *cmax = NULL;                             /* rook column bounds */
+    size_t *rp = NULL;                          /* row exchanges (st) */
+    pthread_t tid[MTRX_THRD_MAX];
+    gj_arg_t arg[MTRX_THRD_MAX];
+    gj_t gj = { .a = a, .n = n, .ncol = n + 1 };
+    T big;
+    size_t i, icol = 0, irow = 0, j, k;
+    int info = 0, rook = mtrx_piv_get() == PIV_ROOK;
+
+    if (!perm || !y) {
+        fprintf (stderr, "%s() error: calloc-perm/y.\n", __func__);
+        info = -1;
+        goto gaussdone;
+    }
+
+    if (st) {
+        if (!(rp = malloc (n * sizeof *rp))) {
+            fprintf (stderr, "%s() error: malloc-rp.\n", __func__);
+            info = -1;
+            goto gaussdone;
+        }
+        for (i = 0; i < n; i++)
+            rp[i] = i;
+        mtrx_stat_init (st, a, n);
+    }
+
+    if (rook) {
+        if (!(cmax = malloc (n * sizeof *cmax))) {
+            fprintf (stderr, "%s() error: malloc-cmax.\n", __func__);
+            info = -1;
+            goto gaussdone;
+        }
+        mtrx_piv_cmax (a, n, 0, cmax);
+    }
+    gj.srch = !rook;
+
+    if (!gj_start (&gj, tid, arg, nthrd)) {
+        info = -1;
+        goto gaussdone;
+    }
+
+    for (j = 0; j < n; j++)
+        perm[j] = j;
+
+    if (!rook)
+        gj_step (&gj);      /* rows NULL, search only for first pivot */
+    gj.rows = gauss_rows;
+
+    for (k = 0; k < n; k++) {
+        if (rook)
+            big = mtrx_piv_rook (a, n, k, cmax, &irow, &icol);
+        else
+            big = gj_max (&gj, &irow, &icol);
+
+        if (big <= 0.0) {
+            fprintf (stderr, "%s() error: singular matrix.\n", __func__);
+            info = 1;
+            break;
+        }
+
+        mtrx_gauss_xchg (a, n, k, irow, icol, perm, rp, cmax);
+
+        gj.icol = k;
+        gj.r0 = k + 1;
+        gj_step (&gj);
+    }
+
+    gj_stop (&gj, tid);
+
+    if (info)
+        goto gaussdone;
+
+    mtrx_gauss_back (a, n, perm, y);
+    if (st)
+        mtrx_stat_lu (st, a, rp, perm, n);
+    gaussdone:;
+
+    free (rp);
+    free (cmax);
+    free (y);
+    free (perm);
+
+    return info;
+}
@@ -0,0 +1,115 @@
+/* regression: re-solving with only the constants changed is a cache hit.
+ * a system is solved with each of SOLV_GAUSS, SOLV_GAUSSJ and SOLV_LU,
+ * then re-solved with new constants. the re-solve must reuse the cached
+ * factors (hit count up, miss count unchanged) and match a fresh solve
+ * of the same system with the cache disabled.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "mtrx_t.h"
+#include "mtrx_cache.h"
+
+#define N    100
+#define RTOL 1e-12
+
+static unsigned long rnd_s = 1;
+
+static T rnd (void)             /* [-0.5, 0.5) */
+{
+    rnd_s = rnd_s * 6364136223846793005UL + 1442695040888963407UL;
+    return (T)(rnd_s >> 11) / 9007199254740992.0 - 0.5;
+}
+
+/* copy of (n x n+1) system a, constants replaced by b if not NULL */
+static mtrx_t *sys_copy (const mtrx_t *a, const T *b)
+{
+    mtrx_t *m = mtrx_copy (a);
+    register size_t i;
+
+    if (m && b)
+        for (i = 0; i < m->rows; i++)
+            m->mtrx[i][m->rows] = b[i];
+
+    return m;
+}
+
+/* max relative difference of the solutions in the last col of x and y */
+static T sol_diff (const mtrx_t *x, const mtrx_t *y)
+{
+    const size_t n = x->rows;
+    T d = 0.0, xn = 0.0;
+    register size_t i;
+
+    for (i = 0; i < n; i++) {
+        if (fabs (x->mtrx[i][n] - y->mtrx[i][n]) > d)
+            d = fabs (x->mtrx[i][n] - y->mtrx[i][n]);
+        if (fabs (y->mtrx[i][n]) > xn)
+            xn = fabs (y->mtrx[i][n]);
+    }
+
+    return d / xn;
+}
+
+static int check (const mtrx_t *a, const int method, const char *name)
+{
+    T b[N], diff = NAN;
+    size_t hit0 = 0, miss0 = 0, hit = 0, miss = 0;
+    mtrx_t *m1 = sys_copy (a, NULL), *m2, *ref;
+    register size_t i;
+    int ok = 0;
+
+    for (i = 0; i < N; i++)     /* new constants only */
+        b[i] = rnd ();
+    m2 = sys_copy (a, b);
+    ref = sys_copy (a, b);
+    if (!m1 || !m2 || !ref)
+        return 1;
+
+    mtrx_cache_clear ();
+    if (mtrx_cache_solv (m1, method) == 0) {
+        mtrx_cache_count (&hit0, &miss0);
+        if (mtrx_cache_solv (m2, method) == 0) {
+            mtrx_cache_count (&hit, &miss);
+            mtrx_cache_limit (0);           /* reference, uncached */
+            if (mtrx_solv_sys (ref, SOLV_LU) == 0) {
+                diff = sol_diff (m2, ref);
+                ok = hit == hit0 + 1 && miss == miss0 && diff <= RTOL;
+            }
+            mtrx_cache_limit (MTRX_CACHE_MAX);
+        }
+    }
+    printf ("%-7s n %d: re-solve hits %zu misses %zu diff %.2e %s\n",
+            name, N, hit - hit0, miss - miss0, diff, ok ? "ok" : "FAIL");
+
+    mtrx_free (ref);
+    mtrx_free (m2);
+    mtrx_free (m1);
+
+    return !ok;
+}
+
+int main (void)
+{
+    mtrx_t *a = mtrx_create_slab (N, N + 1);
+    register size_t i, j;
+    int fail = 0;
+
+    if (!a)
+        return 1;
+    a->rows = N;
+    a->cols = N + 1;
+    for (i = 0; i < N; i++)     /* dense, non-symmetric */
+        for (j = 0; j <= N; j++)
+            a->mtrx[i][j] = rnd () + (i == j ? 2.0 : 0.0);
+
+    fail |= check (a, SOLV_GAUSS, "gauss");
+    fail |= check (a, SOLV_GAUSSJ, "gaussj");
+    fail |= check (a, SOLV_LU, "lu");
+
+    mtrx_free (a);
+    printf ("%s\n", fail ? "FAILED" : "passed");
+
+    return fail;
+}
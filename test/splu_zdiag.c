@@ -0,0 +1,125 @@
+/* regression: sparse LU of systems with a zero (stored) or tiny diagonal.
+ * csr_from_mtrx() stores the diagonal even when it is 0.0, the row
+ * matching must not match those entries, and must move larger values onto
+ * a tiny diagonal. each system is solved by mtrx_solv_splu() and must
+ * reach the relative residual RTOL.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "mtrx_t.h"
+#include "mtrx_csr.h"
+#include "mtrx_splu.h"
+
+#define RTOL 1e-10
+
+static unsigned long rnd_s = 1;
+
+static T rnd (void)             /* [-0.5, 0.5) */
+{
+    rnd_s = rnd_s * 6364136223846793005UL + 1442695040888963407UL;
+    return (T)(rnd_s >> 11) / 9007199254740992.0 - 0.5;
+}
+
+static mtrx_t *sys_new (const size_t n)
+{
+    mtrx_t *m = mtrx_create_slab (n, n + 1);
+    register size_t i, j;
+
+    if (!m)
+        return NULL;
+    m->rows = n;
+    m->cols = n + 1;
+    for (i = 0; i < n; i++) {
+        for (j = 0; j < n; j++)
+            m->mtrx[i][j] = 0.0;
+        m->mtrx[i][n] = rnd ();
+    }
+
+    return m;
+}
+
+/* solve m by sparse LU, returns rtn, *rres the relative residual */
+static int sys_solv (const mtrx_t *m, const int order, T *rres)
+{
+    const size_t n = m->rows;
+    csr_t *a = csr_from_mtrx (m);
+    T *x, rn = 0.0, bn = 0.0;
+    register size_t i;
+    int rtn;
+
+    if (!a || !(x = malloc (n * sizeof *x))) {
+        if (a)
+            csr_free (a);
+        return -1;
+    }
+    rtn = mtrx_solv_splu (a, order);
+    csr_mv (a, a->b, x);
+    for (i = 0; i < n; i++) {
+        rn += (x[i] - m->mtrx[i][n]) * (x[i] - m->mtrx[i][n]);
+        bn += m->mtrx[i][n] * m->mtrx[i][n];
+    }
+    *rres = sqrt (rn / bn);
+
+    free (x);
+    csr_free (a);
+
+    return rtn;
+}
+
+/* a solve reporting success must be accurate, a failure must say so */
+static int check (const char *name, const size_t n, const mtrx_t *m,
+                  const int order, const int must)
+{
+    T rres = NAN;
+    int rtn = sys_solv (m, order, &rres),
+        ok = rtn ? !must : rres <= RTOL;
+
+    printf ("%-10s n %4zu order %d: rtn %2d rres %.2e %s\n", name, n, order,
+            rtn, rres, ok ? "ok" : "FAIL");
+
+    return !ok;
+}
+
+int main (void)
+{
+    const size_t ns[] = { 10, 30, 100, 200 };
+    register size_t i, k;
+    size_t z, n;
+    int order, fail = 0;
+
+    for (z = 0; z < sizeof ns / sizeof *ns; z++)
+        for (order = ORD_NATURAL; order <= ORD_RCM; order++) {
+            mtrx_t *m;
+            n = ns[z];
+
+            if (!(m = sys_new (n)))     /* scaled cyclic shift */
+                return 1;
+            for (i = 0; i < n; i++)
+                m->mtrx[i][(i + 1) % n] = 1.0 + i % 3;
+            fail |= check ("shift", n, m, order, 1);
+            mtrx_free (m);
+
+            if (!(m = sys_new (n)))     /* random sparse, zero diagonal */
+                return 1;
+            for (i = 0; i < n; i++) {
+                m->mtrx[i][(i + 1) % n] = 2.0 + rnd ();
+                for (k = 0; k < 4; k++) {
+                    size_t j = (size_t)((rnd () + 0.5) * n) % n;
+                    if (j != i)
+                        m->mtrx[i][j] += rnd ();
+                }
+            }
+            fail |= check ("zero diag", n, m, order, 1);
+
+            for (i = 0; i < n; i++)     /* tiny diagonal, must solve */
+                m->mtrx[i][i] = 1e-14;
+            fail |= check ("tiny diag", n, m, order, 1);
+            mtrx_free (m);
+        }
+
+    printf ("%s\n", fail ? "FAILED" : "passed");
+
+    return fail;
+}